@@ -0,0 +1,112 @@
+// 请求解析相关编解码的基准测试
+// 覆盖查询字符串、urlencoded 表单、Cookie 头部的拆分，以及 URL 编码和解码
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "UriUtil.h"
+#include "HttpContent.h"
+#include "HttpCookie.h"
+#include "CodeUtil.h"
+#include "StringPiece.h"
+
+using namespace Yukino;
+
+namespace
+{
+
+// 查询字符串：分页接口、带编码中文的搜索、埋点参数很多的落地页
+const std::vector<std::string> kQueries = {
+    "page=2&size=20",
+    "q=%E4%B8%AD%E6%96%87%E6%90%9C%E7%B4%A2&sort=desc&lang=zh-CN&page=1",
+    "utm_source=newsletter&utm_medium=email&utm_campaign=spring_sale_2024"
+        "&utm_term=running+shoes&utm_content=hero_banner&ref=abc123&session=9f8e7d6c5b4a"
+        "&ts=1718000000&sig=0a1b2c3d4e5f6a7b8c9d&debug=&flag",
+};
+
+// urlencoded 表单：登录表单、带长文本的评论表单
+const std::vector<std::string> kForms = {
+    "username=alice&password=s3cr3t%21&remember=on",
+    "title=Hello+World&tags=c%2B%2B%2Cnetwork%2Chttp&rating=5"
+        "&body=" + std::string(512, 'x') + "&author=bob&email=bob%40example.com&notify=1",
+};
+
+// Cookie 头部：单个会话 Cookie、带分析类 Cookie 的浏览器请求
+const std::vector<std::string> kCookies = {
+    "session_id=2f6c1c6e9b4a4f0e",
+    "session_id=2f6c1c6e9b4a4f0e; theme=dark; lang=zh-CN; _ga=GA1.2.1234567890.1718000000; "
+        "_gid=GA1.2.987654321.1718000000; csrftoken=Zk9yZ2VyeVRva2VuMTIzNDU2Nzg5MA; "
+        "cart=%7B%22items%22%3A3%7D; consent=true",
+};
+
+// URL 编码输入：纯 ASCII 路径、中文路径、需要大量转义的二进制风格字符串
+const std::vector<std::string> kRawUrls = {
+    "/api/v1/users/12345/orders",
+    "/搜索/中文路径/测试文件.txt",
+    "a b&c=d?e#f%g+h/i;j:k@l$m,n!o'p(q)r*s~t",
+};
+
+void BM_SplitQuery(benchmark::State &state)
+{
+    const std::string &query = kQueries[state.range(0)];
+    for (auto _ : state)
+    {
+        auto kv = UriUtil::split_query(StringPiece(query));
+        benchmark::DoNotOptimize(kv);
+    }
+    state.SetBytesProcessed(state.iterations() * query.size());
+}
+
+void BM_ParsePostKV(benchmark::State &state)
+{
+    const std::string &form = kForms[state.range(0)];
+    for (auto _ : state)
+    {
+        auto kv = Urlencode::parse_post_kv(StringPiece(form));
+        benchmark::DoNotOptimize(kv);
+    }
+    state.SetBytesProcessed(state.iterations() * form.size());
+}
+
+void BM_CookieSplit(benchmark::State &state)
+{
+    const std::string &cookie = kCookies[state.range(0)];
+    for (auto _ : state)
+    {
+        auto kv = HttpCookie::split(StringPiece(cookie));
+        benchmark::DoNotOptimize(kv);
+    }
+    state.SetBytesProcessed(state.iterations() * cookie.size());
+}
+
+void BM_UrlEncode(benchmark::State &state)
+{
+    const std::string &raw = kRawUrls[state.range(0)];
+    for (auto _ : state)
+    {
+        std::string encoded = CodeUtil::url_encode(raw);
+        benchmark::DoNotOptimize(encoded.data());
+    }
+    state.SetBytesProcessed(state.iterations() * raw.size());
+}
+
+void BM_UrlDecode(benchmark::State &state)
+{
+    const std::string encoded = CodeUtil::url_encode(kRawUrls[state.range(0)]);
+    for (auto _ : state)
+    {
+        std::string decoded = CodeUtil::url_decode(encoded);
+        benchmark::DoNotOptimize(decoded.data());
+    }
+    state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_SplitQuery)->DenseRange(0, 2);
+BENCHMARK(BM_ParsePostKV)->DenseRange(0, 1);
+BENCHMARK(BM_CookieSplit)->DenseRange(0, 1);
+BENCHMARK(BM_UrlEncode)->DenseRange(0, 2);
+BENCHMARK(BM_UrlDecode)->DenseRange(0, 2);
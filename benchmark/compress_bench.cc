@@ -0,0 +1,239 @@
+// gzip 压缩和解压的基准测试
+// 语料：HTML 页面、JSON 接口响应、几乎不可压缩的二进制数据，各取 1KB、64KB、1MB 三种大小
+// BM_*FreshStream 每次新建 z_stream（改用线程池之前的做法），通过 zalloc 统计每次压缩/解压分配的内存，
+// 和复用线程池中 z_stream 的 BM_Gzip、BM_Ungzip 对比；池中的流复位后不再分配内存
+
+#include <benchmark/benchmark.h>
+#include <zlib.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "Compress.h"
+#include "ErrorCode.h"
+
+using namespace Yukino;
+
+namespace
+{
+
+std::string repeat_to(const std::string &unit, size_t size)
+{
+    std::string data;
+    data.reserve(size + unit.size());
+    unsigned n = 0;
+    while (data.size() < size)
+    {
+        // 带上序号，避免完全重复的内容让压缩率虚高
+        data.append(unit);
+        data.append(std::to_string(n++));
+    }
+    data.resize(size);
+    return data;
+}
+
+std::string html(size_t size)
+{
+    return repeat_to("<div class=\"item\"><a href=\"/products/detail?id=\">Product name</a>"
+                     "<span class=\"price\">$19.99</span><p>Short description of the product, "
+                     "with some marketing text.</p></div>\n", size);
+}
+
+std::string json(size_t size)
+{
+    return repeat_to("{\"id\":,\"name\":\"user\",\"email\":\"user@example.com\",\"active\":true,"
+                     "\"balance\":1234.56,\"roles\":[\"reader\",\"writer\"]},", size);
+}
+
+std::string binary(size_t size)
+{
+    std::string data(size, '\0');
+    unsigned seed = 42;
+    for (size_t i = 0; i < size; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        data[i] = static_cast<char>(seed >> 16);
+    }
+    return data;
+}
+
+const std::string &corpus(int kind, size_t size)
+{
+    static std::vector<std::pair<std::pair<int, size_t>, std::string>> cache;
+    for (auto &entry : cache)
+    {
+        if (entry.first.first == kind && entry.first.second == size)
+            return entry.second;
+    }
+    std::string data = kind == 0 ? html(size) : kind == 1 ? json(size) : binary(size);
+    cache.emplace_back(std::make_pair(kind, size), std::move(data));
+    return cache.back().second;
+}
+
+const char *kind_name(int kind)
+{
+    static const char *names[] = { "html", "json", "binary" };
+    return names[kind];
+}
+
+// zalloc/zfree 的统计
+struct AllocStats
+{
+    size_t count = 0;
+    size_t bytes = 0;
+};
+
+voidpf counting_alloc(voidpf opaque, uInt items, uInt size)
+{
+    AllocStats *stats = static_cast<AllocStats *>(opaque);
+    stats->count++;
+    stats->bytes += static_cast<size_t>(items) * size;
+    return calloc(items, size);
+}
+
+void counting_free(voidpf, voidpf address)
+{
+    free(address);
+}
+
+// 每次都 deflateInit2/deflateEnd，与改用线程池之前的 Compressor::gzip 相同
+int fresh_gzip(const std::string &data, std::string *out, AllocStats *stats)
+{
+    z_stream strm = {};
+    strm.zalloc = counting_alloc;
+    strm.zfree = counting_free;
+    strm.opaque = stats;
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return -1;
+
+    out->resize(deflateBound(&strm, data.size()));
+    strm.next_in = (Bytef *)data.data();
+    strm.avail_in = static_cast<uInt>(data.size());
+    strm.next_out = (Bytef *)&(*out)[0];
+    strm.avail_out = static_cast<uInt>(out->size());
+    int ret = deflate(&strm, Z_FINISH);
+    out->resize(strm.total_out);
+    deflateEnd(&strm);
+    return ret == Z_STREAM_END ? 0 : -1;
+}
+
+int fresh_ungzip(const std::string &data, std::string *out, size_t size, AllocStats *stats)
+{
+    z_stream strm = {};
+    strm.zalloc = counting_alloc;
+    strm.zfree = counting_free;
+    strm.opaque = stats;
+    if (inflateInit2(&strm, 15 + 32) != Z_OK)
+        return -1;
+
+    out->resize(size);
+    strm.next_in = (Bytef *)data.data();
+    strm.avail_in = static_cast<uInt>(data.size());
+    strm.next_out = (Bytef *)&(*out)[0];
+    strm.avail_out = static_cast<uInt>(out->size());
+    int ret = inflate(&strm, Z_FINISH);
+    inflateEnd(&strm);
+    return ret == Z_STREAM_END ? 0 : -1;
+}
+
+void BM_GzipFreshStream(benchmark::State &state)
+{
+    const std::string &data = corpus(state.range(0), state.range(1));
+    std::string out;
+    AllocStats stats;
+    for (auto _ : state)
+    {
+        int ret = fresh_gzip(data, &out, &stats);
+        benchmark::DoNotOptimize(ret);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    state.counters["allocs"] = benchmark::Counter(stats.count, benchmark::Counter::kAvgIterations);
+    state.counters["alloc_bytes"] = benchmark::Counter(stats.bytes, benchmark::Counter::kAvgIterations);
+    state.SetLabel(kind_name(state.range(0)));
+}
+
+void BM_UngzipFreshStream(benchmark::State &state)
+{
+    const std::string &data = corpus(state.range(0), state.range(1));
+    std::string compressed;
+    if (Compressor::gzip(&data, &compressed) != StatusOK)
+    {
+        state.SkipWithError("gzip failed");
+        return;
+    }
+
+    std::string out;
+    AllocStats stats;
+    for (auto _ : state)
+    {
+        int ret = fresh_ungzip(compressed, &out, data.size(), &stats);
+        benchmark::DoNotOptimize(ret);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    state.counters["allocs"] = benchmark::Counter(stats.count, benchmark::Counter::kAvgIterations);
+    state.counters["alloc_bytes"] = benchmark::Counter(stats.bytes, benchmark::Counter::kAvgIterations);
+    state.SetLabel(kind_name(state.range(0)));
+}
+
+// 不同压缩级别的速度和压缩率，第一个参数为 CompressLevel 的取值（1: FASTEST, 2: DEFAULT, 3: BEST）
+void BM_GzipLevel(benchmark::State &state)
+{
+    const std::string &data = corpus(1, state.range(1));
+    CompressLevel level = static_cast<CompressLevel>(state.range(0));
+    std::string out;
+    for (auto _ : state)
+    {
+        int ret = Compressor::gzip(data.data(), data.size(), &out, level);
+        benchmark::DoNotOptimize(ret);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    state.counters["ratio"] = out.empty() ? 0 : static_cast<double>(data.size()) / out.size();
+    static const char *names[] = { "auto", "fastest", "default", "best" };
+    state.SetLabel(names[state.range(0)]);
+}
+
+void BM_Gzip(benchmark::State &state)
+{
+    const std::string &data = corpus(state.range(0), state.range(1));
+    std::string out;
+    for (auto _ : state)
+    {
+        out.clear();
+        int ret = Compressor::gzip(&data, &out);
+        benchmark::DoNotOptimize(ret);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    state.counters["ratio"] = out.empty() ? 0 : static_cast<double>(data.size()) / out.size();
+    state.SetLabel(kind_name(state.range(0)));
+}
+
+void BM_Ungzip(benchmark::State &state)
+{
+    const std::string &data = corpus(state.range(0), state.range(1));
+    std::string compressed;
+    if (Compressor::gzip(&data, &compressed) != StatusOK)
+    {
+        state.SkipWithError("gzip failed");
+        return;
+    }
+
+    std::string out;
+    for (auto _ : state)
+    {
+        out.clear();
+        int ret = Compressor::ungzip(&compressed, &out);
+        benchmark::DoNotOptimize(ret);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+    state.SetLabel(kind_name(state.range(0)));
+}
+
+}  // namespace
+
+// 第一个参数为语料类型（0: html, 1: json, 2: binary），第二个参数为原始数据大小
+BENCHMARK(BM_Gzip)->ArgsProduct({{0, 1, 2}, {1 << 10, 64 << 10, 1 << 20}});
+BENCHMARK(BM_Ungzip)->ArgsProduct({{0, 1, 2}, {1 << 10, 64 << 10, 1 << 20}});
+BENCHMARK(BM_GzipFreshStream)->ArgsProduct({{0, 1, 2}, {1 << 10, 64 << 10, 1 << 20}});
+BENCHMARK(BM_UngzipFreshStream)->ArgsProduct({{0, 1, 2}, {1 << 10, 64 << 10, 1 << 20}});
+BENCHMARK(BM_GzipLevel)->ArgsProduct({{1, 2, 3}, {1 << 10, 64 << 10, 1 << 20}});
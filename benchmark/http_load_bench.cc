@@ -0,0 +1,424 @@
+// 端到端的回环压测工具
+// 在本机启动一个 HttpServer（以及一个供代理路由转发的上游 HttpServer），
+// 用基于 WFHttpTask 的多连接 keep-alive 客户端依次压测每个路由，输出吞吐量和 p50/p99/p999 延迟。
+//
+// 用法：http_load_bench [-p 端口] [-c 并发连接数] [-n 每个连接的请求数]
+//                       [-m max_connections] [-k keep_alive_timeout(ms)] [-r 路由1,路由2,...]
+// 路由名：string json file param upload proxy push catalog cached
+// catalog 每次请求重新生成一个较大的 JSON 列表，cached 是同样的处理函数加上 ResponseCache 切面
+
+#include "workflow/WFGlobal.h"
+#include "workflow/WFTaskFactory.h"
+#include "workflow/WFFacilities.h"
+#include "workflow/Workflow.h"
+#include "workflow/HttpUtil.h"
+
+#include <getopt.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "HttpServer.h"
+#include "Json.h"
+
+using namespace Yukino;
+using namespace protocol;
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+const std::string kBoundary = "----YukinoLoadBenchBoundary";
+const int kPushChunks = 4;  // 每次 Push 请求推送的数据块数
+
+struct Options
+{
+    unsigned short port = 8888;
+    int connections = 32;
+    int requests = 2000;
+    size_t max_connections = 2000;
+    int keep_alive_timeout = 60 * 1000;
+    std::vector<std::string> routes = { "string", "json", "file", "param", "upload", "proxy", "push",
+                                        "catalog", "cached" };
+};
+
+// 压测的一个路由
+struct RouteSpec
+{
+    std::string name;      // 路由名
+    std::string method;    // 请求方法
+    std::string path;      // 请求路径
+    std::string body;      // 请求体
+    std::string content_type;
+    bool keep_alive;       // 客户端是否复用连接
+};
+
+// 一个连接（一个串行的任务序列）的压测状态
+struct ConnCtx
+{
+    const RouteSpec *route;
+    std::string url;
+    int remaining;
+    Clock::time_point start;
+    std::vector<int64_t> latencies;  // 微秒
+    int errors = 0;
+    WFFacilities::WaitGroup *wait_group;
+};
+
+// Push 路由的推送状态，由推送回调和驱动定时器共享
+struct PushState
+{
+    std::string cond_name;
+    std::atomic<int> sent{0};          // 已经推送的数据块数
+    std::atomic<bool> finished{false}; // 已经推送结束块
+    std::atomic<bool> closed{false};   // 连接已经断开
+    int ticks = 0;                     // 结束后的驱动次数
+};
+
+std::vector<std::string> split_list(const char *arg)
+{
+    std::vector<std::string> items;
+    std::string cur;
+    for (const char *p = arg; ; p++)
+    {
+        if (*p == ',' || *p == '\0')
+        {
+            if (!cur.empty())
+                items.push_back(cur);
+            cur.clear();
+            if (*p == '\0')
+                break;
+        }
+        else
+            cur.push_back(*p);
+    }
+    return items;
+}
+
+std::string multipart_body()
+{
+    std::string body;
+    body.append("--").append(kBoundary).append("\r\n");
+    body.append("Content-Disposition: form-data; name=\"title\"\r\n\r\n");
+    body.append("load test upload\r\n");
+    body.append("--").append(kBoundary).append("\r\n");
+    body.append("Content-Disposition: form-data; name=\"file\"; filename=\"data.bin\"\r\n");
+    body.append("Content-Type: application/octet-stream\r\n\r\n");
+    body.append(std::string(8 * 1024, 'u')).append("\r\n");
+    body.append("--").append(kBoundary).append("--\r\n");
+    return body;
+}
+
+std::vector<RouteSpec> all_route_specs()
+{
+    return {
+        { "string", "GET", "/string", "", "", true },
+        { "json", "GET", "/json", "", "", true },
+        { "file", "GET", "/file", "", "", true },
+        { "param", "GET", "/user/12345/order/67890", "", "", true },
+        { "upload", "POST", "/upload", multipart_body(),
+          "multipart/form-data; boundary=" + kBoundary, true },
+        { "proxy", "GET", "/proxy", "", "", true },
+        // Push 的服务端任务在推送结束后还会等待条件，客户端每次请求后关闭连接
+        { "push", "GET", "/push", "", "", false },
+        { "catalog", "GET", "/catalog?page=1&size=200", "", "", true },
+        { "cached", "GET", "/cached?page=1&size=200", "", "", true },
+    };
+}
+
+// 驱动 Push 路由：周期性唤醒条件任务，直到推送结束且服务端发现连接断开
+void push_driver(WFTimerTask *timer)
+{
+    auto *state = static_cast<std::shared_ptr<PushState> *>(timer->user_data);
+    if ((*state)->closed || ((*state)->finished && ++(*state)->ticks > 100))
+    {
+        delete state;
+        return;
+    }
+
+    WFTaskFactory::signal_by_name((*state)->cond_name, NULL);
+
+    // 推送阶段每 100us 唤醒一次，结束后每 10ms 唤醒一次，让服务端尽快发现连接断开
+    unsigned int interval = (*state)->finished ? 10000 : 100;
+    WFTimerTask *next = WFTaskFactory::create_timer_task(interval, push_driver);
+    next->user_data = state;
+    series_of(timer)->push_back(next);
+}
+
+void register_routes(HttpServer &svr, const std::string &file_path, unsigned short upstream_port)
+{
+    static const std::string hello(128, 'h');
+    svr.GET("/string", [](const HttpReq *req, HttpResp *resp) {
+        resp->String(hello);
+    });
+
+    static const Json payload = Json::parse(
+        R"({"code":0,"msg":"ok","data":{"id":12345,"name":"alice","tags":["a","b","c"],)"
+        R"("items":[{"sku":"A-1","qty":2,"price":19.99},{"sku":"B-2","qty":1,"price":5.5}]}})");
+    svr.GET("/json", [](const HttpReq *req, HttpResp *resp) {
+        resp->Json(payload);
+    });
+
+    svr.GET("/file", [file_path](const HttpReq *req, HttpResp *resp) {
+        resp->File(file_path);
+    });
+
+    svr.GET("/user/{uid}/order/{oid}", [](const HttpReq *req, HttpResp *resp) {
+        resp->String(req->param("uid") + ":" + req->param("oid"));
+    });
+
+    svr.POST("/upload", [](const HttpReq *req, HttpResp *resp) {
+        const Form &form = req->form();
+        size_t bytes = 0;
+        for (const auto &part : form)
+            bytes += part.second.second.size();
+        resp->String(std::to_string(form.size()) + " parts, " + std::to_string(bytes) + " bytes");
+    });
+
+    std::string upstream = "http://127.0.0.1:" + std::to_string(upstream_port) + "/upstream";
+    svr.GET("/proxy", [upstream](const HttpReq *req, HttpResp *resp) {
+        resp->Http(upstream);
+    });
+
+    static std::atomic<long> push_seq{0};
+    svr.GET("/push", [](const HttpReq *req, HttpResp *resp) {
+        auto state = std::make_shared<PushState>();
+        state->cond_name = "load_push_" + std::to_string(push_seq++);
+
+        resp->Push(state->cond_name, [state](std::string &data) {
+            int n = state->sent++;
+            if (n < kPushChunks)
+                data.append("data: chunk ").append(std::to_string(n)).append("\n\n");
+            else
+                state->finished = true;  // 返回空数据表示推送结束
+        }, [state] {
+            state->closed = true;
+        });
+
+        // 驱动定时器运行在独立的序列中
+        WFTimerTask *timer = WFTaskFactory::create_timer_task(100, push_driver);
+        timer->user_data = new std::shared_ptr<PushState>(state);
+        timer->start();
+    });
+
+    // 模拟由查询结果生成的商品列表，每次请求都重新构造和序列化
+    auto catalog = [](const HttpReq *req, HttpResp *resp) {
+        int page = atoi(req->default_query("page", "1").c_str());
+        int size = atoi(req->default_query("size", "20").c_str());
+        Json items = Json::Array();
+        for (int i = 0; i < size; i++)
+        {
+            int id = (page - 1) * size + i;
+            Json item;
+            item["id"] = id;
+            item["sku"] = "SKU-" + std::to_string(id);
+            item["name"] = "catalog item " + std::to_string(id);
+            item["price"] = id * 0.25 + 9.99;
+            item["stock"] = id % 17;
+            items.push_back(item);
+        }
+        Json body;
+        body["page"] = page;
+        body["items"] = items;
+        resp->Json(body);
+    };
+    svr.GET("/catalog", catalog);
+    svr.GET("/cached", catalog, ResponseCache(1));
+}
+
+void request_callback(WFHttpTask *task);
+
+WFHttpTask *create_request(ConnCtx *ctx)
+{
+    const RouteSpec &route = *ctx->route;
+    WFHttpTask *task = WFTaskFactory::create_http_task(ctx->url, 0, 0, request_callback);
+    HttpRequest *req = task->get_req();
+    req->set_method(route.method);
+    if (!route.content_type.empty())
+        req->add_header_pair("Content-Type", route.content_type);
+    if (!route.body.empty())
+        req->append_output_body_nocopy(route.body.data(), route.body.size());
+    if (!route.keep_alive)
+    {
+        // 服务端要求 keep-alive 才会推送，客户端收到完整响应后自行关闭连接
+        req->add_header_pair("Connection", "Keep-Alive");
+        task->set_keep_alive(0);
+    }
+    task->user_data = ctx;
+    ctx->start = Clock::now();
+    return task;
+}
+
+void request_callback(WFHttpTask *task)
+{
+    auto *ctx = static_cast<ConnCtx *>(task->user_data);
+    int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    Clock::now() - ctx->start).count();
+
+    const char *code = task->get_resp()->get_status_code();
+    if (task->get_state() != WFT_STATE_SUCCESS || !code || strcmp(code, "200") != 0)
+        ctx->errors++;
+    else
+        ctx->latencies.push_back(us);
+
+    if (--ctx->remaining > 0)
+        series_of(task)->push_back(create_request(ctx));
+}
+
+int64_t percentile(const std::vector<int64_t> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    size_t index = static_cast<size_t>(p * sorted.size());
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void run_route(const Options &opts, const RouteSpec &route)
+{
+    std::vector<std::unique_ptr<ConnCtx>> conns;
+    WFFacilities::WaitGroup wait_group(opts.connections);
+    std::string url = "http://127.0.0.1:" + std::to_string(opts.port) + route.path;
+
+    Clock::time_point begin = Clock::now();
+    for (int i = 0; i < opts.connections; i++)
+    {
+        std::unique_ptr<ConnCtx> ctx(new ConnCtx);
+        ctx->route = &route;
+        ctx->url = url;
+        ctx->remaining = opts.requests;
+        ctx->latencies.reserve(opts.requests);
+        ctx->wait_group = &wait_group;
+
+        SeriesWork *series = Workflow::create_series_work(create_request(ctx.get()),
+            [](const SeriesWork *series) {
+                static_cast<ConnCtx *>(series->get_context())->wait_group->done();
+            });
+        series->set_context(ctx.get());
+        series->start();
+        conns.emplace_back(std::move(ctx));
+    }
+    wait_group.wait();
+    double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    std::vector<int64_t> latencies;
+    int errors = 0;
+    for (const auto &ctx : conns)
+    {
+        latencies.insert(latencies.end(), ctx->latencies.begin(), ctx->latencies.end());
+        errors += ctx->errors;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    fprintf(stdout, "%-8s %10zu %8d %12.0f %10lld %10lld %10lld %10lld\n",
+            route.name.c_str(), latencies.size(), errors,
+            latencies.size() / seconds,
+            (long long)percentile(latencies, 0.50),
+            (long long)percentile(latencies, 0.99),
+            (long long)percentile(latencies, 0.999),
+            (long long)(latencies.empty() ? 0 : latencies.back()));
+    fflush(stdout);
+}
+
+std::string create_file(size_t size)
+{
+    char path[] = "/tmp/yukino_load_bench_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return "";
+
+    std::string data(size, 'f');
+    ssize_t ret = write(fd, data.data(), data.size());
+    close(fd);
+    return ret == static_cast<ssize_t>(size) ? path : "";
+}
+
+}  // namespace
+
+int main(int argc, char *argv[])
+{
+    Options opts;
+    int ch;
+    while ((ch = getopt(argc, argv, "p:c:n:m:k:r:h")) != -1)
+    {
+        switch (ch)
+        {
+        case 'p': opts.port = static_cast<unsigned short>(atoi(optarg)); break;
+        case 'c': opts.connections = atoi(optarg); break;
+        case 'n': opts.requests = atoi(optarg); break;
+        case 'm': opts.max_connections = strtoul(optarg, NULL, 10); break;
+        case 'k': opts.keep_alive_timeout = atoi(optarg); break;
+        case 'r': opts.routes = split_list(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-p port] [-c connections] [-n requests] "
+                            "[-m max_connections] [-k keep_alive_timeout_ms] "
+                            "[-r string,json,file,param,upload,proxy,push,catalog,cached]\n", argv[0]);
+            return ch == 'h' ? 0 : 1;
+        }
+    }
+    if (opts.connections <= 0 || opts.requests <= 0)
+    {
+        fprintf(stderr, "connections and requests must be positive\n");
+        return 1;
+    }
+
+    // 客户端到同一地址的连接数至少要覆盖并发数
+    struct WFGlobalSettings settings = GLOBAL_SETTINGS_DEFAULT;
+    settings.endpoint_params.max_connections = std::max(opts.connections * 2, 200);
+    WORKFLOW_library_init(&settings);
+
+    std::string file_path = create_file(16 * 1024);
+    if (file_path.empty())
+    {
+        perror("create file");
+        return 1;
+    }
+
+    unsigned short upstream_port = opts.port + 1;
+    HttpServer upstream;
+    upstream.GET("/upstream", [](const HttpReq *req, HttpResp *resp) {
+        resp->String("upstream says hello");
+    });
+
+    HttpServer svr;
+    svr.max_connections(opts.max_connections)
+       .keep_alive_timeout(opts.keep_alive_timeout);
+    register_routes(svr, file_path, upstream_port);
+
+    if (upstream.start(upstream_port) != 0 || svr.start(opts.port) != 0)
+    {
+        perror("start server");
+        unlink(file_path.c_str());
+        return 1;
+    }
+
+    fprintf(stdout, "connections=%d requests/conn=%d max_connections=%zu keep_alive_timeout=%dms\n",
+            opts.connections, opts.requests, opts.max_connections, opts.keep_alive_timeout);
+    fprintf(stdout, "%-8s %10s %8s %12s %10s %10s %10s %10s\n",
+            "route", "ok", "errors", "req/s", "p50(us)", "p99(us)", "p999(us)", "max(us)");
+
+    std::vector<RouteSpec> specs = all_route_specs();
+    for (const std::string &name : opts.routes)
+    {
+        auto it = std::find_if(specs.begin(), specs.end(),
+                               [&name](const RouteSpec &spec) { return spec.name == name; });
+        if (it == specs.end())
+        {
+            fprintf(stderr, "unknown route: %s\n", name.c_str());
+            continue;
+        }
+        run_route(opts, *it);
+    }
+
+    svr.stop();
+    upstream.stop();
+    unlink(file_path.c_str());
+    return 0;
+}
@@ -0,0 +1,186 @@
+// Json 序列化和解析的基准测试
+// 语料：小的接口响应、用户列表、以数字为主的时序数据、含大量转义字符的文本，以及约 200KB 的格式化用户列表
+// BM_JsonParseLegacy 直接调用 workflow 的 json_value_parse，与 Json::parse 的快速解析器对比
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "Json.h"
+#include "JsonView.h"
+
+using namespace Yukino;
+
+namespace
+{
+
+std::string small_object()
+{
+    return R"({"code":0,"msg":"ok","data":{"id":12345,"name":"alice","admin":false,"score":98.5,"tags":["a","b","c"]}})";
+}
+
+std::string user_list(int count)
+{
+    std::string text = "{\"total\":" + std::to_string(count) + ",\"users\":[";
+    for (int i = 0; i < count; i++)
+    {
+        if (i)
+            text += ",";
+        text += "{\"id\":" + std::to_string(100000 + i) +
+                ",\"name\":\"user_" + std::to_string(i) + "\"" +
+                ",\"email\":\"user_" + std::to_string(i) + "@example.com\"" +
+                ",\"active\":" + (i % 3 ? "true" : "false") +
+                ",\"balance\":" + std::to_string(i * 13.37) +
+                ",\"roles\":[\"reader\",\"writer\"]" +
+                ",\"profile\":{\"city\":\"Shanghai\",\"zip\":\"200000\",\"phone\":null}}";
+    }
+    text += "]}";
+    return text;
+}
+
+std::string time_series(int count)
+{
+    std::string text = "{\"metric\":\"cpu.load\",\"points\":[";
+    for (int i = 0; i < count; i++)
+    {
+        if (i)
+            text += ",";
+        text += "[" + std::to_string(1718000000 + i * 10) + "," +
+                std::to_string(0.5 + (i % 97) * 0.0123456789) + "]";
+    }
+    text += "]}";
+    return text;
+}
+
+std::string escaped_text(int count)
+{
+    std::string text = "{\"logs\":[";
+    for (int i = 0; i < count; i++)
+    {
+        if (i)
+            text += ",";
+        text += "\"line " + std::to_string(i) +
+                ": \\\"GET /index.html\\\"\\tstatus=200\\npath=C:\\\\www\\\\root \\u4e2d\\u6587\"";
+    }
+    text += "]}";
+    return text;
+}
+
+const std::vector<std::string> &corpus()
+{
+    static const std::vector<std::string> texts = {
+        small_object(),
+        user_list(100),
+        time_series(1000),
+        escaped_text(200),
+        Json::parse(user_list(800)).dump(2),
+    };
+    return texts;
+}
+
+const char *corpus_name(int index)
+{
+    static const char *names[] = { "small", "users", "series", "escaped", "users_pretty" };
+    return names[index];
+}
+
+void BM_JsonParse(benchmark::State &state)
+{
+    const std::string &text = corpus()[state.range(0)];
+    for (auto _ : state)
+    {
+        Json json = Json::parse(text);
+        benchmark::DoNotOptimize(json);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetLabel(corpus_name(state.range(0)));
+}
+
+void BM_JsonParseLegacy(benchmark::State &state)
+{
+    const std::string &text = corpus()[state.range(0)];
+    for (auto _ : state)
+    {
+        json_value_t *root = json_value_parse(text.c_str());
+        benchmark::DoNotOptimize(root);
+        if (root)
+            json_value_destroy(root);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetLabel(corpus_name(state.range(0)));
+}
+
+void BM_JsonDump(benchmark::State &state)
+{
+    const std::string &text = corpus()[state.range(0)];
+    Json json = Json::parse(text);
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        std::string out = json.dump();
+        bytes += out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(bytes);
+    state.SetLabel(corpus_name(state.range(0)));
+}
+
+// 复用同一个输出缓冲区，与 HttpResp::Json 写入内存池中字符串的方式相同
+void BM_JsonDumpTo(benchmark::State &state)
+{
+    const std::string &text = corpus()[state.range(0)];
+    Json json = Json::parse(text);
+    std::string out;
+    size_t bytes = 0;
+    for (auto _ : state)
+    {
+        out.clear();
+        json.dump_to(&out);
+        bytes += out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(bytes);
+    state.SetLabel(corpus_name(state.range(0)));
+}
+
+// 只读取大请求体中的几个字段：完整解析后查找，与 JsonView 按需扫描对比
+void BM_JsonFieldsParse(benchmark::State &state)
+{
+    const std::string &text = corpus()[state.range(0)];
+    for (auto _ : state)
+    {
+        Json json = Json::parse(text);
+        double total = json["total"].get<double>();
+        std::string name = json["users"][3]["name"].get<std::string>();
+        benchmark::DoNotOptimize(total);
+        benchmark::DoNotOptimize(name.data());
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetLabel(corpus_name(state.range(0)));
+}
+
+void BM_JsonFieldsView(benchmark::State &state)
+{
+    const std::string &text = corpus()[state.range(0)];
+    for (auto _ : state)
+    {
+        JsonView json(text);
+        double total = json["total"].get_number();
+        StringPiece name = json["users"][3]["name"].string_piece();
+        benchmark::DoNotOptimize(total);
+        benchmark::DoNotOptimize(name.data());
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetLabel(corpus_name(state.range(0)));
+}
+
+}  // namespace
+
+BENCHMARK(BM_JsonParse)->DenseRange(0, 4);
+BENCHMARK(BM_JsonParseLegacy)->DenseRange(0, 4);
+BENCHMARK(BM_JsonDump)->DenseRange(0, 4);
+BENCHMARK(BM_JsonDumpTo)->DenseRange(0, 4);
+// 第 1 个和第 4 个语料是用户列表
+BENCHMARK(BM_JsonFieldsParse)->Arg(1)->Arg(4);
+BENCHMARK(BM_JsonFieldsView)->Arg(1)->Arg(4);
@@ -0,0 +1,94 @@
+// multipart/form-data 解析的基准测试
+// 语料：只有几个文本字段的表单、文本字段加一个小头像、多个大文件的批量上传
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "HttpContent.h"
+#include "StringPiece.h"
+
+using namespace Yukino;
+
+namespace
+{
+
+const std::string kBoundary = "----WebKitFormBoundaryB3nchM4rkB0und";
+
+struct Part
+{
+    std::string name;
+    std::string filename;  // 为空表示普通文本字段
+    std::string content;
+};
+
+// 伪随机的文件内容，避免全是相同字节
+std::string file_content(size_t size, unsigned seed)
+{
+    std::string data(size, '\0');
+    for (size_t i = 0; i < size; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        data[i] = static_cast<char>(seed >> 16);
+    }
+    return data;
+}
+
+std::string build_body(const std::vector<Part> &parts)
+{
+    std::string body;
+    for (const Part &part : parts)
+    {
+        body.append("--").append(kBoundary).append("\r\n");
+        body.append("Content-Disposition: form-data; name=\"").append(part.name).append("\"");
+        if (!part.filename.empty())
+        {
+            body.append("; filename=\"").append(part.filename).append("\"\r\n");
+            body.append("Content-Type: application/octet-stream");
+        }
+        body.append("\r\n\r\n").append(part.content).append("\r\n");
+    }
+    body.append("--").append(kBoundary).append("--\r\n");
+    return body;
+}
+
+const std::vector<std::string> &corpus()
+{
+    static const std::vector<std::string> bodies = {
+        build_body({
+            {"username", "", "alice"},
+            {"email", "", "alice@example.com"},
+            {"bio", "", std::string(200, 'b')},
+        }),
+        build_body({
+            {"username", "", "bob"},
+            {"avatar", "avatar.png", file_content(16 * 1024, 1)},
+        }),
+        build_body({
+            {"album", "", "holiday"},
+            {"photo1", "IMG_0001.JPG", file_content(512 * 1024, 2)},
+            {"photo2", "IMG_0002.JPG", file_content(512 * 1024, 3)},
+            {"photo3", "IMG_0003.JPG", file_content(512 * 1024, 4)},
+        }),
+    };
+    return bodies;
+}
+
+void BM_ParseMultipart(benchmark::State &state)
+{
+    const std::string &body = corpus()[state.range(0)];
+    MultiPartForm form;
+    form.set_boundary(kBoundary);
+    for (auto _ : state)
+    {
+        Form parsed = form.parse_multipart(StringPiece(body));
+        benchmark::DoNotOptimize(parsed);
+    }
+    state.SetBytesProcessed(state.iterations() * body.size());
+}
+
+}  // namespace
+
+// 0: 纯文本表单，1: 16KB 头像，2: 3 张 512KB 的图片
+BENCHMARK(BM_ParseMultipart)->DenseRange(0, 2);
@@ -0,0 +1,97 @@
+// 请求路径预处理的基准测试
+// old: HttpServer::process 原来的做法，先规范化到新的 std::string，再整体 url_encode 一次
+// new: CodeUtil::normalize_path 单次遍历完成规范化和编码，写入预先分配的缓冲区
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "CodeUtil.h"
+#include "StringPiece.h"
+
+using namespace Yukino;
+
+namespace
+{
+
+// 常见的请求路径：REST 接口、静态资源、带编码的非 ASCII 路径、带 "." 和 ".." 的路径
+const std::vector<std::string> kPaths = {
+    "/",
+    "/api/v1/users/12345",
+    "/api/v1/users/12345/orders/67890/items",
+    "/static/js/app.8f3c2a1b.min.js",
+    "/static/css/../img/logo@2x.png",
+    "/docs/./guide//getting-started/",
+    "/search/%E4%B8%AD%E6%96%87/%E6%B5%8B%E8%AF%95",
+    "/files/my%20report%202024.pdf",
+    "/a/b/c/d/e/f/g/h/i/j/k/l/m/n/o/p",
+};
+
+// 原来的预处理流程
+std::string old_preprocess(const char *path)
+{
+    std::string route("/");
+    const char *pos = path;
+    while (*pos)
+    {
+        const char *slash = pos;
+        while (*slash && *slash != '/')
+            slash++;
+
+        size_t n = slash - pos;
+        if (n == 0 || (n == 1 && *pos == '.'))
+            ;
+        else if (n == 2 && *pos == '.' && pos[1] == '.')
+        {
+            if (route.size() > 1)
+            {
+                n = route.find_last_of('/', route.size() - 2);
+                route.resize(n + 1);
+            }
+        }
+        else
+        {
+            route.append(pos, slash);
+            if (*slash)
+                route.push_back('/');
+        }
+
+        if (!*slash)
+            break;
+
+        pos = slash + 1;
+    }
+    return CodeUtil::url_encode(route);
+}
+
+void BM_OldPreprocess(benchmark::State &state)
+{
+    const std::string &path = kPaths[state.range(0)];
+    for (auto _ : state)
+    {
+        std::string route = old_preprocess(path.c_str());
+        benchmark::DoNotOptimize(route.data());
+    }
+    state.SetLabel(path);
+}
+
+void BM_NewNormalize(benchmark::State &state)
+{
+    const std::string &path = kPaths[state.range(0)];
+    // 真实请求中输出缓冲区从任务的内存池分配
+    std::vector<char> buf(CodeUtil::normalize_path_bound(path.size()));
+    for (auto _ : state)
+    {
+        size_t len = CodeUtil::normalize_path(path.c_str(), path.size(), buf.data());
+        benchmark::DoNotOptimize(len);
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetLabel(path);
+}
+
+}  // namespace
+
+BENCHMARK(BM_OldPreprocess)->DenseRange(0, 8);
+BENCHMARK(BM_NewNormalize)->DenseRange(0, 8);
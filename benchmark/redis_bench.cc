@@ -0,0 +1,317 @@
+// Redis 上游的基准测试
+// 在回环地址上启动一个基于 WFRedisServer 的替身 Redis 服务器（支持 PING、SET、GET、MGET、INCR，其他命令回复错误），
+// 每次迭代执行 N 条 GET：
+//   BM_RedisUrlSerial：每条命令按 URL 创建任务（每次都解析 URL），串行执行
+//   BM_RedisUpstreamSerial：使用预先注册的上游创建任务，串行执行
+//   BM_RedisBatch：使用 RedisUpstream::create_batch 同时发出，所有命令完成后回调一次
+//   BM_RedisMget：一条 MGET 取 N 个键
+// 开始前先执行一组覆盖所有回复类型的命令，检查 RedisUpstream::reply_to_json 的结果，不一致时跳过并报错
+
+#include <benchmark/benchmark.h>
+
+#include "workflow/WFFacilities.h"
+#include "workflow/WFRedisServer.h"
+#include "workflow/WFTaskFactory.h"
+#include "workflow/Workflow.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Json.h"
+#include "RedisUpstream.h"
+
+using namespace Yukino;
+using namespace protocol;
+
+namespace
+{
+
+// 替身 Redis 服务器，数据保存在内存中
+class StandInRedis
+{
+public:
+    StandInRedis() : server_([this](WFRedisTask *task) { this->process(task); })
+    {
+    }
+
+    // 在回环地址的随机端口上启动，返回 redis:// URL，失败时返回空字符串
+    std::string start()
+    {
+        if (server_.start(AF_INET, "127.0.0.1", 0) != 0)
+            return std::string();
+
+        struct sockaddr_in addr;
+        socklen_t len = sizeof addr;
+        server_.get_listen_addr(reinterpret_cast<struct sockaddr *>(&addr), &len);
+        return "redis://127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+    }
+
+    void stop()
+    {
+        server_.stop();
+    }
+
+private:
+    void process(WFRedisTask *task)
+    {
+        std::string command;
+        std::vector<std::string> params;
+        task->get_req()->get_command(command);
+        task->get_req()->get_params(params);
+
+        RedisValue value;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (command == "PING")
+        {
+            value.set_status("PONG");
+        }
+        else if (command == "SET" && params.size() == 2)
+        {
+            data_[params[0]] = params[1];
+            value.set_status("OK");
+        }
+        else if (command == "GET" && params.size() == 1)
+        {
+            get(params[0], &value);
+        }
+        else if (command == "MGET" && !params.empty())
+        {
+            value.set_array(params.size());
+            for (size_t i = 0; i < params.size(); i++)
+                get(params[i], &value.arr_at(i));
+        }
+        else if (command == "INCR" && params.size() == 1)
+        {
+            std::string &number = data_[params[0]];
+            long long n = atoll(number.c_str()) + 1;
+            number = std::to_string(n);
+            value.set_int(n);
+        }
+        else
+        {
+            value.set_error("ERR unknown command '" + command + "'");
+        }
+        task->get_resp()->set_result(value);
+    }
+
+    void get(const std::string &key, RedisValue *value)
+    {
+        auto it = data_.find(key);
+        if (it == data_.end())
+            value->set_nil();
+        else
+            value->set_string(it->second);
+    }
+
+private:
+    WFRedisServer server_;
+    std::mutex mutex_;
+    std::map<std::string, std::string> data_;
+};
+
+struct Fixture
+{
+    StandInRedis server;
+    std::string url;
+    const RedisUpstream *upstream = nullptr;
+    std::string error;  // 启动或检查失败的原因
+
+    Fixture()
+    {
+        url = server.start();
+        if (url.empty())
+        {
+            error = "start stand-in redis server failed";
+            return;
+        }
+
+        upstream = RedisUpstream::add("bench", url, 64);
+        if (!upstream)
+        {
+            error = "register redis upstream failed";
+            return;
+        }
+
+        check_replies();
+        if (!error.empty())
+            return;
+
+        // 基准测试读取的键
+        std::vector<RedisCommand> commands;
+        for (int i = 0; i < 64; i++)
+            commands.push_back({ "SET", { "key" + std::to_string(i), "value" + std::to_string(i) } });
+        run_batch(commands, nullptr);
+    }
+
+    ~Fixture()
+    {
+        if (!url.empty())
+            server.stop();
+    }
+
+    void run_batch(const std::vector<RedisCommand> &commands, std::vector<RedisReply> *out)
+    {
+        WFFacilities::WaitGroup wait_group(1);
+        ParallelWork *pwork = upstream->create_batch(commands, [out, &wait_group](std::vector<RedisReply> *replies)
+        {
+            if (out)
+                *out = std::move(*replies);
+            wait_group.done();
+        });
+        pwork->start();
+        wait_group.wait();
+    }
+
+    // 覆盖状态、字符串、nil、数组、整数和错误回复
+    void check_replies()
+    {
+        std::vector<RedisCommand> commands = {
+            { "SET", { "check", "1" } },
+            { "GET", { "check" } },
+            { "GET", { "missing" } },
+            { "MGET", { "check", "missing" } },
+            { "INCR", { "counter" } },
+            { "PING", {} },
+            { "BOGUS", {} },
+        };
+        std::vector<RedisReply> replies;
+        run_batch(commands, &replies);
+
+        Json array = Json::Array();
+        for (const RedisReply &reply : replies)
+            array.push_back(RedisUpstream::reply_to_json(reply));
+
+        const std::string expected =
+            "[\"OK\",\"1\",null,[\"1\",null],1,\"PONG\",{\"error\":\"ERR unknown command 'BOGUS'\"}]";
+        std::string result = array.dump();
+        if (result != expected)
+            error = "reply_to_json mismatch: " + result;
+    }
+};
+
+Fixture &fixture()
+{
+    static Fixture fixture;
+    return fixture;
+}
+
+std::string key(int i)
+{
+    return "key" + std::to_string(i % 64);
+}
+
+// 把 N 个任务串成一个 series 执行，等待全部完成
+void run_serial(std::vector<SubTask *> &tasks)
+{
+    WFFacilities::WaitGroup wait_group(1);
+    SeriesWork *series = Workflow::create_series_work(tasks[0], [&wait_group](const SeriesWork *)
+    {
+        wait_group.done();
+    });
+    for (size_t i = 1; i < tasks.size(); i++)
+        series->push_back(tasks[i]);
+    series->start();
+    wait_group.wait();
+}
+
+void BM_RedisUrlSerial(benchmark::State &state)
+{
+    Fixture &f = fixture();
+    if (!f.error.empty())
+    {
+        state.SkipWithError(f.error.c_str());
+        return;
+    }
+
+    int n = static_cast<int>(state.range(0));
+    std::vector<SubTask *> tasks(n);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            WFRedisTask *task = WFTaskFactory::create_redis_task(f.url, 2, nullptr);
+            task->get_req()->set_request("GET", { key(i) });
+            tasks[i] = task;
+        }
+        run_serial(tasks);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_RedisUrlSerial)->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
+
+void BM_RedisUpstreamSerial(benchmark::State &state)
+{
+    Fixture &f = fixture();
+    if (!f.error.empty())
+    {
+        state.SkipWithError(f.error.c_str());
+        return;
+    }
+
+    int n = static_cast<int>(state.range(0));
+    std::vector<SubTask *> tasks(n);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < n; i++)
+            tasks[i] = f.upstream->create_task("GET", { key(i) }, nullptr);
+        run_serial(tasks);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_RedisUpstreamSerial)->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
+
+void BM_RedisBatch(benchmark::State &state)
+{
+    Fixture &f = fixture();
+    if (!f.error.empty())
+    {
+        state.SkipWithError(f.error.c_str());
+        return;
+    }
+
+    int n = static_cast<int>(state.range(0));
+    std::vector<RedisCommand> commands;
+    for (int i = 0; i < n; i++)
+        commands.push_back({ "GET", { key(i) } });
+
+    for (auto _ : state)
+        f.run_batch(commands, nullptr);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_RedisBatch)->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
+
+void BM_RedisMget(benchmark::State &state)
+{
+    Fixture &f = fixture();
+    if (!f.error.empty())
+    {
+        state.SkipWithError(f.error.c_str());
+        return;
+    }
+
+    int n = static_cast<int>(state.range(0));
+    std::vector<std::string> keys;
+    for (int i = 0; i < n; i++)
+        keys.push_back(key(i));
+
+    for (auto _ : state)
+    {
+        WFFacilities::WaitGroup wait_group(1);
+        WFRedisTask *task = f.upstream->create_task("MGET", keys, [&wait_group](WFRedisTask *)
+        {
+            wait_group.done();
+        });
+        task->start();
+        wait_group.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_RedisMget)->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,139 @@
+// 路由匹配的基准测试
+// 路由表模拟一个中等规模的 REST 服务：静态路由、带 {param} 的路由和通配符路由混合注册，
+// 分别测试冻结前（路由树）和冻结后（扁平数组）的匹配速度
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "RouteTable.h"
+#include "RouteParams.h"
+#include "StringPiece.h"
+
+using namespace Yukino;
+
+namespace
+{
+
+const std::vector<std::string> kResources = {
+    "users", "orders", "items", "products", "carts", "payments", "invoices",
+    "reviews", "categories", "tags", "sessions", "tokens", "files", "reports",
+    "notifications", "settings", "teams", "projects", "tasks", "comments",
+};
+
+// 注册路由，返回路由字符串（RouteTable 中保存的 key 指向这些字符串）
+std::vector<std::string> build_routes()
+{
+    std::vector<std::string> routes;
+    for (const std::string &res : kResources)
+    {
+        routes.push_back("/api/v1/" + res);
+        routes.push_back("/api/v1/" + res + "/count");
+        routes.push_back("/api/v1/" + res + "/{id}");
+        routes.push_back("/api/v1/" + res + "/{id}/history");
+        routes.push_back("/api/v2/" + res + "/{id}/children/{child_id}");
+        routes.push_back("/admin/" + res + "/export");
+    }
+    routes.push_back("/");
+    routes.push_back("/health");
+    routes.push_back("/static/*");
+    routes.push_back("/assets/*");
+    routes.push_back("/download/{bucket}/*");
+    return routes;
+}
+
+struct Fixture
+{
+    Fixture(bool frozen) : routes(build_routes())
+    {
+        for (const std::string &route : routes)
+            table.find_or_create(route.c_str());
+        if (frozen)
+            table.freeze();
+    }
+
+    std::vector<std::string> routes;
+    RouteTable table;
+};
+
+Fixture &fixture(bool frozen)
+{
+    static Fixture tree(false);
+    static Fixture flat(true);
+    return frozen ? flat : tree;
+}
+
+// 请求路径，按类型分组
+const std::vector<std::string> kStaticPaths = {
+    "/health",
+    "/api/v1/users",
+    "/api/v1/orders/count",
+    "/admin/reports/export",
+    "/api/v1/notifications",
+};
+
+const std::vector<std::string> kParamPaths = {
+    "/api/v1/users/12345",
+    "/api/v1/orders/987654321/history",
+    "/api/v2/projects/42/children/7",
+    "/api/v1/comments/c0ffee",
+    "/api/v2/teams/engineering/children/backend",
+};
+
+const std::vector<std::string> kWildcardPaths = {
+    "/static/js/app.8f3c2a1b.min.js",
+    "/static/css/main.css",
+    "/assets/img/icons/logo@2x.png",
+    "/download/public/2024/report.pdf",
+    "/download/private/a/b/c/d/e.bin",
+};
+
+const std::vector<std::string> kMissPaths = {
+    "/api/v3/users",
+    "/api/v1/unknown/1",
+    "/favicon.ico",
+    "/api/v1/users/1/history/extra/deep",
+    "/adminx/reports/export",
+};
+
+void run_find(benchmark::State &state, const std::vector<std::string> &paths)
+{
+    Fixture &fx = fixture(state.range(0) != 0);
+    RouteParams params;
+    StringPiece match_path;
+    size_t found = 0;
+    for (auto _ : state)
+    {
+        for (const std::string &path : paths)
+        {
+            params.clear();
+            auto it = fx.table.find(StringPiece(path), params, match_path);
+            found += (it != fx.table.end());
+            benchmark::DoNotOptimize(it);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * paths.size());
+    state.SetLabel(state.range(0) ? "frozen" : "tree");
+    benchmark::DoNotOptimize(found);
+}
+
+void BM_RouteFindStatic(benchmark::State &state)
+{ run_find(state, kStaticPaths); }
+
+void BM_RouteFindParam(benchmark::State &state)
+{ run_find(state, kParamPaths); }
+
+void BM_RouteFindWildcard(benchmark::State &state)
+{ run_find(state, kWildcardPaths); }
+
+void BM_RouteFindMiss(benchmark::State &state)
+{ run_find(state, kMissPaths); }
+
+}  // namespace
+
+// 参数 0 表示路由树，1 表示冻结后的扁平数组
+BENCHMARK(BM_RouteFindStatic)->Arg(0)->Arg(1);
+BENCHMARK(BM_RouteFindParam)->Arg(0)->Arg(1);
+BENCHMARK(BM_RouteFindWildcard)->Arg(0)->Arg(1);
+BENCHMARK(BM_RouteFindMiss)->Arg(0)->Arg(1);
@@ -0,0 +1,82 @@
+#include <cstdlib>
+
+#include "Arena.h"
+
+using namespace Yukino;
+
+// 内存块头部大小，向上对齐，保证块中数据的起始地址满足默认对齐
+static constexpr size_t kBlockHeader =
+    (sizeof(void *) * 2 + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+static inline char *align_up(char *ptr, size_t align)
+{
+    size_t pad = (align - reinterpret_cast<size_t>(ptr) % align) % align;
+    return ptr + pad;
+}
+
+void *Arena::allocate_slow(size_t size, size_t align)
+{
+    // 第一次分配时先使用内联存储
+    if (!cur_)
+    {
+        char *ptr = align_up(inline_, align);
+        if (ptr + size <= inline_ + INLINE_SIZE)
+        {
+            cur_ = ptr + size;
+            end_ = inline_ + INLINE_SIZE;
+            return ptr;
+        }
+    }
+
+    // 大块内存单独申请，不影响当前块的剩余空间
+    bool dedicated = size + align > BLOCK_SIZE / 2;
+    size_t block_size = dedicated ? kBlockHeader + size + align : BLOCK_SIZE;
+
+    auto *block = static_cast<Block *>(malloc(block_size));
+    if (!block)
+        throw std::bad_alloc();
+
+    block->next = blocks_;
+    block->size = block_size;
+    blocks_ = block;
+    heap_bytes_ += block_size;
+
+    char *data = reinterpret_cast<char *>(block) + kBlockHeader;
+    char *ptr = align_up(data, align);
+    if (!dedicated)
+    {
+        cur_ = ptr + size;
+        end_ = reinterpret_cast<char *>(block) + block_size;
+    }
+    else if (!cur_)
+    {
+        // 内联存储还没用过，保留给后续的小对象
+        cur_ = inline_;
+        end_ = inline_ + INLINE_SIZE;
+    }
+    return ptr;
+}
+
+void Arena::release()
+{
+    // 按登记的逆序析构对象
+    Cleanup *cleanup = cleanups_;
+    while (cleanup)
+    {
+        // 清理函数中可能还会访问 Arena 中的其他对象，先取出下一个节点
+        Cleanup *next = cleanup->next;
+        cleanup->func(cleanup->arg);
+        cleanup = next;
+    }
+    cleanups_ = nullptr;
+
+    Block *block = blocks_;
+    while (block)
+    {
+        Block *next = block->next;
+        free(block);
+        block = next;
+    }
+    blocks_ = nullptr;
+    heap_bytes_ = 0;
+}
@@ -0,0 +1,143 @@
+#ifndef YUKINO_ARENA_H_
+#define YUKINO_ARENA_H_
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Noncopyable.h"
+
+namespace Yukino
+{
+
+/**
+ * @brief 请求级的线性（bump）内存池
+ *
+ * 每个 HttpServerTask 拥有一个 Arena，请求处理过程中的临时对象都从这里分配，
+ * 任务结束时调用 reset() 一次性析构并回收，不再为每个对象单独 new/delete
+ * 或注册 std::function 清理回调。
+ *
+ * 前 INLINE_SIZE 字节直接存放在对象内部，用完后再按 BLOCK_SIZE 向系统申请新块，
+ * 超过 BLOCK_SIZE 一半的大块内存单独申请。
+ * Arena 不是线程安全的，一个请求的所有回调都在同一个序列中执行，不需要加锁。
+ */
+class Arena : public Noncopyable
+{
+public:
+    static constexpr size_t INLINE_SIZE = 2048;  // 内联存储大小
+    static constexpr size_t BLOCK_SIZE = 8192;   // 后续内存块大小
+
+    Arena() = default;
+
+    ~Arena()
+    { release(); }
+
+    /**
+     * @brief 分配一段未初始化的内存
+     *
+     * @param size 字节数
+     * @param align 对齐要求，必须是 2 的幂
+     * @return void* 内存地址，生命周期到下一次 reset() 为止
+     */
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t))
+    {
+        size_t pad = (align - reinterpret_cast<size_t>(cur_) % align) % align;
+        if (cur_ && pad + size <= static_cast<size_t>(end_ - cur_))
+        {
+            char *ptr = cur_ + pad;
+            cur_ = ptr + size;
+            return ptr;
+        }
+        return allocate_slow(size, align);
+    }
+
+    /**
+     * @brief 在 Arena 中构造对象
+     *
+     * 非平凡析构的对象会登记析构函数，reset() 时按构造的逆序析构。
+     */
+    template<typename T, typename... Args>
+    T *create(Args&&... args)
+    {
+        void *mem = allocate(sizeof(T), alignof(T));
+        T *obj = new (mem) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value)
+            add_cleanup(&Arena::destroy<T>, obj);
+        return obj;
+    }
+
+    /**
+     * @brief 将一段数据拷贝到 Arena 中
+     *
+     * @return char* 拷贝后的地址，不以 '\0' 结尾
+     */
+    char *copy(const void *data, size_t size)
+    {
+        char *ptr = static_cast<char *>(allocate(size, 1));
+        if (size > 0)
+            memcpy(ptr, data, size);
+        return ptr;
+    }
+
+    /**
+     * @brief 登记一个清理函数，reset() 时调用
+     *
+     * 清理节点本身也在 Arena 中分配，不会产生额外的堆分配。
+     */
+    void add_cleanup(void (*func)(void *), void *arg)
+    {
+        auto *node = static_cast<Cleanup *>(allocate(sizeof(Cleanup), alignof(Cleanup)));
+        node->func = func;
+        node->arg = arg;
+        node->next = cleanups_;
+        cleanups_ = node;
+    }
+
+    // 析构所有对象并回收内存，保留内联存储供下次使用
+    void reset()
+    {
+        release();
+        cur_ = nullptr;
+        end_ = nullptr;
+    }
+
+    // 已经向系统申请的内存块字节数（不含内联存储）
+    size_t heap_bytes() const
+    { return heap_bytes_; }
+
+private:
+    struct Cleanup
+    {
+        void (*func)(void *);
+        void *arg;
+        Cleanup *next;
+    };
+
+    struct Block
+    {
+        Block *next;
+        size_t size;
+    };
+
+    template<typename T>
+    static void destroy(void *obj)
+    { static_cast<T *>(obj)->~T(); }
+
+    void *allocate_slow(size_t size, size_t align);
+
+    void release();
+
+private:
+    alignas(std::max_align_t) char inline_[INLINE_SIZE];  // 内联存储
+    char *cur_ = nullptr;          // 当前块中下一个可用的位置，nullptr 表示尚未使用
+    char *end_ = nullptr;          // 当前块的结尾
+    Block *blocks_ = nullptr;      // 向系统申请的内存块链表
+    Cleanup *cleanups_ = nullptr;  // 清理函数链表，后登记的在前
+    size_t heap_bytes_ = 0;        // 向系统申请的字节数
+};
+
+}  // namespace Yukino
+
+#endif // YUKINO_ARENA_H_
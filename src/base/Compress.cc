@@ -1,8 +1,19 @@
 
 #include <cassert>  // 包含断言头文件，用于调试时检查条件
+#include <cstring>  // 包含strlen
+#include <strings.h>  // 包含strncasecmp，用于忽略大小写比较编码名称
 #include "Compress.h"  // 包含Compress类的声明
 #include "ErrorCode.h"  // 包含错误码的定义
 
+#ifdef YUKINO_WITH_BROTLI
+#include <brotli/encode.h>
+#include <brotli/decode.h>
+#endif
+
+#ifdef YUKINO_WITH_ZSTD
+#include <zstd.h>
+#endif
+
 namespace Yukino  // 使用Yukino命名空间
 {
     // 将压缩方法枚举值转换为字符串描述的函数实现
@@ -12,10 +23,38 @@ namespace Yukino  // 使用Yukino命名空间
         {
             case Compress::GZIP:  // 如果是GZIP压缩方法
                 return "gzip";  // 返回字符串描述
+            case Compress::BROTLI:  // 如果是Brotli压缩方法
+                return "br";
+            case Compress::ZSTD:  // 如果是Zstandard压缩方法
+                return "zstd";
             default:  // 其他未定义的压缩方法
                 return "unsupport compression";  // 返回不支持的提示
         }
     }
+
+    bool compress_method_from_str(const StringPiece &str, Compress *compress_method)
+    {
+        static const struct
+        {
+            const char *name;
+            Compress method;
+        } methods[] = {
+            { "gzip", Compress::GZIP },
+            { "x-gzip", Compress::GZIP },
+            { "br", Compress::BROTLI },
+            { "zstd", Compress::ZSTD },
+        };
+
+        for (const auto &m : methods)
+        {
+            if (str.size() == strlen(m.name) && strncasecmp(str.data(), m.name, str.size()) == 0)
+            {
+                *compress_method = m.method;
+                return true;
+            }
+        }
+        return false;
+    }
 }  // namespace Yukino
 
 using namespace Yukino;  // 使用Yukino命名空间，避免重复声明
@@ -29,65 +68,214 @@ int Compressor::gzip(const std::string * const src, std::string *dest)
 }
 
 // GZIP压缩函数的实现（重载版本）
-int Compressor::gzip(const char *data, const size_t len, std::string *dest)
+// 通过 GzipStream 复用线程池中的 z_stream，输出按实际压缩结果增长，不再按输入大小预分配
+int Compressor::gzip(const char *data, const size_t len, std::string *dest, CompressLevel level)
 {
     dest->clear();  // 清空目标字符串
-    z_stream strm = {nullptr,  // 初始化z_stream结构体
-                     0,
-                     0,
-                     nullptr,
-                     0,
-                     0,
-                     nullptr,
-                     nullptr,
-                     nullptr,
-                     nullptr,
-                     nullptr,
-                     0,
-                     0,
-                     0};
-    if (data && len > 0)  // 检查输入数据是否有效
-    {
-        if (deflateInit2(&strm,  // 初始化压缩流
-                         Z_DEFAULT_COMPRESSION,  // 默认压缩级别
+    if (!data || len == 0)  // 检查输入数据是否有效
+        return StatusCompressError;  // 输入数据无效，返回错误码
+
+    GzipStream stream(level);
+    return stream.update(data, len, true, [dest](const char *out, size_t out_len)
+    {
+        dest->append(out, out_len);  // 追加一块压缩结果
+    });
+}
+
+namespace
+{
+    // 每个线程每种压缩级别最多保留的空闲压缩流数，解压流同样
+    // 一个压缩流的内部状态约 256KB，同一线程同时进行的压缩很少超过这个数
+    constexpr size_t ZSTREAM_POOL_SIZE = 4;
+
+    // 压缩级别对应的 zlib 级别，下标为 CompressLevel 的取值
+    const int GZIP_LEVELS[] = {
+        Z_DEFAULT_COMPRESSION,  // AUTO
+        Z_BEST_SPEED,  // FASTEST
+        Z_DEFAULT_COMPRESSION,  // DEFAULT
+        Z_BEST_COMPRESSION,  // BEST
+    };
+
+    constexpr size_t LEVEL_COUNT = sizeof(GZIP_LEVELS) / sizeof(GZIP_LEVELS[0]);
+
+    // 一组已经初始化的空闲 z_stream
+    struct ZStreamList
+    {
+        z_stream *strms[ZSTREAM_POOL_SIZE];
+        size_t count = 0;
+    };
+
+    // 每个线程的压缩流池、解压流池和压缩输出缓冲区
+    // 取出的流用 deflateReset/inflateReset 复位后使用，不再重复 deflateInit2/inflateInit2
+    struct ZStreamPool
+    {
+        ZStreamList deflate_list[LEVEL_COUNT];  // 按压缩级别分开，复位不会改变级别
+        ZStreamList inflate_list;
+        char out[GzipStream::CHUNK_SIZE];  // 压缩输出缓冲区，只在 GzipStream::update 调用期间使用
+
+        ~ZStreamPool()
+        {
+            for (ZStreamList &list : deflate_list)
+            {
+                for (size_t i = 0; i < list.count; i++)
+                {
+                    (void)deflateEnd(list.strms[i]);
+                    delete list.strms[i];
+                }
+            }
+            for (size_t i = 0; i < inflate_list.count; i++)
+            {
+                (void)inflateEnd(inflate_list.strms[i]);
+                delete inflate_list.strms[i];
+            }
+        }
+    };
+
+    ZStreamPool &zstream_pool()
+    {
+        static thread_local ZStreamPool pool;
+        return pool;
+    }
+
+    // 取出一个指定级别的压缩流，池为空时新建
+    z_stream *acquire_deflate(CompressLevel level)
+    {
+        size_t idx = static_cast<size_t>(level);
+        if (idx >= LEVEL_COUNT)
+            idx = static_cast<size_t>(CompressLevel::DEFAULT);
+
+        ZStreamList &list = zstream_pool().deflate_list[idx];
+        while (list.count > 0)
+        {
+            z_stream *strm = list.strms[--list.count];
+            if (deflateReset(strm) == Z_OK)
+                return strm;
+            (void)deflateEnd(strm);
+            delete strm;
+        }
+
+        z_stream *strm = new z_stream();
+        if (deflateInit2(strm,  // 初始化压缩流
+                         GZIP_LEVELS[idx],  // 压缩级别
                          Z_DEFLATED,  // 使用DEFLATE算法
                          MAX_WBITS + 16,  // 窗口大小（支持GZIP格式）
                          8,  // 内存级别
                          Z_DEFAULT_STRATEGY) != Z_OK)  // 默认压缩策略
         {
-            // fprintf(stderr, "deflateInit2 error!\n");
-            return StatusCompressError;  // 初始化失败，返回错误码
+            delete strm;
+            return nullptr;
+        }
+        return strm;
+    }
+
+    // 压缩流放回当前线程的池，池满时释放
+    void release_deflate(z_stream *strm, CompressLevel level)
+    {
+        size_t idx = static_cast<size_t>(level);
+        if (idx >= LEVEL_COUNT)
+            idx = static_cast<size_t>(CompressLevel::DEFAULT);
+
+        ZStreamList &list = zstream_pool().deflate_list[idx];
+        if (list.count < ZSTREAM_POOL_SIZE)
+        {
+            list.strms[list.count++] = strm;
+            return;
         }
-        std::string outstr;  // 创建输出字符串
-        outstr.resize(compressBound(static_cast<uLong>(len)));  // 根据输入长度预分配空间
-        strm.next_in = (Bytef *)data;  // 设置输入数据指针
-        strm.avail_in = static_cast<uInt>(len);  // 设置输入数据长度
-        int ret;
-        do
+        (void)deflateEnd(strm);
+        delete strm;
+    }
+
+    // 取出一个解压流（自动识别 gzip 和 zlib 格式），池为空时新建
+    z_stream *acquire_inflate()
+    {
+        ZStreamList &list = zstream_pool().inflate_list;
+        while (list.count > 0)
         {
-            if (strm.total_out >= outstr.size())  // 如果输出空间不足
-            {
-                outstr.resize(strm.total_out * 2);  // 扩大输出空间
-            }
-            assert(outstr.size() >= strm.total_out);  // 断言输出空间足够
-            strm.avail_out = static_cast<uInt>(outstr.size() - strm.total_out);  // 更新剩余输出空间
-            strm.next_out = (Bytef *)outstr.data() + strm.total_out;  // 更新输出数据指针
-            ret = deflate(&strm, Z_FINISH); /* no bad return value */  // 执行压缩操作
-            if (ret == Z_STREAM_ERROR)  // 如果发生错误
-            {
-                (void)deflateEnd(&strm);  // 清理压缩流
-                return StatusCompressError;  // 返回错误码
-            }
-        } while (strm.avail_out == 0);  // 如果输出空间用完，继续循环
-        assert(strm.avail_in == 0);  // 断言输入数据已处理完
-        assert(ret == Z_STREAM_END); /* stream will be complete */  // 断言压缩完成
-        outstr.resize(strm.total_out);  // 调整输出字符串大小
-        /* clean up and return */
-        (void)deflateEnd(&strm);  // 清理压缩流
-        *dest = std::move(outstr);  // 将压缩结果移动到目标字符串
-        return StatusOK;  // 返回成功码
-    }
-    return StatusCompressError;  // 输入数据无效，返回错误码
+            z_stream *strm = list.strms[--list.count];
+            if (inflateReset(strm) == Z_OK)
+                return strm;
+            (void)inflateEnd(strm);
+            delete strm;
+        }
+
+        // 15是窗口大小的对数，32表示自动识别GZIP和ZLIB格式
+        z_stream *strm = new z_stream();
+        if (inflateInit2(strm, (15 + 32)) != Z_OK)
+        {
+            delete strm;
+            return nullptr;
+        }
+        return strm;
+    }
+
+    // 解压流放回当前线程的池，池满时释放
+    void release_inflate(z_stream *strm)
+    {
+        ZStreamList &list = zstream_pool().inflate_list;
+        if (list.count < ZSTREAM_POOL_SIZE)
+        {
+            list.strms[list.count++] = strm;
+            return;
+        }
+        (void)inflateEnd(strm);
+        delete strm;
+    }
+}  // namespace
+
+namespace
+{
+    // 解压输出缓冲区的大小：按需求取值，有上限时不超过上限加一个字节，多出的一个字节用来判断是否超限
+    size_t bounded_size(size_t size, size_t max_size)
+    {
+        if (max_size > 0 && size > max_size + 1)
+            return max_size + 1;
+        return size;
+    }
+}  // namespace
+
+// 从当前线程的池中取出压缩流，池为空（同一线程上有多个压缩流正在使用）时新建一个
+GzipStream::GzipStream(CompressLevel level)
+    : strm_(acquire_deflate(level)), level_(level), finished_(false)
+{
+}
+
+// 压缩流放回当前线程的池
+GzipStream::~GzipStream()
+{
+    if (strm_)
+        release_deflate(strm_, level_);
+}
+
+int GzipStream::update(const char *data, size_t len, bool finish, const ChunkFunc &func)
+{
+    if (!strm_ || finished_)
+        return StatusCompressError;
+
+    char *out = zstream_pool().out;
+    int flush = finish ? Z_FINISH : Z_NO_FLUSH;
+    strm_->next_in = (Bytef *)data;  // 设置输入数据指针
+    strm_->avail_in = static_cast<uInt>(len);  // 设置输入数据长度
+
+    int ret;
+    do
+    {
+        strm_->next_out = (Bytef *)out;
+        strm_->avail_out = static_cast<uInt>(CHUNK_SIZE);
+        ret = deflate(strm_, flush);  // 执行压缩操作
+        if (ret == Z_STREAM_ERROR)  // 如果发生错误
+            return StatusCompressError;
+
+        size_t have = CHUNK_SIZE - strm_->avail_out;
+        if (have > 0)
+            func(out, have);
+    } while (strm_->avail_out == 0);  // 输出缓冲区写满说明可能还有输出，继续循环
+
+    if (finish)
+    {
+        assert(ret == Z_STREAM_END);  // 断言压缩完成
+        finished_ = true;
+    }
+    return StatusOK;
 }
 
 // GZIP解压缩函数的实现
@@ -99,7 +287,8 @@ int Compressor::ungzip(const std::string * const src, std::string *dest)
 }
 
 // GZIP解压函数的实现（重载版本）
-int Compressor::ungzip(const char *data, const size_t len, std::string *dest)
+// 输出缓冲区按需倍增，解压结果超过 max_size 时立即停止，缓冲区最多分配 max_size + 1 字节
+int Compressor::ungzip(const char *data, const size_t len, std::string *dest, size_t max_size)
 {
     // 清空目标字符串，确保不会包含旧数据
     dest->clear();
@@ -113,78 +302,69 @@ int Compressor::ungzip(const char *data, const size_t len, std::string *dest)
 
     // 预分配解压缩后的数据空间，初始大小为输入数据长度的两倍
     // 这是为了确保有足够的空间来存储解压缩后的数据
-    auto decompressed = std::string(full_length * 2, 0);
+    auto decompressed = std::string(bounded_size(full_length * 2, max_size), 0);
 
-    // 标记解压缩是否完成
+    // 标记解压缩是否完成，以及是否超过了解压大小的上限
     bool done = false;
+    bool too_large = false;
 
-    // 初始化z_stream结构体，用于解压缩操作
-    z_stream strm = {nullptr,
-                     0,
-                     0,
-                     nullptr,
-                     0,
-                     0,
-                     nullptr,
-                     nullptr,
-                     nullptr,
-                     nullptr,
-                     nullptr,
-                     0,
-                     0,
-                     0};
-    strm.next_in = (Bytef *)data;  // 设置输入数据指针
-    strm.avail_in = static_cast<uInt>(len);  // 设置输入数据长度
-    strm.total_out = 0;  // 初始化输出数据长度
-    strm.zalloc = Z_NULL;  // 设置内存分配函数为默认
-    strm.zfree = Z_NULL;  // 设置内存释放函数为默认
-
-    // 初始化解压缩流，支持GZIP格式（15 + 32）
-    // 15是窗口大小的对数，32表示支持GZIP格式
-    if (inflateInit2(&strm, (15 + 32)) != Z_OK)
-    {
-        // fprintf(stderr, "inflateInit2 error!\n");
+    // 从当前线程的池中取出解压流，已经初始化过的流只需要复位
+    z_stream *strm = acquire_inflate();
+    if (!strm)
+    {
         // 初始化失败，返回解压缩错误码
         return StatusUncompressError;
     }
+    strm->next_in = (Bytef *)data;  // 设置输入数据指针
+    strm->avail_in = static_cast<uInt>(len);  // 设置输入数据长度
 
     // 循环直到解压缩完成
     while (!done)
     {
         // 检查输出缓冲区是否足够，如果不足则扩大缓冲区
-        if (strm.total_out >= decompressed.length())
+        if (strm->total_out >= decompressed.length())
         {
+            // 已经写满上限加一个字节的缓冲区，说明超过了上限
+            if (max_size > 0 && strm->total_out > max_size)
+            {
+                too_large = true;
+                break;
+            }
             // 扩大缓冲区大小为当前大小的两倍
-            decompressed.resize(decompressed.length() * 2);
+            decompressed.resize(bounded_size(decompressed.length() * 2, max_size));
         }
         // 更新输出数据指针
-        strm.next_out = (Bytef *)decompressed.data() + strm.total_out;
+        strm->next_out = (Bytef *)decompressed.data() + strm->total_out;
         // 更新剩余输出空间
-        strm.avail_out = static_cast<uInt>(decompressed.length() - strm.total_out);
+        strm->avail_out = static_cast<uInt>(decompressed.length() - strm->total_out);
 
         // 执行解压缩操作
-        int status = inflate(&strm, Z_SYNC_FLUSH);
+        int status = inflate(strm, Z_SYNC_FLUSH);
         if (status == Z_STREAM_END)  // 如果解压缩完成
         {
             done = true;  // 设置完成标志
+            too_large = max_size > 0 && strm->total_out > max_size;
         }
         else if (status != Z_OK)  // 如果发生错误
         {
             break;  // 退出循环
         }
     }
+    size_t total_out = strm->total_out;
 
-    // 清理解压缩流
-    if (inflateEnd(&strm) != Z_OK)
-        // 清理失败，返回解压缩错误码
-        return StatusUncompressError;
+    // 解压流放回池中，下次使用前复位
+    release_inflate(strm);
 
     // 设置解压缩后的数据长度
     int status = StatusOK;  // 初始化状态为成功
-    if (done)  // 如果解压缩完成
+    if (too_large)  // 解压结果超过上限，丢弃已经解压的数据
+    {
+        status = StatusUncompressTooLarge;
+    }
+    else if (done)  // 如果解压缩完成
     {
         // 调整解压缩数据的大小为实际输出长度
-        decompressed.resize(strm.total_out);
+        decompressed.resize(total_out);
         // 将解压缩数据移动到目标字符串
         *dest = std::move(decompressed);
     }
@@ -198,3 +378,246 @@ int Compressor::ungzip(const char *data, const size_t len, std::string *dest)
     return status;
 }
 
+#ifdef YUKINO_WITH_BROTLI
+namespace
+{
+    // 压缩级别对应的 brotli 质量，下标为 CompressLevel 的取值
+    // 默认取 5：动态响应在线压缩，压缩率接近 gzip -9，速度与 gzip -6 相当
+    const int BROTLI_QUALITIES[] = { 5, 1, 5, BROTLI_MAX_QUALITY };
+}  // namespace
+#endif
+
+#ifdef YUKINO_WITH_ZSTD
+namespace
+{
+    // 压缩级别对应的 zstd 级别，下标为 CompressLevel 的取值
+    // 默认取 3，压缩率和速度都明显好于 gzip -6
+    const int ZSTD_LEVELS[] = { 3, 1, 3, 19 };
+}  // namespace
+#endif
+
+// Brotli压缩函数的实现，一次压缩完，输出缓冲区按最坏情况预分配
+int Compressor::brotli(const char *data, const size_t len, std::string *dest, CompressLevel level)
+{
+    dest->clear();
+#ifdef YUKINO_WITH_BROTLI
+    if (!data || len == 0)
+        return StatusCompressError;
+
+    size_t out_len = BrotliEncoderMaxCompressedSize(len);
+    if (out_len == 0)
+        return StatusCompressError;
+
+    dest->resize(out_len);
+    if (!BrotliEncoderCompress(BROTLI_QUALITIES[static_cast<int>(level)], BROTLI_DEFAULT_WINDOW, BROTLI_MODE_GENERIC,
+                               len, reinterpret_cast<const uint8_t *>(data),
+                               &out_len, reinterpret_cast<uint8_t *>(&(*dest)[0])))
+    {
+        dest->clear();
+        return StatusCompressError;
+    }
+    dest->resize(out_len);
+    return StatusOK;
+#else
+    (void)data;
+    (void)len;
+    (void)level;
+    return StatusCompressNotSupport;
+#endif
+}
+
+// Brotli解压缩函数的实现，解压后的大小事先未知，输出缓冲区按需倍增，超过 max_size 时立即停止
+int Compressor::unbrotli(const char *data, const size_t len, std::string *dest, size_t max_size)
+{
+    dest->clear();
+#ifdef YUKINO_WITH_BROTLI
+    if (len == 0)
+        return StatusOK;
+
+    BrotliDecoderState *state = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+    if (!state)
+        return StatusUncompressError;
+
+    std::string out(bounded_size(len * 4, max_size), '\0');
+    size_t avail_in = len;
+    const uint8_t *next_in = reinterpret_cast<const uint8_t *>(data);
+    size_t total_out = 0;
+    BrotliDecoderResult result;
+    do
+    {
+        if (total_out == out.size())
+        {
+            if (max_size > 0 && total_out > max_size)
+                break;
+            out.resize(bounded_size(out.size() * 2, max_size));
+        }
+
+        size_t avail_out = out.size() - total_out;
+        uint8_t *next_out = reinterpret_cast<uint8_t *>(&out[total_out]);
+        result = BrotliDecoderDecompressStream(state, &avail_in, &next_in, &avail_out, &next_out, nullptr);
+        total_out = out.size() - avail_out;
+    } while (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT);
+    BrotliDecoderDestroyInstance(state);
+
+    if (max_size > 0 && total_out > max_size)
+        return StatusUncompressTooLarge;
+    if (result != BROTLI_DECODER_RESULT_SUCCESS)
+        return StatusUncompressError;
+
+    out.resize(total_out);
+    *dest = std::move(out);
+    return StatusOK;
+#else
+    (void)data;
+    (void)len;
+    (void)max_size;
+    return StatusUncompressNotSupport;
+#endif
+}
+
+// Zstandard压缩函数的实现，一次压缩完，输出缓冲区按最坏情况预分配
+int Compressor::zstd(const char *data, const size_t len, std::string *dest, CompressLevel level)
+{
+    dest->clear();
+#ifdef YUKINO_WITH_ZSTD
+    if (!data || len == 0)
+        return StatusCompressError;
+
+    dest->resize(ZSTD_compressBound(len));
+    size_t ret = ZSTD_compress(&(*dest)[0], dest->size(), data, len, ZSTD_LEVELS[static_cast<int>(level)]);
+    if (ZSTD_isError(ret))
+    {
+        dest->clear();
+        return StatusCompressError;
+    }
+    dest->resize(ret);
+    return StatusOK;
+#else
+    (void)data;
+    (void)len;
+    (void)level;
+    return StatusCompressNotSupport;
+#endif
+}
+
+// Zstandard解压缩函数的实现，帧头中带有原始大小时一次解压，否则流式解压，超过 max_size 时立即停止
+int Compressor::unzstd(const char *data, const size_t len, std::string *dest, size_t max_size)
+{
+    dest->clear();
+#ifdef YUKINO_WITH_ZSTD
+    if (len == 0)
+        return StatusOK;
+
+    unsigned long long size = ZSTD_getFrameContentSize(data, len);
+    if (size == ZSTD_CONTENTSIZE_ERROR)
+        return StatusUncompressError;
+
+    // 帧头声明的原始大小由发送方给出，超过上限时不分配缓冲区
+    if (size != ZSTD_CONTENTSIZE_UNKNOWN && max_size > 0 && size > max_size)
+        return StatusUncompressTooLarge;
+
+    if (size != ZSTD_CONTENTSIZE_UNKNOWN)
+    {
+        std::string out(size, '\0');
+        size_t ret = ZSTD_decompress(&out[0], out.size(), data, len);
+        if (ZSTD_isError(ret) || ret != size)
+            return StatusUncompressError;
+        *dest = std::move(out);
+        return StatusOK;
+    }
+
+    ZSTD_DStream *stream = ZSTD_createDStream();
+    if (!stream)
+        return StatusUncompressError;
+
+    std::string out(bounded_size(len * 4, max_size), '\0');
+    ZSTD_inBuffer in = { data, len, 0 };
+    size_t total_out = 0;
+    size_t ret;
+    do
+    {
+        if (total_out == out.size())
+        {
+            if (max_size > 0 && total_out > max_size)
+                break;
+            out.resize(bounded_size(out.size() * 2, max_size));
+        }
+
+        ZSTD_outBuffer output = { &out[0], out.size(), total_out };
+        ret = ZSTD_decompressStream(stream, &output, &in);
+        total_out = output.pos;
+    } while (!ZSTD_isError(ret) && ret != 0 && (in.pos < in.size || total_out == out.size()));
+    ZSTD_freeDStream(stream);
+
+    if (max_size > 0 && total_out > max_size)
+        return StatusUncompressTooLarge;
+
+    // 返回 0 表示一帧已经完整解码
+    if (ZSTD_isError(ret) || ret != 0)
+        return StatusUncompressError;
+
+    out.resize(total_out);
+    *dest = std::move(out);
+    return StatusOK;
+#else
+    (void)data;
+    (void)len;
+    (void)max_size;
+    return StatusUncompressNotSupport;
+#endif
+}
+
+int Compressor::compress(Compress method, const char *data, const size_t len, std::string *dest,
+                         CompressLevel level)
+{
+    switch (method)
+    {
+    case Compress::GZIP:
+        return gzip(data, len, dest, level);
+    case Compress::BROTLI:
+        return brotli(data, len, dest, level);
+    case Compress::ZSTD:
+        return zstd(data, len, dest, level);
+    default:
+        return StatusCompressNotSupport;
+    }
+}
+
+int Compressor::uncompress(Compress method, const char *data, const size_t len, std::string *dest,
+                           size_t max_size)
+{
+    switch (method)
+    {
+    case Compress::GZIP:
+        return ungzip(data, len, dest, max_size);
+    case Compress::BROTLI:
+        return unbrotli(data, len, dest, max_size);
+    case Compress::ZSTD:
+        return unzstd(data, len, dest, max_size);
+    default:
+        return StatusUncompressNotSupport;
+    }
+}
+
+bool Compressor::supported(Compress method)
+{
+    switch (method)
+    {
+    case Compress::GZIP:
+        return true;
+    case Compress::BROTLI:
+#ifdef YUKINO_WITH_BROTLI
+        return true;
+#else
+        return false;
+#endif
+    case Compress::ZSTD:
+#ifdef YUKINO_WITH_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
@@ -5,20 +5,40 @@
 #define YUKINO_COMPRESS_H_
 
 #include <string>  // 包含标准库中的string头文件，用于处理字符串
+#include <functional>  // 包含std::function，用于输出压缩块的回调
 #include <zlib.h>  // 包含zlib库的头文件，用于压缩和解压缩功能
 
+#include "Noncopyable.h"
+#include "StringPiece.h"
+
 namespace Yukino  // 定义一个命名空间Yukino，用于封装相关的类和函数
 {  // 命名空间的开始
 
 // 定义一个枚举类，用于表示支持的压缩方法
+// BROTLI 和 ZSTD 需要在编译时开启 YUKINO_WITH_BROTLI、YUKINO_WITH_ZSTD，未开启时相应的函数返回不支持
 enum class Compress 
 {
-    GZIP  // 表示GZIP压缩方法
+    GZIP,  // 表示GZIP压缩方法
+    BROTLI,  // 表示Brotli压缩方法（Content-Encoding: br）
+    ZSTD  // 表示Zstandard压缩方法（Content-Encoding: zstd）
+};
+
+// 压缩级别，各压缩方法映射到自己的级别：
+// gzip 为 1/6/9，brotli 为 1/5/11，zstd 为 1/3/19（依次对应 FASTEST、DEFAULT、BEST）
+enum class CompressLevel
+{
+    AUTO,  // 由调用者的策略决定，直接压缩时等同于 DEFAULT
+    FASTEST,  // 速度优先，用于对延迟敏感的接口
+    DEFAULT,  // 各压缩方法的默认级别
+    BEST  // 压缩率优先，用于压缩一次、多次发送的可缓存资源
 };
 
 // 声明一个函数，用于将压缩方法枚举值转换为对应的字符串描述
 const char* compress_method_to_str(const Compress& compress_method);
 
+// 根据 Content-Encoding 的取值（忽略大小写）得到压缩方法，x-gzip 视为 gzip，无法识别时返回 false
+bool compress_method_from_str(const StringPiece &str, Compress *compress_method);
+
 // 定义一个Compressor类，封装压缩和解压缩功能
 class Compressor
 {
@@ -36,7 +56,9 @@ public:
     // - len：字节数组的长度
     // - dest：指向存储压缩结果的字符串的指针
     // 返回值：压缩操作的结果代码（成功或失败）
-    static int gzip(const char *data, const size_t len, std::string *dest);
+    // - level：压缩级别
+    static int gzip(const char *data, const size_t len, std::string *dest,
+                    CompressLevel level = CompressLevel::DEFAULT);
 
     // 静态成员函数，使用GZIP方法对字符串进行解压缩
     // 参数：
@@ -50,8 +72,61 @@ public:
     // - data：指向要解压缩的字节数组的指针
     // - len：字节数组的长度
     // - dest：指向存储解压缩结果的字符串的指针
+    // - max_size：解压结果的大小上限，0 表示不限制，超过时立即停止并返回 StatusUncompressTooLarge
     // 返回值：解压缩操作的结果代码（成功或失败）
-    static int ungzip(const char *data, const size_t len, std::string *dest);
+    static int ungzip(const char *data, const size_t len, std::string *dest, size_t max_size = 0);
+
+    // 使用Brotli方法对字节数组进行压缩/解压缩，参数和返回值同上
+    static int brotli(const char *data, const size_t len, std::string *dest,
+                      CompressLevel level = CompressLevel::DEFAULT);
+
+    static int unbrotli(const char *data, const size_t len, std::string *dest, size_t max_size = 0);
+
+    // 使用Zstandard方法对字节数组进行压缩/解压缩，参数和返回值同上
+    static int zstd(const char *data, const size_t len, std::string *dest,
+                    CompressLevel level = CompressLevel::DEFAULT);
+
+    static int unzstd(const char *data, const size_t len, std::string *dest, size_t max_size = 0);
+
+    // 按指定的压缩方法压缩/解压缩，方法没有编译进来时返回 StatusCompressNotSupport/StatusUncompressNotSupport
+    static int compress(Compress method, const char *data, const size_t len, std::string *dest,
+                        CompressLevel level = CompressLevel::DEFAULT);
+
+    static int uncompress(Compress method, const char *data, const size_t len, std::string *dest,
+                          size_t max_size = 0);
+
+    // 压缩方法是否编译进来
+    static bool supported(Compress method);
+};
+
+// 流式 GZIP 压缩，输入可以分多次给出，压缩结果按固定大小的块输出
+// 每个线程按压缩级别保留一组初始化好的 z_stream，新的压缩流用 deflateReset 复用它们，而不是每次都 deflateInit2/deflateEnd
+class GzipStream : public Noncopyable
+{
+public:
+    // 输出回调，data 指向线程内的临时缓冲区，只在回调期间有效
+    using ChunkFunc = std::function<void(const char *data, size_t len)>;
+
+    // 每个输出块的最大字节数
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+    explicit GzipStream(CompressLevel level = CompressLevel::DEFAULT);
+
+    ~GzipStream();
+
+    // 压缩一段输入，每产生一块输出调用一次 func
+    // 参数：
+    // - data：输入数据
+    // - len：输入数据的长度
+    // - finish：是否为最后一段输入，为 true 时输出 GZIP 尾部并结束压缩流
+    // - func：输出回调
+    // 返回值：压缩操作的结果代码（成功或失败）
+    int update(const char *data, size_t len, bool finish, const ChunkFunc &func);
+
+private:
+    z_stream *strm_;  // 从线程池中取得的压缩流，初始化失败时为空
+    CompressLevel level_;  // 压缩级别，析构时放回对应的池
+    bool finished_;   // 压缩流是否已经结束
 };
 
 }  // namespace Yukino  // 命名空间的结束
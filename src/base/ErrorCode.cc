@@ -15,6 +15,7 @@ std::map<int, const char *> error_code_table = {
     { StatusUncompressError, "Uncompress Error" },  // 解压缩过程中发生错误
     { StatusUncompressNotSupport, "Uncompress Not Support" },  // 不支持的解压缩格式或方法
     { StatusNoUncomrpess, "No Uncomrpess" },  // 未启用解压缩功能
+    { StatusUncompressTooLarge, "Uncompressed Body Too Large" },  // 解压后的数据超过上限
     { StatusNotFound, "404 Not Found" },  // 未找到指定的资源或对象
     { StatusFileRangeInvalid, "File Range Invalid" },  // 文件范围无效
     { StatusFileReadError, "File Read Error" },  // 文件读取失败
@@ -23,6 +24,7 @@ std::map<int, const char *> error_code_table = {
     { StatusProxyError, "Http Proxy Error" },  // 代理操作失败
     { StatusRouteVerbNotImplment, "Route Http Method not implement" },  // 路由的HTTP方法未实现
     { StatusRouteNotFound, "Route Not Found" },  // 未找到指定的路由
+    { StatusMySQLParamMismatch, "MySQL Statement Parameter Count Mismatch" },  // 参数个数与占位符个数不一致
 };
 
 // 实现将错误码转换为字符串描述的函数
@@ -17,6 +17,7 @@ enum ErrorCode
     StatusUncompressError,  // 解压缩过程中发生错误
     StatusUncompressNotSupport,  // 不支持的解压缩格式或方法
     StatusNoUncomrpess,  // 未启用解压缩功能（拼写错误，应为StatusNoUncompress）
+    StatusUncompressTooLarge,  // 解压后的数据超过大小或压缩比上限
 
     // 文件操作相关的错误码
     StatusFileRangeInvalid,  // 文件范围无效（例如，读取超出文件大小的范围）
@@ -32,6 +33,9 @@ enum ErrorCode
     // 路由相关的错误码
     StatusRouteVerbNotImplment,  // 路由的HTTP方法未实现（拼写错误，应为StatusRouteVerbNotImplemented）
     StatusRouteNotFound,  // 未找到指定的路由
+
+    // MySQL 相关的错误码
+    StatusMySQLParamMismatch,  // MySQLStatement 的参数个数与占位符个数不一致
 };
 
 // 声明一个函数，用于将错误码转换为对应的字符串描述
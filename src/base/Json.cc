@@ -1,8 +1,393 @@
 #include "Json.h"
 
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "JsonScan.h"
+
 namespace Yukino
 {
 
+namespace
+{
+
+using namespace json_scan;
+
+// 整数写到 buf 的末尾，返回第一个字符的位置
+char* format_integer(long long number, char* end)
+{
+    unsigned long long value = number < 0 ? 0ULL - static_cast<unsigned long long>(number)
+                                          : static_cast<unsigned long long>(number);
+    char* p = end;
+    do
+    {
+        *--p = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    if (number < 0)
+        *--p = '-';
+    return p;
+}
+
+
+// 嵌套深度上限，与 workflow 的 json_parser 相同
+constexpr int JSON_PARSE_DEPTH_LIMIT = 1024;
+
+/**
+ * @brief 快速 JSON 解析器，直接构建 workflow 的 json_value_t 树
+ *
+ * 空白和字符串按块扫描（见 skip_whitespace、find_escape），没有转义的字符串整段拷贝，
+ * 不超过 15 位的整数不经过 strtod。只处理常见的合法输入，遇到语法错误、\u0000、
+ * 不成对的代理项或超过深度上限时返回 nullptr，由调用者交给 json_value_parse 处理，
+ * 因此错误和边界情况的行为与原来的解析器完全一致。
+ * 输入必须以 '\0' 结尾（数字交给 strtod 时依赖它结束）。
+ */
+class FastJsonParser
+{
+public:
+    FastJsonParser(const char* begin, const char* end) : p_(begin), end_(end)
+    {}
+
+    json_value_t* parse()
+    {
+        json_value_t* root = nullptr;
+        Slot slot = { nullptr, nullptr, nullptr, &root };
+        p_ = skip_whitespace(p_, end_);
+        if (!parse_value(slot, 0) || skip_whitespace(p_, end_) != end_)
+        {
+            if (root)
+                json_value_destroy(root);
+            return nullptr;
+        }
+        return root;
+    }
+
+private:
+    // 解析出的值的去处：对象成员、数组元素或根节点
+    struct Slot
+    {
+        json_object_t* obj;
+        json_array_t* arr;
+        const char* key;
+        json_value_t** root;
+    };
+
+    static json_value_t* append(const Slot& slot, int type)
+    {
+        const json_value_t* val;
+        if (slot.obj)
+            val = json_object_append(slot.obj, slot.key, type);
+        else if (slot.arr)
+            val = json_array_append(slot.arr, type);
+        else
+            val = *slot.root = json_value_create(type);
+        return const_cast<json_value_t*>(val);
+    }
+
+    static bool append_string(const Slot& slot, const char* str)
+    {
+        if (slot.obj)
+            return json_object_append(slot.obj, slot.key, JSON_VALUE_STRING, str) != nullptr;
+        if (slot.arr)
+            return json_array_append(slot.arr, JSON_VALUE_STRING, str) != nullptr;
+        *slot.root = json_value_create(JSON_VALUE_STRING, str);
+        return *slot.root != nullptr;
+    }
+
+    static bool append_number(const Slot& slot, double number)
+    {
+        if (slot.obj)
+            return json_object_append(slot.obj, slot.key, JSON_VALUE_NUMBER, number) != nullptr;
+        if (slot.arr)
+            return json_array_append(slot.arr, JSON_VALUE_NUMBER, number) != nullptr;
+        *slot.root = json_value_create(JSON_VALUE_NUMBER, number);
+        return *slot.root != nullptr;
+    }
+
+    bool parse_value(const Slot& slot, int depth)
+    {
+        if (p_ == end_)
+            return false;
+
+        switch (*p_)
+        {
+            case '{':
+                return parse_object(slot, depth + 1);
+            case '[':
+                return parse_array(slot, depth + 1);
+            case '"':
+                return parse_string(&str_) && append_string(slot, str_.c_str());
+            case 't':
+                return parse_literal("true", 4) && append(slot, JSON_VALUE_TRUE) != nullptr;
+            case 'f':
+                return parse_literal("false", 5) && append(slot, JSON_VALUE_FALSE) != nullptr;
+            case 'n':
+                return parse_literal("null", 4) && append(slot, JSON_VALUE_NULL) != nullptr;
+            default:
+                return parse_number(slot);
+        }
+    }
+
+    bool parse_object(const Slot& slot, int depth)
+    {
+        if (depth > JSON_PARSE_DEPTH_LIMIT)
+            return false;
+
+        json_value_t* val = append(slot, JSON_VALUE_OBJECT);
+        if (!val)
+            return false;
+
+        Slot member = { json_value_object(val), nullptr, nullptr, nullptr };
+        p_ = skip_whitespace(p_ + 1, end_);
+        if (p_ < end_ && *p_ == '}')
+        {
+            p_++;
+            return true;
+        }
+
+        while (true)
+        {
+            if (p_ == end_ || *p_ != '"' || !parse_string(&key_))
+                return false;
+            p_ = skip_whitespace(p_, end_);
+            if (p_ == end_ || *p_ != ':')
+                return false;
+            p_ = skip_whitespace(p_ + 1, end_);
+
+            // 成员名在追加值时就已经拷贝，嵌套解析可以复用 key_
+            member.key = key_.c_str();
+            if (!parse_value(member, depth))
+                return false;
+
+            p_ = skip_whitespace(p_, end_);
+            if (p_ == end_)
+                return false;
+            if (*p_ == '}')
+            {
+                p_++;
+                return true;
+            }
+            if (*p_ != ',')
+                return false;
+            p_ = skip_whitespace(p_ + 1, end_);
+        }
+    }
+
+    bool parse_array(const Slot& slot, int depth)
+    {
+        if (depth > JSON_PARSE_DEPTH_LIMIT)
+            return false;
+
+        json_value_t* val = append(slot, JSON_VALUE_ARRAY);
+        if (!val)
+            return false;
+
+        Slot element = { nullptr, json_value_array(val), nullptr, nullptr };
+        p_ = skip_whitespace(p_ + 1, end_);
+        if (p_ < end_ && *p_ == ']')
+        {
+            p_++;
+            return true;
+        }
+
+        while (true)
+        {
+            if (!parse_value(element, depth))
+                return false;
+
+            p_ = skip_whitespace(p_, end_);
+            if (p_ == end_)
+                return false;
+            if (*p_ == ']')
+            {
+                p_++;
+                return true;
+            }
+            if (*p_ != ',')
+                return false;
+            p_ = skip_whitespace(p_ + 1, end_);
+        }
+    }
+
+    // 解析字符串并还原转义，p_ 指向开头的双引号
+    bool parse_string(std::string* out)
+    {
+        out->clear();
+        p_++;
+        while (true)
+        {
+            const char* q = find_escape(p_, end_);
+            out->append(p_, q - p_);
+            if (q == end_ || static_cast<unsigned char>(*q) < 0x20)
+                return false;
+            if (*q == '"')
+            {
+                p_ = q + 1;
+                return true;
+            }
+
+            // 反斜杠转义
+            p_ = q + 1;
+            if (p_ == end_)
+                return false;
+            switch (*p_++)
+            {
+                case '"':
+                    out->push_back('"');
+                    break;
+                case '\\':
+                    out->push_back('\\');
+                    break;
+                case '/':
+                    out->push_back('/');
+                    break;
+                case 'b':
+                    out->push_back('\b');
+                    break;
+                case 'f':
+                    out->push_back('\f');
+                    break;
+                case 'n':
+                    out->push_back('\n');
+                    break;
+                case 'r':
+                    out->push_back('\r');
+                    break;
+                case 't':
+                    out->push_back('\t');
+                    break;
+                case 'u':
+                    if (!parse_unicode(out))
+                        return false;
+                    break;
+                default:
+                    return false;
+            }
+        }
+    }
+
+    // 解析 \uXXXX（p_ 指向 XXXX），代理项必须成对出现，结果按 UTF-8 写入
+    bool parse_unicode(std::string* out)
+    {
+        unsigned int code;
+        if (!parse_hex4(&code))
+            return false;
+        if (code >= 0xDC00 && code <= 0xDFFF)
+            return false;
+        if (code >= 0xD800 && code <= 0xDBFF)
+        {
+            unsigned int low;
+            if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u')
+                return false;
+            p_ += 2;
+            if (!parse_hex4(&low) || low < 0xDC00 || low > 0xDFFF)
+                return false;
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        // C 字符串无法保存 '\0'
+        if (code == 0)
+            return false;
+
+        append_utf8(code, out);
+        return true;
+    }
+
+    bool parse_hex4(unsigned int* code)
+    {
+        if (!read_hex4(p_, end_, code))
+            return false;
+        p_ += 4;
+        return true;
+    }
+
+    bool parse_literal(const char* literal, size_t len)
+    {
+        if (static_cast<size_t>(end_ - p_) < len || memcmp(p_, literal, len) != 0)
+            return false;
+        p_ += len;
+        return true;
+    }
+
+    // 按 JSON 语法检查数字，不超过 15 位的整数直接累加，其余交给 strtod
+    bool parse_number(const Slot& slot)
+    {
+        const char* start = p_;
+        const char* p = p_;
+        bool negative = false;
+        if (*p == '-')
+        {
+            negative = true;
+            p++;
+        }
+        if (p == end_ || *p < '0' || *p > '9')
+            return false;
+
+        unsigned long long mantissa = 0;
+        int digits = 0;
+        if (*p == '0')
+        {
+            p++;
+        }
+        else
+        {
+            while (p < end_ && *p >= '0' && *p <= '9')
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits++;
+                p++;
+            }
+        }
+
+        bool integer = true;
+        if (p < end_ && *p == '.')
+        {
+            integer = false;
+            p++;
+            if (p == end_ || *p < '0' || *p > '9')
+                return false;
+            while (p < end_ && *p >= '0' && *p <= '9')
+                p++;
+        }
+        if (p < end_ && (*p == 'e' || *p == 'E'))
+        {
+            integer = false;
+            p++;
+            if (p < end_ && (*p == '+' || *p == '-'))
+                p++;
+            if (p == end_ || *p < '0' || *p > '9')
+                return false;
+            while (p < end_ && *p >= '0' && *p <= '9')
+                p++;
+        }
+
+        double number;
+        if (integer && digits <= 15)
+        {
+            number = static_cast<double>(mantissa);
+            if (negative)
+                number = -number;
+        }
+        else
+        {
+            char* num_end;
+            number = strtod(start, &num_end);
+            if (num_end != p)
+                return false;
+        }
+        p_ = p;
+        return append_number(slot, number);
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+    std::string key_;  // 当前成员名
+    std::string str_;  // 当前字符串值
+};
+
+} // namespace
+
 // ------------------------ Constructor -------------------------
 Json::Json()
     : node_(json_value_create(JSON_VALUE_NULL)), parent_(nullptr),
@@ -47,9 +432,12 @@ Json::Json(const std::vector<std::string>& val)
 }
 
 // for parse
+// 先用快速解析器，它不处理的输入（包括所有非法输入）再交给 workflow 的解析器
 Json::Json(const std::string& str, bool parse_flag) : parent_(nullptr)
 {
-    node_ = json_value_parse(str.c_str());
+    node_ = FastJsonParser(str.c_str(), str.c_str() + str.size()).parse();
+    if (node_ == nullptr)
+        node_ = json_value_parse(str.c_str());
     allocated_ = node_ == nullptr ? false : true;
 }
 
@@ -181,6 +569,11 @@ std::string Json::dump(int spaces) const
     return str;
 }
 
+void Json::dump_to(std::string* out, int spaces) const
+{
+    value_convert(node_, spaces, 0, out);
+}
+
 Json Json::operator[](const char* key)
 {
     if (is_null() && is_root())
@@ -845,58 +1238,87 @@ void Json::value_convert(const json_value_t* val, int spaces, int depth,
 
 void Json::string_convert(const char* str, std::string* out_str)
 {
-    out_str->append("\"");
-    while (*str)
+    append_string(str, strlen(str), out_str);
+}
+
+void Json::append_string(const char* str, size_t len, std::string* out_str)
+{
+    static const char hex[] = "0123456789abcdef";
+    const char* end = str + len;
+    out_str->reserve(out_str->size() + len + 2);
+    out_str->push_back('"');
+    while (str < end)
     {
-        switch (*str)
+        const char* esc = find_escape(str, end);
+        out_str->append(str, esc - str);
+        if (esc == end)
+            break;
+
+        switch (*esc)
         {
             case '\r':
-                out_str->append("\\r");
+                out_str->append("\\r", 2);
                 break;
             case '\n':
-                out_str->append("\\n");
+                out_str->append("\\n", 2);
                 break;
             case '\f':
-                out_str->append("\\f");
+                out_str->append("\\f", 2);
                 break;
             case '\b':
-                out_str->append("\\b");
+                out_str->append("\\b", 2);
                 break;
             case '\"':
-                out_str->append("\\\"");
+                out_str->append("\\\"", 2);
                 break;
             case '\t':
-                out_str->append("\\t");
+                out_str->append("\\t", 2);
                 break;
             case '\\':
-                out_str->append("\\\\");
+                out_str->append("\\\\", 2);
                 break;
             default:
-                if ((unsigned char)*str < 0x20)
-                {
-                    char buf[8];
-                    snprintf(buf, 8, "\\u00%02x", *str);
-                    out_str->append(buf);
-                }
-                else
-                    out_str->push_back(*str);
+            {
+                char buf[6] = { '\\', 'u', '0', '0', hex[(*esc >> 4) & 0xf], hex[*esc & 0xf] };
+                out_str->append(buf, 6);
                 break;
+            }
         }
-        str++;
+        str = esc + 1;
     }
-    out_str->append("\"");
+    out_str->push_back('"');
 }
 
+// 整数值直接按整数输出；其他数值输出能精确还原的最短形式（依次尝试 15、16、17 位有效数字）
+// JSON 无法表示 NaN 和无穷大，输出 null
 void Json::number_convert(double number, std::string* out_str)
 {
-    std::ostringstream oss;
-    long long integer = number;
-    if (integer == number)
-        oss << integer;
-    else
-        oss << number;
+    char buf[32];
+    if (number >= -9223372036854775808.0 && number < 9223372036854775808.0)
+    {
+        long long integer = static_cast<long long>(number);
+        if (integer == number)
+        {
+            char* end = buf + sizeof buf;
+            char* begin = format_integer(integer, end);
+            out_str->append(begin, end - begin);
+            return;
+        }
+    }
+    if (!std::isfinite(number))
+    {
+        out_str->append("null", 4);
+        return;
+    }
 
-    out_str->append(oss.str());
+    int len = 0;
+    for (int precision = 15; precision <= 17; precision++)
+    {
+        len = snprintf(buf, sizeof buf, "%.*g", precision, number);
+        if (strtod(buf, nullptr) == number)
+            break;
+    }
+    out_str->append(buf, len);
 }
 
 void Json::array_convert_not_format(const json_array_t* arr,
@@ -927,8 +1349,6 @@ void Json::array_convert(const json_array_t* arr, int spaces, int depth,
     }
     const json_value_t* val;
     int n = 0;
-    int i;
-    std::string padding(spaces, ' ');
     out_str->append("[\n");
     json_array_for_each(val, arr)
     {
@@ -937,18 +1357,12 @@ void Json::array_convert(const json_array_t* arr, int spaces, int depth,
             out_str->append(",\n");
         }
         n++;
-        for (i = 0; i < depth + 1; i++)
-        {
-            out_str->append(padding);
-        }
+        out_str->append(static_cast<size_t>(spaces) * (depth + 1), ' ');
         value_convert(val, spaces, depth + 1, out_str);
     }
 
     out_str->append("\n");
-    for (i = 0; i < depth; i++)
-    {
-        out_str->append(padding);
-    }
+    out_str->append(static_cast<size_t>(spaces) * depth, ' ');
     out_str->append("]");
 }
 
@@ -984,8 +1398,6 @@ void Json::object_convert(const json_object_t* obj, int spaces, int depth,
     const char* name;
     const json_value_t* val;
     int n = 0;
-    int i;
-    std::string padding(spaces, ' ');
     out_str->append("{\n");
     json_object_for_each(name, val, obj)
     {
@@ -994,20 +1406,14 @@ void Json::object_convert(const json_object_t* obj, int spaces, int depth,
             out_str->append(",\n");
         }
         n++;
-        for (i = 0; i < depth + 1; i++)
-        {
-            out_str->append(padding);
-        }
+        out_str->append(static_cast<size_t>(spaces) * (depth + 1), ' ');
         string_convert(name, out_str);
         out_str->append(": ");
         value_convert(val, spaces, depth + 1, out_str);
     }
 
     out_str->append("\n");
-    for (i = 0; i < depth; i++)
-    {
-        out_str->append(padding);
-    }
+    out_str->append(static_cast<size_t>(spaces) * depth, ' ');
     out_str->append("}");
 }
 
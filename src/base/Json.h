@@ -87,6 +87,18 @@ public:
     // 将Json对象序列化为字符串，并指定缩进空格数
     std::string dump(int spaces) const;
 
+    // 将Json对象序列化后追加到 out 的末尾，不创建临时字符串，调用者可以预留或复用 out 的空间
+    void dump_to(std::string* out, int spaces = 0) const;
+
+    // 将字符串按 JSON 转义（带引号）追加到 out 的末尾，str 可以含有 '\0'，用于不构建 Json 对象的流式输出
+    static void append_string(const char* str, size_t len, std::string* out);
+
+    // 将数值按与 dump 相同的格式追加到 out 的末尾
+    static void append_number(double number, std::string* out)
+    {
+        number_convert(number, out);
+    }
+
     // 提供对JSON对象或数组的访问，返回对应的Json对象
     // 用于非const对象，允许修改
     Json operator[](const char* key);
@@ -0,0 +1,197 @@
+#ifndef YUKINO_JSONSCAN_H_
+#define YUKINO_JSONSCAN_H_
+
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Json.cc 和 JsonView.cc 共用的扫描和编码函数，只在实现文件中包含
+namespace Yukino
+{
+
+namespace json_scan
+{
+
+// 跳过 JSON 空白字符（空格、\t、\n、\r）
+// 支持 SSE2 时长段缩进每次检查 16 个字节
+inline const char *skip_whitespace(const char *p, const char *end)
+{
+    while (p < end)
+    {
+        char c = *p;
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+            return p;
+        p++;
+#if defined(__SSE2__)
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i lf = _mm_set1_epi8('\n');
+        const __m128i cr = _mm_set1_epi8('\r');
+        const __m128i tab = _mm_set1_epi8('\t');
+        while (end - p >= 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, lf)),
+                                      _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, tab)));
+            int mask = ~_mm_movemask_epi8(ws) & 0xffff;
+            if (mask != 0)
+                return p + __builtin_ctz(mask);
+            p += 16;
+        }
+#endif
+    }
+    return p;
+}
+
+// 返回 [p, end) 中第一个需要转义的字符（控制字符、双引号、反斜杠）的位置，没有时返回 end
+// 支持 SSE2 时每次检查 16 个字节，绝大多数字符串不含需要转义的字符，整段直接处理
+inline const char *find_escape(const char *p, const char *end)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i ctrl_max = _mm_set1_epi8(0x1f);
+    for (; end - p >= 16; p += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        // 无符号比较：min(v, 0x1f) == v 即 v <= 0x1f
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                                _mm_cmpeq_epi8(v, backslash)),
+                                   _mm_cmpeq_epi8(_mm_min_epu8(v, ctrl_max), v));
+        int mask = _mm_movemask_epi8(hit);
+        if (mask != 0)
+            return p + __builtin_ctz(mask);
+    }
+#endif
+    for (; p < end; p++)
+    {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c < 0x20 || c == '"' || c == '\\')
+            return p;
+    }
+    return end;
+}
+
+// 字符串的结束引号，p 指向开头引号之后，没有时返回 nullptr
+// 支持 SSE2 时每次检查 16 个字节中的引号和反斜杠
+inline const char *string_end(const char *p, const char *end)
+{
+    while (p < end)
+    {
+#if defined(__SSE2__)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        while (end - p >= 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+            if (mask != 0)
+            {
+                p += __builtin_ctz(mask);
+                break;
+            }
+            p += 16;
+        }
+        if (p == end)
+            return nullptr;
+#endif
+        if (*p == '"')
+            return p;
+        if (*p == '\\')
+            p++;  // 跳过被转义的字符
+        p++;
+    }
+    return nullptr;
+}
+
+// 容器中下一个需要关注的字符：引号和括号
+// 支持 SSE2 时每次检查 16 个字节
+inline const char *next_structural(const char *p, const char *end)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i lbrace = _mm_set1_epi8('{');
+    const __m128i rbrace = _mm_set1_epi8('}');
+    const __m128i lbracket = _mm_set1_epi8('[');
+    const __m128i rbracket = _mm_set1_epi8(']');
+    while (end - p >= 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, lbrace)),
+                                   _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, rbrace), _mm_cmpeq_epi8(v, lbracket)),
+                                                _mm_cmpeq_epi8(v, rbracket)));
+        int mask = _mm_movemask_epi8(hit);
+        if (mask != 0)
+            return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    for (; p < end; p++)
+    {
+        char c = *p;
+        if (c == '"' || c == '{' || c == '}' || c == '[' || c == ']')
+            return p;
+    }
+    return end;
+}
+
+inline int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// 读取 \u 之后的 4 位十六进制数
+inline bool read_hex4(const char *p, const char *end, unsigned int *code)
+{
+    if (end - p < 4)
+        return false;
+    *code = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        int v = hex_value(p[i]);
+        if (v < 0)
+            return false;
+        *code = (*code << 4) | v;
+    }
+    return true;
+}
+
+// 码点按 UTF-8 编码追加到 out
+inline void append_utf8(unsigned int code, std::string *out)
+{
+    if (code < 0x80)
+    {
+        out->push_back(static_cast<char>(code));
+    }
+    else if (code < 0x800)
+    {
+        out->push_back(static_cast<char>(0xC0 | (code >> 6)));
+        out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+    else if (code < 0x10000)
+    {
+        out->push_back(static_cast<char>(0xE0 | (code >> 12)));
+        out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+    else
+    {
+        out->push_back(static_cast<char>(0xF0 | (code >> 18)));
+        out->push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+}
+
+}  // namespace json_scan
+
+}  // namespace Yukino
+
+#endif  // YUKINO_JSONSCAN_H_
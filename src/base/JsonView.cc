@@ -0,0 +1,325 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "JsonView.h"
+#include "JsonScan.h"
+
+using namespace Yukino;
+using namespace Yukino::json_scan;
+
+namespace
+{
+
+// 还原字符串中的转义，无法识别的转义原样保留
+void unescape(const StringPiece &raw, std::string *out)
+{
+    const char *p = raw.begin();
+    const char *end = raw.end();
+    out->reserve(raw.size());
+    while (p < end)
+    {
+        const char *q = static_cast<const char *>(memchr(p, '\\', end - p));
+        if (!q)
+        {
+            out->append(p, end - p);
+            return;
+        }
+        out->append(p, q - p);
+        p = q + 1;
+        if (p == end)
+            return;
+
+        char c = *p++;
+        switch (c)
+        {
+        case 'b':
+            out->push_back('\b');
+            break;
+        case 'f':
+            out->push_back('\f');
+            break;
+        case 'n':
+            out->push_back('\n');
+            break;
+        case 'r':
+            out->push_back('\r');
+            break;
+        case 't':
+            out->push_back('\t');
+            break;
+        case 'u':
+        {
+            unsigned int code;
+            if (!read_hex4(p, end, &code))
+            {
+                out->append("\\u", 2);
+                break;
+            }
+            p += 4;
+            unsigned int low;
+            if (code >= 0xD800 && code <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                read_hex4(p + 2, end, &low) && low >= 0xDC00 && low <= 0xDFFF)
+            {
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                p += 6;
+            }
+            append_utf8(code, out);
+            break;
+        }
+        default:
+            // '"'、'\\'、'/' 以及无法识别的转义
+            out->push_back(c);
+            break;
+        }
+    }
+}
+
+// 原始的字符串内容与未转义的 key 是否相同
+bool string_equals(const StringPiece &raw, const StringPiece &key)
+{
+    if (!memchr(raw.data(), '\\', raw.size()))
+        return raw == key;
+
+    // 含有转义的成员名很少见，还原后再比较
+    std::string str;
+    unescape(raw, &str);
+    return StringPiece(str) == key;
+}
+
+}  // namespace
+
+JsonView::JsonView(const StringPiece &text)
+    : begin_(skip_whitespace(text.begin(), text.end())), end_(text.end())
+{
+}
+
+JsonViewType JsonView::type() const
+{
+    if (!begin_ || begin_ >= end_)
+        return JsonViewType::INVALID;
+
+    switch (*begin_)
+    {
+    case '{':
+        return JsonViewType::OBJECT;
+    case '[':
+        return JsonViewType::ARRAY;
+    case '"':
+        return JsonViewType::STRING;
+    case 't':
+    case 'f':
+        return JsonViewType::BOOLEAN;
+    case 'n':
+        return JsonViewType::NULL_VALUE;
+    case '-':
+        return JsonViewType::NUMBER;
+    default:
+        if (*begin_ >= '0' && *begin_ <= '9')
+            return JsonViewType::NUMBER;
+        return JsonViewType::INVALID;
+    }
+}
+
+const char *JsonView::skip_value(const char *p, const char *end)
+{
+    if (p >= end)
+        return nullptr;
+
+    switch (*p)
+    {
+    case '"':
+    {
+        const char *q = string_end(p + 1, end);
+        return q ? q + 1 : nullptr;
+    }
+    case '{':
+    case '[':
+    {
+        // 只匹配括号，字符串中的括号不计入
+        int depth = 0;
+        while (true)
+        {
+            p = next_structural(p, end);
+            if (p == end)
+                return nullptr;
+            switch (*p)
+            {
+            case '"':
+                p = string_end(p + 1, end);
+                if (!p)
+                    return nullptr;
+                break;
+            case '{':
+            case '[':
+                depth++;
+                break;
+            default:
+                if (--depth == 0)
+                    return p + 1;
+                break;
+            }
+            p++;
+        }
+    }
+    default:
+        // 数字和 true/false/null 到分隔符或空白为止
+        const char *start = p;
+        while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+               *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t')
+            p++;
+        return p > start ? p : nullptr;
+    }
+}
+
+const char *JsonView::first_child(char open) const
+{
+    if (begin_ >= end_ || *begin_ != open)
+        return nullptr;
+    return skip_whitespace(begin_ + 1, end_);
+}
+
+bool JsonView::next_member(const char **p, StringPiece *key) const
+{
+    const char *q = *p;
+    if (q >= end_ || *q != '"')
+        return false;
+
+    const char *key_end = string_end(q + 1, end_);
+    if (!key_end)
+        return false;
+    *key = StringPiece(q + 1, key_end - q - 1);
+
+    q = skip_whitespace(key_end + 1, end_);
+    if (q >= end_ || *q != ':')
+        return false;
+    *p = skip_whitespace(q + 1, end_);
+    return true;
+}
+
+bool JsonView::next_separator(const char **p, char close) const
+{
+    const char *q = skip_whitespace(*p, end_);
+    if (q >= end_ || *q == close || *q != ',')
+        return false;
+    *p = skip_whitespace(q + 1, end_);
+    return true;
+}
+
+JsonView JsonView::operator[](const StringPiece &key) const
+{
+    JsonView result;
+    for_each_member([&key, &result](const StringPiece &name, const JsonView &value)
+    {
+        if (!string_equals(name, key))
+            return true;
+        result = value;
+        return false;
+    });
+    return result;
+}
+
+JsonView JsonView::operator[](int index) const
+{
+    JsonView result;
+    if (index < 0)
+        return result;
+
+    int i = 0;
+    for_each_element([index, &i, &result](const JsonView &value)
+    {
+        if (i++ != index)
+            return true;
+        result = value;
+        return false;
+    });
+    return result;
+}
+
+size_t JsonView::size() const
+{
+    size_t count = 0;
+    if (is_object())
+        for_each_member([&count](const StringPiece &, const JsonView &) { count++; return true; });
+    else if (is_array())
+        for_each_element([&count](const JsonView &) { count++; return true; });
+    return count;
+}
+
+StringPiece JsonView::raw() const
+{
+    if (!valid())
+        return StringPiece();
+    const char *end = skip_value(begin_, end_);
+    if (!end)
+        return StringPiece();
+    return StringPiece(begin_, end - begin_);
+}
+
+StringPiece JsonView::string_piece() const
+{
+    if (!is_string())
+        return StringPiece();
+    const char *end = string_end(begin_ + 1, end_);
+    if (!end)
+        return StringPiece();
+    return StringPiece(begin_ + 1, end - begin_ - 1);
+}
+
+bool JsonView::has_escape() const
+{
+    StringPiece str = string_piece();
+    return !str.empty() && memchr(str.data(), '\\', str.size()) != nullptr;
+}
+
+std::string JsonView::get_string() const
+{
+    std::string str;
+    unescape(string_piece(), &str);
+    return str;
+}
+
+double JsonView::get_number() const
+{
+    if (!is_number())
+        return 0;
+
+    // 文本不一定以 '\0' 结尾，数字先拷贝到栈上再转换
+    StringPiece text = raw();
+    char buf[64];
+    if (text.empty() || text.size() >= sizeof buf)
+        return 0;
+    memcpy(buf, text.data(), text.size());
+    buf[text.size()] = '\0';
+    return strtod(buf, nullptr);
+}
+
+long long JsonView::get_int() const
+{
+    if (!is_number())
+        return 0;
+
+    StringPiece text = raw();
+    long long value = 0;
+    bool negative = false;
+    const char *p = text.begin();
+    if (p < text.end() && *p == '-')
+    {
+        negative = true;
+        p++;
+    }
+    // 超过 18 位可能溢出，交给 strtod
+    if (text.end() - p > 18)
+        return static_cast<long long>(get_number());
+    for (; p < text.end(); p++)
+    {
+        if (*p < '0' || *p > '9')
+            return static_cast<long long>(get_number());
+        value = value * 10 + (*p - '0');
+    }
+    return negative ? -value : value;
+}
+
+bool JsonView::get_bool() const
+{
+    return end_ - begin_ >= 4 && memcmp(begin_, "true", 4) == 0;
+}
@@ -0,0 +1,180 @@
+#ifndef YUKINO_JSONVIEW_H_
+#define YUKINO_JSONVIEW_H_
+
+#include <string>
+
+#include "StringPiece.h"
+
+namespace Yukino
+{
+
+// JsonView 指向的值的类型
+enum class JsonViewType
+{
+    INVALID,  // 路径不存在或文本不是合法的 JSON 值
+    NULL_VALUE,
+    BOOLEAN,
+    NUMBER,
+    STRING,
+    ARRAY,
+    OBJECT,
+};
+
+/**
+ * @brief 按需解析的只读 JSON 视图
+ *
+ * 只保存指向原始文本的指针，不构建 DOM：["a"]["b"][3] 这样的访问从当前值的开头扫描成员，
+ * 跳过不需要的值时只匹配括号和字符串边界，没有访问到的子树不会被解析，查找过程不分配内存。
+ * 字符串值以 StringPiece 的形式指向原始文本（不含引号，转义未还原），需要还原转义时用 get_string()。
+ *
+ * 视图不拥有文本，文本需要在视图使用期间保持有效（如 req->json_view() 指向 req->body()）。
+ * 只有访问路径上的部分会检查语法，跳过的值不做完整的校验。
+ */
+class JsonView
+{
+public:
+    JsonView() = default;
+
+    // 从 JSON 文本构造，跳过开头的空白
+    explicit JsonView(const StringPiece &text);
+
+    // 值的类型，由第一个字符决定
+    JsonViewType type() const;
+
+    bool valid() const
+    { return type() != JsonViewType::INVALID; }
+
+    bool is_null() const
+    { return type() == JsonViewType::NULL_VALUE; }
+
+    bool is_bool() const
+    { return type() == JsonViewType::BOOLEAN; }
+
+    bool is_number() const
+    { return type() == JsonViewType::NUMBER; }
+
+    bool is_string() const
+    { return type() == JsonViewType::STRING; }
+
+    bool is_array() const
+    { return type() == JsonViewType::ARRAY; }
+
+    bool is_object() const
+    { return type() == JsonViewType::OBJECT; }
+
+    /**
+     * @brief 查找对象的成员
+     *
+     * @param key 成员名（未转义的原始值），同名成员取第一个
+     * @return JsonView 成员的视图，不是对象或成员不存在时无效
+     */
+    JsonView operator[](const StringPiece &key) const;
+
+    JsonView operator[](const char *key) const
+    { return (*this)[StringPiece(key)]; }
+
+    JsonView operator[](const std::string &key) const
+    { return (*this)[StringPiece(key)]; }
+
+    /**
+     * @brief 获取数组的元素
+     *
+     * @param index 元素下标
+     * @return JsonView 元素的视图，不是数组或下标越界时无效
+     */
+    JsonView operator[](int index) const;
+
+    // 对象是否有该成员
+    bool has(const StringPiece &key) const
+    { return (*this)[key].valid(); }
+
+    // 数组的元素个数或对象的成员个数，其他类型为 0
+    size_t size() const;
+
+    // 值的完整原始文本，无效时为空
+    StringPiece raw() const;
+
+    // 字符串值的原始内容（不含引号，转义未还原），不是字符串时为空
+    StringPiece string_piece() const;
+
+    // 字符串值是否含有转义字符，含有时 string_piece() 与实际内容不同
+    bool has_escape() const;
+
+    // 还原转义后的字符串值，不是字符串时为空
+    std::string get_string() const;
+
+    // 数值，不是数字时为 0
+    double get_number() const;
+
+    // 整数值，不是数字时为 0，带小数或指数的数字按 double 截断
+    long long get_int() const;
+
+    // 布尔值，不是 true 时为 false
+    bool get_bool() const;
+
+    /**
+     * @brief 依次访问对象的成员
+     *
+     * @param func 参数为成员名的原始内容（转义未还原）和成员的视图，返回 false 时停止
+     */
+    template <typename FUNC>
+    void for_each_member(FUNC &&func) const
+    {
+        if (!is_object())
+            return;
+        const char *p = first_child('{');
+        StringPiece key;
+        while (p && next_member(&p, &key))
+        {
+            JsonView value(p, end_);
+            p = skip_value(p, end_);
+            if (!func(key, value) || !p || !next_separator(&p, '}'))
+                return;
+        }
+    }
+
+    /**
+     * @brief 依次访问数组的元素
+     *
+     * @param func 参数为元素的视图，返回 false 时停止
+     */
+    template <typename FUNC>
+    void for_each_element(FUNC &&func) const
+    {
+        if (!is_array())
+            return;
+        const char *p = first_child('[');
+        while (p && p < end_ && *p != ']')
+        {
+            JsonView value(p, end_);
+            p = skip_value(p, end_);
+            if (!func(value) || !p || !next_separator(&p, ']'))
+                return;
+        }
+    }
+
+private:
+    // begin 指向值的第一个字符，end 为整个文本的结尾（值的结尾在需要时才计算）
+    JsonView(const char *begin, const char *end) : begin_(begin), end_(end)
+    {}
+
+    // 跳过一个完整的值，返回值之后的位置，语法错误时返回 nullptr
+    static const char *skip_value(const char *p, const char *end);
+
+    // 容器的第一个子元素（跳过开括号和空白），空容器时指向闭括号
+    const char *first_child(char open) const;
+
+    // 读取下一个成员名和冒号，*p 移动到成员的值，没有更多成员时返回 false
+    bool next_member(const char **p, StringPiece *key) const;
+
+    // 跳过值之后的逗号，遇到 close 或语法错误时返回 false
+    bool next_separator(const char **p, char close) const;
+
+private:
+    const char *begin_ = nullptr;
+    const char *end_ = nullptr;
+};
+
+}  // namespace Yukino
+
+#endif  // YUKINO_JSONVIEW_H_
@@ -0,0 +1,57 @@
+#ifndef YUKINO_LAZYSTRING_H_
+#define YUKINO_LAZYSTRING_H_
+
+#include <string>
+
+#include "StringPiece.h"
+
+namespace Yukino
+{
+
+/**
+ * @brief 惰性字符串
+ *
+ * 平时只保存一个指向外部缓冲区的 StringPiece，
+ * 只有第一次以 std::string 的形式访问时才会拷贝出来，之后复用该拷贝。
+ */
+class LazyString
+{
+public:
+    // 设置视图，并丢弃之前物化出来的字符串
+    void set(const StringPiece &view)
+    {
+        view_ = view;
+        materialized_ = false;
+    }
+
+    // 获取视图，不产生拷贝
+    const StringPiece &view() const
+    { return view_; }
+
+    // 以 std::string 的形式获取，首次调用时才会拷贝
+    const std::string &str() const
+    {
+        if (!materialized_)
+        {
+            str_.assign(view_.data(), view_.size());
+            materialized_ = true;
+        }
+        return str_;
+    }
+
+    // 视图所指向的缓冲区发生迁移时（例如宿主对象被移动），将视图平移到新缓冲区
+    void rebase(const char *old_base, size_t len, const char *new_base)
+    {
+        if (view_.data() >= old_base && view_.data() < old_base + len)
+            view_ = StringPiece(new_base + (view_.data() - old_base), view_.size());
+    }
+
+private:
+    StringPiece view_;                // 指向外部缓冲区的视图
+    mutable std::string str_;         // 物化后的字符串
+    mutable bool materialized_ = false; // 是否已经物化
+};
+
+}  // namespace Yukino
+
+#endif // YUKINO_LAZYSTRING_H_
@@ -0,0 +1,207 @@
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+#include "workflow/HttpUtil.h"
+
+#include "AssetCache.h"
+#include "FileCache.h"
+#include "HttpMsg.h"
+#include "HttpFile.h"
+#include "HttpHeaderWriter.h"
+#include "HttpServerTask.h"
+#include "Compress.h"
+#include "ContentEncoding.h"
+#include "ErrorCode.h"
+#include "StringPiece.h"
+#include "StrUtil.h"
+
+using namespace Yukino;
+
+namespace
+{
+
+// 压缩后至少要比原始内容小这么多（百分比）才保存压缩版本
+constexpr size_t GZIP_MIN_SAVING_PERCENT = 10;
+
+// 小于该大小的资源不压缩，压缩头部的开销抵消了收益
+constexpr size_t GZIP_MIN_SIZE = 256;
+
+bool is_compressible(const std::string &content_type)
+{
+    StringPiece type(content_type);
+    if (type.starts_with("text/"))
+        return true;
+    return content_type.find("json") != std::string::npos ||
+           content_type.find("javascript") != std::string::npos ||
+           content_type.find("xml") != std::string::npos;
+}
+
+}  // namespace
+
+void AssetCache::set_capacity(size_t max_bytes, size_t max_file_size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_bytes_ = max_bytes;
+    max_file_size_ = max_file_size;
+    evict();
+}
+
+std::shared_ptr<const Asset> AssetCache::get(const std::string &path)
+{
+    // 文件是否变化交给 FileCache 判断，校验间隔内命中不产生系统调用
+    std::shared_ptr<const FileEntry> file = file_cache_.get(path);
+    if (!file)
+        return nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file->size > max_file_size_)
+            return nullptr;
+
+        auto it = map_.find(path);
+        if (it != map_.end())
+        {
+            const Asset &asset = *it->second->asset;
+            if (asset.ino == file->ino && asset.size == file->size &&
+                asset.mtime.tv_sec == file->mtime.tv_sec &&
+                asset.mtime.tv_nsec == file->mtime.tv_nsec)
+            {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                return it->second->asset;
+            }
+            erase(it);
+        }
+
+        // 其他请求正在加载同一路径时不重复读取和压缩，这次走普通的文件响应
+        if (!loading_.insert(path).second)
+            return nullptr;
+    }
+
+    std::shared_ptr<const Asset> asset = load(*file);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    loading_.erase(path);
+    if (!asset)
+        return nullptr;
+
+    auto it = map_.find(path);
+    if (it != map_.end())
+        erase(it);
+    if (asset->bytes() <= max_bytes_)
+    {
+        lru_.push_front(Node{path, asset});
+        map_.emplace(path, lru_.begin());
+        bytes_ += asset->bytes();
+        evict();
+    }
+    return asset;
+}
+
+std::shared_ptr<const Asset> AssetCache::load(const FileEntry &file)
+{
+    auto asset = std::make_shared<Asset>();
+    asset->ino = file.ino;
+    asset->size = file.size;
+    asset->mtime = file.mtime;
+    asset->content_type = ContentType::to_str(file.content_type);
+    asset->etag = HttpFile::make_etag(file.ino, file.size, file.mtime);
+
+    char last_modified[HttpHeaderWriter::HTTP_DATE_LEN];
+    HttpHeaderWriter::format_http_date(file.mtime.tv_sec, last_modified);
+    asset->last_modified.assign(last_modified, sizeof last_modified);
+
+    // 资源很小，直接在当前线程读取，只在未命中时发生一次
+    asset->body.resize(file.size);
+    size_t off = 0;
+    while (off < file.size)
+    {
+        ssize_t ret = pread(file.fd, &asset->body[off], file.size - off, off);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return nullptr;
+        off += ret;
+    }
+
+    if (asset->body.size() >= GZIP_MIN_SIZE && is_compressible(asset->content_type))
+    {
+        // 预压缩在处理函数的线程中进行，使用默认级别，避免冷启动时长时间占用处理线程
+        if (Compressor::gzip(asset->body.data(), asset->body.size(), &asset->gzip, CompressLevel::DEFAULT) != StatusOK ||
+            asset->gzip.size() * 100 > asset->body.size() * (100 - GZIP_MIN_SAVING_PERCENT))
+        {
+            asset->gzip.clear();
+            asset->gzip.shrink_to_fit();
+        }
+        else
+        {
+            // "xxx" -> "xxx-gzip"
+            asset->gzip_etag = asset->etag;
+            asset->gzip_etag.insert(asset->gzip_etag.size() - 1, "-gzip");
+        }
+    }
+    return asset;
+}
+
+void AssetCache::send(const std::shared_ptr<const Asset> &asset, const HttpReq *req, HttpResp *resp)
+{
+    resp->headers["Content-Type"] = asset->content_type;
+
+    resp->headers["Last-Modified"] = asset->last_modified;
+
+    const std::string *body = &asset->body;
+    const std::string *etag = &asset->etag;
+    if (!asset->gzip.empty())
+    {
+        // 同一个 URL 会根据 Accept-Encoding 返回不同的内容
+        resp->headers["Vary"] = "Accept-Encoding";
+        if (ContentEncoding::accepts(req->header_view("Accept-Encoding"), "gzip"))
+        {
+            resp->headers["Content-Encoding"] = "gzip";
+            body = &asset->gzip;
+            etag = &asset->gzip_etag;
+        }
+    }
+    resp->headers["ETag"] = *etag;
+
+    // 客户端缓存仍然有效，304 的 Content-Length 与完整响应一致
+    const char *method = req->get_method();
+    if ((strcasecmp(method, "GET") == 0 || strcasecmp(method, "HEAD") == 0) &&
+        HttpFile::not_modified(req, *etag, asset->mtime.tv_sec))
+    {
+        resp->set_status(HttpStatusNotModified);
+        resp->headers["Content-Length"] = std::to_string(body->size());
+        return;
+    }
+
+    // 响应发送完毕前持有资源的引用
+    task_of(resp)->add_callback([asset](HttpTask *) {});
+    resp->append_output_body_nocopy(body->data(), body->size());
+}
+
+void AssetCache::erase(std::unordered_map<std::string, NodeList::iterator>::iterator it)
+{
+    bytes_ -= it->second->asset->bytes();
+    lru_.erase(it->second);
+    map_.erase(it);
+}
+
+void AssetCache::evict()
+{
+    while (bytes_ > max_bytes_ && !lru_.empty())
+    {
+        bytes_ -= lru_.back().asset->bytes();
+        map_.erase(lru_.back().path);
+        lru_.pop_back();
+    }
+}
+
+void AssetCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    map_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
@@ -0,0 +1,127 @@
+#ifndef YUKINO_ASSETCACHE_H_
+#define YUKINO_ASSETCACHE_H_
+
+#include <sys/types.h>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Noncopyable.h"
+
+namespace Yukino
+{
+
+class HttpReq;
+class HttpResp;
+class FileCache;
+struct FileEntry;
+
+/**
+ * @brief 缓存在内存中的静态资源
+ *
+ * 除原始内容外，可压缩的资源还保存预先压缩好的 gzip 版本，
+ * 响应直接引用这里的数据，发送完毕前由响应持有引用。
+ */
+struct Asset : public Noncopyable
+{
+    std::string body;                 // 原始内容
+    std::string gzip;                 // gzip 压缩后的内容，压缩收益不大时为空
+    std::string content_type;         // Content-Type
+    std::string etag;                 // 原始内容的 ETag
+    std::string gzip_etag;            // gzip 版本的 ETag，两种编码的内容不同，验证器也不同
+    std::string last_modified;        // Last-Modified
+    ino_t ino = 0;                    // 以下三项用于判断文件是否变化
+    size_t size = 0;
+    struct timespec mtime = {0, 0};
+
+    // 占用的内存字节数
+    size_t bytes() const
+    { return body.size() + gzip.size(); }
+};
+
+/**
+ * @brief Static() 的热点资源内存缓存
+ *
+ * 按总字节数限制容量，超出时淘汰最久未使用的资源。只缓存不超过 max_file_size 的文件，
+ * 文件是否变化由所属服务器的 FileCache 的校验结果决定。每个 HttpServer 各有一个，
+ * 默认关闭，通过 HttpServer::static_cache 开启。
+ */
+class AssetCache : public Noncopyable
+{
+public:
+    // 文件通过 file_cache 打开和校验，file_cache 的生命周期需要长于资源缓存
+    explicit AssetCache(FileCache &file_cache) : file_cache_(file_cache)
+    {}
+
+    /**
+     * @brief 设置缓存容量
+     *
+     * @param max_bytes 所有资源（含压缩版本）的总字节数上限，0 表示关闭缓存
+     * @param max_file_size 单个文件的大小上限，更大的文件走普通的文件响应
+     */
+    void set_capacity(size_t max_bytes, size_t max_file_size);
+
+    // 缓存是否开启
+    bool enabled() const
+    { return max_bytes_ > 0; }
+
+    /**
+     * @brief 获取文件对应的缓存资源，未命中时同步读取文件并预先压缩
+     *
+     * 同一路径同时只有一个请求加载，其他同时未命中的请求不等待也不重复读取和压缩，
+     * 直接返回空，由调用者走普通的文件响应。
+     *
+     * @param path 文件路径
+     * @return std::shared_ptr<const Asset> 文件不存在、超过大小上限、读取失败或正在由其他请求加载时为空
+     */
+    std::shared_ptr<const Asset> get(const std::string &path);
+
+    /**
+     * @brief 直接用缓存资源作为响应，根据 Accept-Encoding 选择 gzip 版本，
+     *        客户端缓存仍然有效时返回 304
+     *
+     * @param asset 缓存资源
+     * @param req 请求
+     * @param resp 响应
+     */
+    static void send(const std::shared_ptr<const Asset> &asset, const HttpReq *req, HttpResp *resp);
+
+    // 清空缓存
+    void clear();
+
+private:
+    struct Node
+    {
+        std::string path;
+        std::shared_ptr<const Asset> asset;
+    };
+
+    using NodeList = std::list<Node>;
+
+    // 读取文件内容并生成压缩版本
+    static std::shared_ptr<const Asset> load(const FileEntry &file);
+
+    // 删除缓存项，调用前需要加锁
+    void erase(std::unordered_map<std::string, NodeList::iterator>::iterator it);
+
+    // 淘汰最久未使用的资源直到总字节数不超过上限，调用前需要加锁
+    void evict();
+
+private:
+    FileCache &file_cache_;            // 打开和校验文件
+    std::mutex mutex_;
+    NodeList lru_;                     // 表头为最近使用的资源
+    std::unordered_map<std::string, NodeList::iterator> map_;
+    std::unordered_set<std::string> loading_; // 正在加载的路径
+    size_t bytes_ = 0;                 // 当前占用的总字节数
+    size_t max_bytes_ = 0;
+    size_t max_file_size_ = 0;
+};
+
+}  // namespace Yukino
+
+#endif // YUKINO_ASSETCACHE_H_
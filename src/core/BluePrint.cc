@@ -18,16 +18,24 @@ void BluePrint::ROUTE(const std::string &route, const Handler &handler, Verb ver
                 for(auto asp : global_aspect->aspect_list)
                 {
                     auto ret = asp->before(req, resp);
-                    if(!ret) return nullptr; // 如果任意一个切面的前置逻辑返回 false，则拦截请求
+                    if(!ret)
+                    {
+                        // 如果任意一个切面的前置逻辑返回 false，则拦截请求
+                        detail::reject_deferred(resp);
+                        return nullptr;
+                    }
                 }
 
-                // 调用实际的请求处理函数
-                handler(req, resp);
+                // 调用实际的请求处理函数，切面推迟了处理函数时在 gate 任务的回调中执行
+                HttpServerTask *server_task = task_of(resp);
+                if(server_task->handler_gated())
+                    server_task->push_handler_gate([handler, req, resp]() { handler(req, resp); });
+                else
+                    handler(req, resp);
 
                 // 如果存在全局切面逻辑，为任务添加回调函数，用于执行后置逻辑
                 if(!global_aspect->aspect_list.empty())
                 {
-                    HttpServerTask *server_task = task_of(resp);
                     server_task->add_callback([req, resp, global_aspect](HttpTask *)
                     {
                         // 遍历全局切面列表（逆序），执行每个切面的后置逻辑
@@ -59,20 +67,38 @@ void BluePrint::ROUTE(const std::string &route, int compute_queue_id, const Hand
                 for(auto asp : global_aspect->aspect_list)
                 {
                     auto ret = asp->before(req, resp);
-                    if(!ret) return nullptr; // 如果任意一个切面的前置逻辑返回 false，则拦截请求
+                    if(!ret)
+                    {
+                        // 如果任意一个切面的前置逻辑返回 false，则拦截请求
+                        detail::reject_deferred(resp);
+                        return nullptr;
+                    }
                 }
 
-                // 创建一个 WFGoTask 任务，指定计算队列ID
-                WFGoTask *go_task = WFTaskFactory::create_go_task(
-                        "Yukino" + std::to_string(compute_queue_id),
-                        handler,
-                        req,
-                        resp);
+                HttpServerTask *server_task = task_of(resp);
+                WFGoTask *go_task = nullptr;
+                if(server_task->handler_gated())
+                {
+                    // 切面推迟了处理函数：在 gate 任务的回调中再创建计算任务并加入序列
+                    server_task->push_handler_gate([handler, compute_queue_id, req, resp, server_task]()
+                    {
+                        **server_task << WFTaskFactory::create_go_task(
+                                "Yukino" + std::to_string(compute_queue_id), handler, req, resp);
+                    });
+                }
+                else
+                {
+                    // 创建一个 WFGoTask 任务，指定计算队列ID
+                    go_task = WFTaskFactory::create_go_task(
+                            "Yukino" + std::to_string(compute_queue_id),
+                            handler,
+                            req,
+                            resp);
+                }
 
                 // 如果存在全局切面逻辑，为任务添加回调函数，用于执行后置逻辑
                 if(!global_aspect->aspect_list.empty())
                 {
-                    HttpServerTask *server_task = task_of(resp);
                     server_task->add_callback([req, resp, global_aspect](HttpTask *)
                     {
                         // 遍历全局切面列表（逆序），执行每个切面的后置逻辑
@@ -208,16 +234,24 @@ void BluePrint::ROUTE(const std::string &route, const SeriesHandler &handler, Ve
                 for(auto asp : global_aspect->aspect_list)
                 {
                     auto ret = asp->before(req, resp);
-                    if(!ret) return nullptr; // 如果任意一个切面的前置逻辑返回 false，则拦截请求
+                    if(!ret)
+                    {
+                        // 如果任意一个切面的前置逻辑返回 false，则拦截请求
+                        detail::reject_deferred(resp);
+                        return nullptr;
+                    }
                 }
 
-                // 调用实际的请求处理函数
-                handler(req, resp, series);
+                // 调用实际的请求处理函数，切面推迟了处理函数时在 gate 任务的回调中执行
+                HttpServerTask *server_task = task_of(resp);
+                if(server_task->handler_gated())
+                    server_task->push_handler_gate([handler, req, resp, series]() { handler(req, resp, series); });
+                else
+                    handler(req, resp, series);
 
                 // 如果存在全局切面逻辑，为任务添加回调函数，用于执行后置逻辑
                 if(!global_aspect->aspect_list.empty())
                 {
-                    HttpServerTask *server_task = task_of(resp);
                     server_task->add_callback([req, resp, global_aspect](HttpTask *)
                     {
                         // 遍历全局切面列表（逆序），执行每个切面的后置逻辑
@@ -249,21 +283,39 @@ void BluePrint::ROUTE(const std::string &route, int compute_queue_id, const Seri
                 for(auto asp : global_aspect->aspect_list)
                 {
                     auto ret = asp->before(req, resp);
-                    if(!ret) return nullptr; // 如果任意一个切面的前置逻辑返回 false，则拦截请求
+                    if(!ret)
+                    {
+                        // 如果任意一个切面的前置逻辑返回 false，则拦截请求
+                        detail::reject_deferred(resp);
+                        return nullptr;
+                    }
                 }
 
-                // 创建一个 WFGoTask 任务，指定计算队列ID
-                WFGoTask *go_task = WFTaskFactory::create_go_task(
-                        "Yukino" + std::to_string(compute_queue_id),
-                        handler,
-                        req,
-                        resp,
-                        series);
+                HttpServerTask *server_task = task_of(resp);
+                WFGoTask *go_task = nullptr;
+                if(server_task->handler_gated())
+                {
+                    // 切面推迟了处理函数：在 gate 任务的回调中再创建计算任务并加入序列
+                    server_task->push_handler_gate([handler, compute_queue_id, req, resp, series, server_task]()
+                    {
+                        **server_task << WFTaskFactory::create_go_task(
+                                "Yukino" + std::to_string(compute_queue_id), handler, req, resp, series);
+                    });
+                }
+                else
+                {
+                    // 创建一个 WFGoTask 任务，指定计算队列ID
+                    go_task = WFTaskFactory::create_go_task(
+                            "Yukino" + std::to_string(compute_queue_id),
+                            handler,
+                            req,
+                            resp,
+                            series);
+                }
 
                 // 如果存在全局切面逻辑，为任务添加回调函数，用于执行后置逻辑
                 if(!global_aspect->aspect_list.empty())
                 {
-                    HttpServerTask *server_task = task_of(resp);
                     server_task->add_callback([req, resp, global_aspect](HttpTask *)
                     {
                         // 遍历全局切面列表（逆序），执行每个切面的后置逻辑
@@ -429,6 +481,8 @@ void BluePrint::add_blueprint(const BluePrint &bp, const std::string &url_prefix
         VerbHandler &vh = this->router_.routes_map_.find_or_create(rv_pair.first->route.c_str());
         vh = verb_handler; // 将子路由的处理函数赋值给当前路由
         vh.path = rv_pair.first->route; // 更新路由路径
+        if (vh.body_stream.enabled())
+            this->router_.has_body_stream_ = true; // 子路由开启了流式请求体
     });
 }
 
@@ -254,6 +254,29 @@ public:
     const Router &router() const
     { return router_; }
 
+    // 为已注册的路由设置静态响应头（如 Cache-Control），注册时预先序列化，响应中设置的同名响应头优先
+    // 路由未注册时返回 StatusRouteNotFound
+    int set_route_header(const std::string &route, const std::string &name, const std::string &value)
+    { return router_.set_route_header(route, name, value); }
+
+    // 为已注册的路由设置响应的压缩级别：对延迟敏感的接口用 FASTEST，可缓存的大资源用 BEST
+    // 路由未注册时返回 StatusRouteNotFound
+    int set_compress_level(const std::string &route, CompressLevel level)
+    { return router_.set_compress_level(route, level); }
+
+    // 为已注册的路由开启流式请求体：请求体不再缓存，每块数据到达时交给 on_chunk（在网络线程中执行，不能阻塞）
+    // 处理函数在请求体接收完毕后调用，此时 req->body() 为空；max_body_size 为 0 表示不限制
+    // 路由未注册时返回 StatusRouteNotFound
+    int stream_body(const std::string &route, const BodyChunkFunc &on_chunk, size_t max_body_size = 0)
+    { return router_.stream_body(route, on_chunk, max_body_size); }
+
+    // 为已注册的路由开启流式请求体：请求体通过文件任务直接写入 path_func 返回的文件，
+    // 处理函数在文件全部写完后调用，可以通过 req->body_stream()->file_path() 获取文件路径
+    // 写入失败或未写完的数据超过 4MB（磁盘跟不上网络）时不调用处理函数，直接回复 507
+    // 路由未注册时返回 StatusRouteNotFound
+    int stream_body_to_file(const std::string &route, const BodyFilePathFunc &path_func, size_t max_body_size = 0)
+    { return router_.stream_body_to_file(route, path_func, max_body_size); }
+
     // 将一个 BluePrint 对象添加到当前 BluePrint 中，并指定 URL 前缀
     void add_blueprint(const BluePrint &bp, const std::string &url_prefix);
 
@@ -6,6 +6,14 @@ namespace Yukino
 namespace detail
 {
 
+// 请求被切面拦截：之前的切面推迟了处理函数时（见 HttpServerTask::defer_handler），gate 任务照常执行，但不再执行处理函数
+inline void reject_deferred(HttpResp *resp)
+{
+    HttpServerTask *server_task = task_of(resp);
+    if (server_task->handler_gated())
+        server_task->push_handler_gate(nullptr);
+}
+
 // 为了减少泛型编程的使用，添加了一些冗余代码
 template<typename Tuple>
 WFGoTask *aop_process(const Handler &handler,
@@ -14,28 +22,38 @@ WFGoTask *aop_process(const Handler &handler,
                       Tuple *tp)
 {
     // 在处理请求之前，调用 aop_before 函数，执行前置切面逻辑
-    bool ret = aop_before(req, resp, *tp);
-    if (!ret)
+    if (!aop_before(req, resp, *tp))
     {
         // 如果前置切面逻辑返回 false，则直接返回 nullptr，表示请求被拦截
+        // 此时不会注册后置回调，元组需要在这里释放
+        reject_deferred(resp);
+        delete tp;
         return nullptr;
     }
 
     // 获取全局切面实例
     GlobalAspect *global_aspect = GlobalAspect::get_instance();
-    // 遍历全局切面列表，执行每个切面的前置逻辑
+    // 遍历全局切面列表，执行每个切面的前置逻辑（路由切面先于全局切面执行）
     for(auto asp : global_aspect->aspect_list)
     {
-        ret = asp->before(req, resp);
-        if(!ret) return nullptr; // 如果任意一个切面的前置逻辑返回 false，则拦截请求
+        if(!asp->before(req, resp))
+        {
+            // 如果任意一个切面的前置逻辑返回 false，则拦截请求，并释放元组
+            reject_deferred(resp);
+            delete tp;
+            return nullptr;
+        }
     }
 
-    // 调用实际的请求处理函数
-    handler(req, resp);
-
     // 获取当前请求对应的 HttpServerTask 对象
     HttpServerTask *server_task = task_of(resp);
 
+    // 调用实际的请求处理函数，切面推迟了处理函数时在 gate 任务的回调中执行
+    if (server_task->handler_gated())
+        server_task->push_handler_gate([handler, req, resp]() { handler(req, resp); });
+    else
+        handler(req, resp);
+
     // 为任务添加回调函数，用于执行后置切面逻辑
     server_task->add_callback([req, resp, tp, global_aspect](HttpTask *) 
     {
@@ -65,28 +83,38 @@ WFGoTask *aop_process(const SeriesHandler &handler,
                       Tuple *tp)
 {
     // 在处理请求之前，调用 aop_before 函数，执行前置切面逻辑
-    bool ret = aop_before(req, resp, *tp);
-    if (!ret)
+    if (!aop_before(req, resp, *tp))
     {
         // 如果前置切面逻辑返回 false，则直接返回 nullptr，表示请求被拦截
+        // 此时不会注册后置回调，元组需要在这里释放
+        reject_deferred(resp);
+        delete tp;
         return nullptr;
     }
 
     // 获取全局切面实例
     GlobalAspect *global_aspect = GlobalAspect::get_instance();
-    // 遍历全局切面列表，执行每个切面的前置逻辑
+    // 遍历全局切面列表，执行每个切面的前置逻辑（路由切面先于全局切面执行）
     for(auto asp : global_aspect->aspect_list)
     {
-        ret = asp->before(req, resp);
-        if(!ret) return nullptr; // 如果任意一个切面的前置逻辑返回 false，则拦截请求
+        if(!asp->before(req, resp))
+        {
+            // 如果任意一个切面的前置逻辑返回 false，则拦截请求，并释放元组
+            reject_deferred(resp);
+            delete tp;
+            return nullptr;
+        }
     }
 
-    // 调用实际的请求处理函数（支持异步序列化任务）
-    handler(req, resp, series);
-
     // 获取当前请求对应的 HttpServerTask 对象
     HttpServerTask *server_task = task_of(resp);
 
+    // 调用实际的请求处理函数（支持异步序列化任务），切面推迟了处理函数时在 gate 任务的回调中执行
+    if (server_task->handler_gated())
+        server_task->push_handler_gate([handler, req, resp, series]() { handler(req, resp, series); });
+    else
+        handler(req, resp, series);
+
     // 为任务添加回调函数，用于执行后置切面逻辑
     server_task->add_callback([req, resp, tp, global_aspect](HttpTask *) 
     {
@@ -115,32 +143,52 @@ WFGoTask *aop_compute_process(const Handler &handler,
                               Tuple *tp)
 {
     // 在处理请求之前，调用 aop_before 函数，执行前置切面逻辑
-    bool ret = aop_before(req, resp, *tp);
-    if (!ret)
+    if (!aop_before(req, resp, *tp))
     {
         // 如果前置切面逻辑返回 false，则直接返回 nullptr，表示请求被拦截
+        // 此时不会注册后置回调，元组需要在这里释放
+        reject_deferred(resp);
+        delete tp;
         return nullptr;
     }
 
     // 获取全局切面实例
     GlobalAspect *global_aspect = GlobalAspect::get_instance();
-    // 遍历全局切面列表，执行每个切面的前置逻辑
+    // 遍历全局切面列表，执行每个切面的前置逻辑（路由切面先于全局切面执行）
     for(auto asp : global_aspect->aspect_list)
     {
-        ret = asp->before(req, resp);
-        if(!ret) return nullptr; // 如果任意一个切面的前置逻辑返回 false，则拦截请求
+        if(!asp->before(req, resp))
+        {
+            // 如果任意一个切面的前置逻辑返回 false，则拦截请求，并释放元组
+            reject_deferred(resp);
+            delete tp;
+            return nullptr;
+        }
     }
 
-    // 创建一个 WFGoTask 任务，指定计算队列ID
-    WFGoTask *go_task = WFTaskFactory::create_go_task(
-            "Yukino" + std::to_string(compute_queue_id), // 任务名称，包含计算队列ID
-            handler, // 请求处理函数
-            req, // HTTP请求对象
-            resp); // HTTP响应对象
-
     // 获取当前请求对应的 HttpServerTask 对象
     HttpServerTask *server_task = task_of(resp);
 
+    WFGoTask *go_task = nullptr;
+    if (server_task->handler_gated())
+    {
+        // 切面推迟了处理函数：在 gate 任务的回调中再创建计算任务并加入序列
+        server_task->push_handler_gate([handler, compute_queue_id, req, resp, server_task]()
+        {
+            **server_task << WFTaskFactory::create_go_task(
+                    "Yukino" + std::to_string(compute_queue_id), handler, req, resp);
+        });
+    }
+    else
+    {
+        // 创建一个 WFGoTask 任务，指定计算队列ID
+        go_task = WFTaskFactory::create_go_task(
+                "Yukino" + std::to_string(compute_queue_id), // 任务名称，包含计算队列ID
+                handler, // 请求处理函数
+                req, // HTTP请求对象
+                resp); // HTTP响应对象
+    }
+
     // 为任务添加回调函数，用于执行后置切面逻辑
     server_task->add_callback([req, resp, tp, global_aspect](HttpTask *) 
     {
@@ -170,33 +218,53 @@ WFGoTask *aop_compute_process(const SeriesHandler &handler,
                               Tuple *tp)
 {
     // 在处理请求之前，调用 aop_before 函数，执行前置切面逻辑
-    bool ret = aop_before(req, resp, *tp);
-    if (!ret)
+    if (!aop_before(req, resp, *tp))
     {
         // 如果前置切面逻辑返回 false，则直接返回 nullptr，表示请求被拦截
+        // 此时不会注册后置回调，元组需要在这里释放
+        reject_deferred(resp);
+        delete tp;
         return nullptr;
     }
 
     // 获取全局切面实例
     GlobalAspect *global_aspect = GlobalAspect::get_instance();
-    // 遍历全局切面列表，执行每个切面的前置逻辑
+    // 遍历全局切面列表，执行每个切面的前置逻辑（路由切面先于全局切面执行）
     for(auto asp : global_aspect->aspect_list)
     {
-        ret = asp->before(req, resp);
-        if(!ret) return nullptr; // 如果任意一个切面的前置逻辑返回 false，则拦截请求
+        if(!asp->before(req, resp))
+        {
+            // 如果任意一个切面的前置逻辑返回 false，则拦截请求，并释放元组
+            reject_deferred(resp);
+            delete tp;
+            return nullptr;
+        }
     }
 
-    // 创建一个 WFGoTask 任务，指定计算队列ID
-    WFGoTask *go_task = WFTaskFactory::create_go_task(
-            "Yukino" + std::to_string(compute_queue_id), // 任务名称，包含计算队列ID
-            handler, // 请求处理函数
-            req, // HTTP请求对象
-            resp, // HTTP响应对象
-            series); // SeriesWork 对象，用于支持异步序列化任务
-
     // 获取当前请求对应的 HttpServerTask 对象
     HttpServerTask *server_task = task_of(resp);
 
+    WFGoTask *go_task = nullptr;
+    if (server_task->handler_gated())
+    {
+        // 切面推迟了处理函数：在 gate 任务的回调中再创建计算任务并加入序列
+        server_task->push_handler_gate([handler, compute_queue_id, req, resp, series, server_task]()
+        {
+            **server_task << WFTaskFactory::create_go_task(
+                    "Yukino" + std::to_string(compute_queue_id), handler, req, resp, series);
+        });
+    }
+    else
+    {
+        // 创建一个 WFGoTask 任务，指定计算队列ID
+        go_task = WFTaskFactory::create_go_task(
+                "Yukino" + std::to_string(compute_queue_id), // 任务名称，包含计算队列ID
+                handler, // 请求处理函数
+                req, // HTTP请求对象
+                resp, // HTTP响应对象
+                series); // SeriesWork 对象，用于支持异步序列化任务
+    }
+
     // 为任务添加回调函数，用于执行后置切面逻辑
     server_task->add_callback([req, resp, tp, global_aspect](HttpTask *) 
     {
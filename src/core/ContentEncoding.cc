@@ -0,0 +1,152 @@
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+#include "ContentEncoding.h"
+#include "StrUtil.h"
+
+using namespace Yukino;
+
+void ContentEncoding::enable(size_t min_size, const std::vector<std::string> &mime_types)
+{
+    enabled_ = true;
+    min_size_ = min_size;
+    mime_types_ = mime_types;
+}
+
+void ContentEncoding::set_level_policy(CompressLevel level, size_t large_size, CompressLevel large_level)
+{
+    level_ = level == CompressLevel::AUTO ? CompressLevel::DEFAULT : level;
+    large_size_ = large_size;
+    large_level_ = large_level == CompressLevel::AUTO ? CompressLevel::DEFAULT : large_level;
+}
+
+CompressLevel ContentEncoding::level_for(CompressLevel level, size_t size) const
+{
+    if (level != CompressLevel::AUTO)
+        return level;
+    if (large_size_ > 0 && size >= large_size_)
+        return large_level_;
+    return level_;
+}
+
+size_t ContentEncoding::decompress_limit(size_t compressed_size) const
+{
+    size_t limit = decompress_max_size_;
+    if (decompress_max_ratio_ > 0)
+    {
+        // 压缩数据很小时也至少允许解压出 64KB，避免压缩率很高的小请求被误判
+        size_t ratio_limit = compressed_size * decompress_max_ratio_;
+        if (ratio_limit < 64 * 1024)
+            ratio_limit = 64 * 1024;
+        if (limit == 0 || ratio_limit < limit)
+            limit = ratio_limit;
+    }
+    return limit;
+}
+
+bool ContentEncoding::negotiate(const StringPiece &accept_encoding, const StringPiece &content_type,
+                                size_t size, Compress *method) const
+{
+    if (!enabled_ || size < min_size_ || accept_encoding.empty() || !is_compressible(content_type))
+        return false;
+
+    // 按服务器的偏好排列，q 值相同时取靠前的
+    static const Compress preference[] = { Compress::ZSTD, Compress::BROTLI, Compress::GZIP };
+
+    double best_q = 0;
+    for (Compress candidate : preference)
+    {
+        if (!Compressor::supported(candidate))
+            continue;
+
+        double q = quality(accept_encoding, compress_method_to_str(candidate));
+        if (q > best_q)
+        {
+            best_q = q;
+            *method = candidate;
+        }
+    }
+    return best_q > 0;
+}
+
+bool ContentEncoding::is_compressible(const StringPiece &content_type) const
+{
+    StringPiece type = content_type;
+    const char *semi = static_cast<const char *>(memchr(type.data(), ';', type.size()));
+    if (semi)
+        type = StringPiece(type.data(), semi - type.data());
+    type = StrUtil::trim(type);
+    if (type.empty())
+        return false;
+
+    for (const std::string &mime : mime_types_)
+    {
+        if (mime.empty())
+            continue;
+
+        if (mime.back() == '/')
+        {
+            if (type.size() >= mime.size() && strncasecmp(type.data(), mime.c_str(), mime.size()) == 0)
+                return true;
+        }
+        else if (mime[0] == '+')
+        {
+            if (type.size() >= mime.size() &&
+                strncasecmp(type.end() - mime.size(), mime.c_str(), mime.size()) == 0)
+                return true;
+        }
+        else if (type.size() == mime.size() && strncasecmp(type.data(), mime.c_str(), mime.size()) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+double ContentEncoding::quality(const StringPiece &accept, const StringPiece &coding)
+{
+    double coding_q = -1;
+    double any_q = -1;
+
+    for (const StringPiece &entry : StrUtil::split_piece<StringPiece>(accept, ','))
+    {
+        StringPiece item = entry;
+        StringPiece params;
+        const char *semi = static_cast<const char *>(memchr(item.data(), ';', item.size()));
+        if (semi)
+        {
+            params = StringPiece(semi + 1, item.end() - semi - 1);
+            item = StringPiece(item.data(), semi - item.data());
+        }
+        item = StrUtil::trim(item);
+
+        double q = 1;
+        params = StrUtil::trim(params);
+        if (params.size() >= 2 && (params[0] == 'q' || params[0] == 'Q') && params[1] == '=')
+            q = strtod(std::string(params.data() + 2, params.size() - 2).c_str(), nullptr);
+
+        if (item.size() == coding.size() && strncasecmp(item.data(), coding.data(), item.size()) == 0)
+            coding_q = q;
+        else if (item == "*")
+            any_q = q;
+    }
+
+    if (coding_q >= 0)
+        return coding_q;
+    return any_q > 0 ? any_q : 0;
+}
+
+const std::vector<std::string> &ContentEncoding::default_mime_types()
+{
+    static const std::vector<std::string> types = {
+        "text/",
+        "application/json",
+        "application/javascript",
+        "application/xml",
+        "image/svg+xml",
+        "+json",
+        "+xml",
+    };
+    return types;
+}
@@ -0,0 +1,121 @@
+#ifndef YUKINO_CONTENTENCODING_H_
+#define YUKINO_CONTENTENCODING_H_
+
+#include <string>
+#include <vector>
+
+#include "Compress.h"
+#include "Noncopyable.h"
+#include "StringPiece.h"
+
+namespace Yukino
+{
+
+/**
+ * @brief 响应压缩的自动协商
+ *
+ * 开启后，没有设置 Content-Encoding 的 String()、Json() 响应按请求的 Accept-Encoding 自动压缩：
+ * 响应体不小于 min_size 且 Content-Type 在可压缩列表中时，从客户端接受的编码里选 q 值最高的一种，
+ * q 值相同时依次优先 zstd、br、gzip（只考虑编译进来的压缩方法）。
+ * 每个 HttpServer 各有一份配置，在服务器启动前通过 HttpServer::compress 设置，运行期间只读。
+ *
+ * 同时保存请求体解压的上限（HttpServer::decompress_limit），防止很小的压缩请求体解压出巨大的数据。
+ */
+class ContentEncoding : public Noncopyable
+{
+public:
+    // 默认不自动压缩，只使用默认的解压上限
+    ContentEncoding() = default;
+
+    /**
+     * @brief 开启自动压缩
+     *
+     * @param min_size 响应体小于该字节数时不压缩
+     * @param mime_types 可压缩的 MIME 类型，以 '/' 结尾的按前缀匹配（如 "text/"），
+     *        以 '+' 开头的按后缀匹配（如 "+json"），其余忽略大小写完全匹配，都忽略 ';' 之后的参数
+     */
+    void enable(size_t min_size, const std::vector<std::string> &mime_types);
+
+    // 关闭自动压缩
+    void disable()
+    { enabled_ = false; }
+
+    // 自动压缩是否开启
+    bool enabled() const
+    { return enabled_; }
+
+    /**
+     * @brief 设置按响应体大小选择压缩级别的策略
+     *
+     * 路由和响应都没有指定压缩级别（CompressLevel::AUTO）时使用：
+     * 响应体小于 large_size 时用 level，否则用 large_level，large_size 为 0 表示全部使用 level
+     */
+    void set_level_policy(CompressLevel level, size_t large_size = 0,
+                          CompressLevel large_level = CompressLevel::DEFAULT);
+
+    /**
+     * @brief 确定实际使用的压缩级别
+     *
+     * @param level 路由或响应指定的压缩级别，不是 AUTO 时直接使用
+     * @param size 响应体的字节数
+     */
+    CompressLevel level_for(CompressLevel level, size_t size) const;
+
+    /**
+     * @brief 为响应选择压缩方法
+     *
+     * @param accept_encoding 请求的 Accept-Encoding
+     * @param content_type 响应的 Content-Type
+     * @param size 响应体的字节数
+     * @param method 选中的压缩方法
+     * @return bool 不需要压缩时返回 false
+     */
+    bool negotiate(const StringPiece &accept_encoding, const StringPiece &content_type,
+                   size_t size, Compress *method) const;
+
+    /**
+     * @brief 设置请求体解压的上限
+     *
+     * @param max_size 解压后的最大字节数，0 表示不限制
+     * @param max_ratio 解压后的大小与压缩数据大小之比的上限，0 表示不限制
+     */
+    void set_decompress_limit(size_t max_size, size_t max_ratio)
+    {
+        decompress_max_size_ = max_size;
+        decompress_max_ratio_ = max_ratio;
+    }
+
+    // 压缩数据为 compressed_size 字节时允许解压出的最大字节数，取大小和压缩比两个上限中较小的一个，0 表示不限制
+    size_t decompress_limit(size_t compressed_size) const;
+
+    // Content-Type 是否在可压缩列表中
+    bool is_compressible(const StringPiece &content_type) const;
+
+    /**
+     * @brief Accept-Encoding 中某种内容编码的 q 值
+     *
+     * 明确列出的编码以它的 q 值为准，否则看 "*" 的 q 值，都没有时为 0（不接受）
+     */
+    static double quality(const StringPiece &accept, const StringPiece &coding);
+
+    // Accept-Encoding 是否接受某种内容编码
+    static bool accepts(const StringPiece &accept, const StringPiece &coding)
+    { return quality(accept, coding) > 0; }
+
+    // 默认的可压缩 MIME 类型：文本、JSON、JavaScript、XML 和 SVG
+    static const std::vector<std::string> &default_mime_types();
+
+private:
+    bool enabled_ = false;
+    size_t min_size_ = 0;
+    std::vector<std::string> mime_types_;
+    CompressLevel level_ = CompressLevel::DEFAULT;
+    size_t large_size_ = 0;
+    CompressLevel large_level_ = CompressLevel::DEFAULT;
+    size_t decompress_max_size_ = 64 * 1024 * 1024;  // 默认最多解压出 64MB
+    size_t decompress_max_ratio_ = 200;  // 默认压缩比不超过 200，正常的文本和 JSON 远低于这个值
+};
+
+}  // namespace Yukino
+
+#endif // YUKINO_CONTENTENCODING_H_
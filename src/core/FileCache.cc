@@ -0,0 +1,156 @@
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "FileCache.h"
+#include "PathUtil.h"
+#include "spdlog/spdlog.h"
+
+using namespace Yukino;
+
+FileEntry::~FileEntry()
+{
+    if (fd >= 0)
+        close(fd);
+}
+
+std::shared_ptr<const FileEntry> FileCache::get(const std::string &path)
+{
+    time_t now = time(nullptr);
+    std::shared_ptr<const FileEntry> cached;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = map_.find(path);
+        if (it != map_.end())
+        {
+            Node &node = *it->second;
+            lru_.splice(lru_.begin(), lru_, it->second);
+            if (now - node.checked < valid_seconds_)
+                return node.entry;
+            cached = node.entry;
+        }
+    }
+
+    // 未命中或需要重新校验
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        if (cached)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = map_.find(path);
+            if (it != map_.end())
+            {
+                lru_.erase(it->second);
+                map_.erase(it);
+            }
+        }
+        return nullptr;
+    }
+
+    if (cached && cached->ino == st.st_ino &&
+        cached->size == static_cast<size_t>(st.st_size) &&
+        cached->mtime.tv_sec == st.st_mtim.tv_sec &&
+        cached->mtime.tv_nsec == st.st_mtim.tv_nsec)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = map_.find(path);
+        if (it != map_.end() && it->second->entry == cached)
+            it->second->checked = now;
+        return cached;
+    }
+
+    std::shared_ptr<const FileEntry> entry = open_entry(path);
+    if (entry)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        put(path, entry, now);
+    }
+    return entry;
+}
+
+std::shared_ptr<const FileEntry> FileCache::open_entry(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+
+    auto entry = std::make_shared<FileEntry>();
+    entry->fd = fd;
+
+    // 以打开的文件为准，避免 stat 和 open 之间文件被替换
+    struct stat fst;
+    if (fstat(fd, &fst) != 0 || !S_ISREG(fst.st_mode))
+        return nullptr;
+
+    entry->size = fst.st_size;
+    entry->mtime = fst.st_mtim;
+    entry->ino = fst.st_ino;
+
+    std::string suffix = PathUtil::suffix(path);
+    if (!suffix.empty())
+    {
+        http_content_type content_type = ContentType::to_enum_by_suffix(suffix);
+        if (content_type != CONTENT_TYPE_NONE && content_type != CONTENT_TYPE_UNDEFINED)
+            entry->content_type = content_type;
+    }
+    return entry;
+}
+
+void FileCache::put(const std::string &path, const std::shared_ptr<const FileEntry> &entry, time_t now)
+{
+    if (capacity_ == 0)
+        return;
+
+    auto it = map_.find(path);
+    if (it != map_.end())
+    {
+        it->second->entry = entry;
+        it->second->checked = now;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+
+    lru_.push_front(Node{path, entry, now});
+    map_.emplace(path, lru_.begin());
+    while (map_.size() > capacity_)
+    {
+        map_.erase(lru_.back().path);
+        lru_.pop_back();
+    }
+}
+
+void FileCache::set_capacity(size_t capacity)
+{
+    // 缓存的文件描述符不超过软限制的四分之一，其余留给连接，避免 accept() 返回 EMFILE
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY &&
+        capacity > limit.rlim_cur / 4)
+    {
+        spdlog::warn("[YUKINO] file cache capacity {} exceeds a quarter of RLIMIT_NOFILE ({}), clamped to {}",
+                     capacity, limit.rlim_cur, limit.rlim_cur / 4);
+        capacity = limit.rlim_cur / 4;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    while (map_.size() > capacity_)
+    {
+        map_.erase(lru_.back().path);
+        lru_.pop_back();
+    }
+}
+
+void FileCache::set_valid_seconds(int valid_seconds)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    valid_seconds_ = valid_seconds;
+}
+
+void FileCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    map_.clear();
+    lru_.clear();
+}
@@ -0,0 +1,102 @@
+#ifndef YUKINO_FILECACHE_H_
+#define YUKINO_FILECACHE_H_
+
+#include <sys/types.h>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "HttpDef.h"
+#include "Noncopyable.h"
+
+namespace Yukino
+{
+
+/**
+ * @brief 已打开文件的元数据
+ *
+ * 文件描述符在最后一个引用释放时关闭，正在发送的响应持有引用，
+ * 因此缓存淘汰或失效不会影响已经开始的读取。
+ */
+struct FileEntry : public Noncopyable
+{
+    int fd = -1;                      // 只读打开的文件描述符
+    size_t size = 0;                  // 文件大小
+    struct timespec mtime = {0, 0};   // 最后修改时间
+    ino_t ino = 0;                    // inode，文件被替换时会变化
+    http_content_type content_type = APPLICATION_OCTET_STREAM; // 根据后缀解析出的内容类型
+
+    ~FileEntry();
+};
+
+/**
+ * @brief 静态文件的打开文件和元数据缓存
+ *
+ * 以路径为键的 LRU 缓存，最多保存 capacity 个文件（默认 64 个）。每个 HttpServer 各有一个，
+ * 通过 HttpServer::file_cache 配置，互不影响。
+ * 命中且距离上次校验不超过 valid_seconds 秒时不产生任何系统调用；
+ * 超过后重新 stat 一次，inode、大小或修改时间变化时重新打开文件。
+ */
+class FileCache : public Noncopyable
+{
+public:
+    FileCache() = default;
+
+    /**
+     * @brief 获取普通文件的缓存项
+     *
+     * @param path 文件路径
+     * @return std::shared_ptr<const FileEntry> 文件不存在、不是普通文件或打开失败时为空
+     */
+    std::shared_ptr<const FileEntry> get(const std::string &path);
+
+    /**
+     * @brief 设置缓存容量，0 表示关闭缓存（每次都重新打开文件）
+     *
+     * 每个缓存项都占用一个文件描述符，容量不超过 RLIMIT_NOFILE 软限制的四分之一，
+     * 给连接留出足够的描述符，超过时按上限截断并记录警告。
+     *
+     * @param capacity 最多缓存的文件数
+     */
+    void set_capacity(size_t capacity);
+
+    /**
+     * @brief 设置缓存项的有效期
+     *
+     * @param valid_seconds 两次校验之间的秒数，0 表示每次命中都校验
+     */
+    void set_valid_seconds(int valid_seconds);
+
+    // 清空缓存
+    void clear();
+
+private:
+    struct Node
+    {
+        std::string path;
+        std::shared_ptr<const FileEntry> entry;
+        time_t checked;                // 上次校验的时间
+    };
+
+    using NodeList = std::list<Node>;
+
+    // 打开文件并读取元数据
+    static std::shared_ptr<const FileEntry> open_entry(const std::string &path);
+
+    // 插入或替换缓存项，超出容量时淘汰最久未使用的项，调用前需要加锁
+    void put(const std::string &path, const std::shared_ptr<const FileEntry> &entry, time_t now);
+
+private:
+    std::mutex mutex_;
+    NodeList lru_;                     // 表头为最近使用的项
+    std::unordered_map<std::string, NodeList::iterator> map_;
+    size_t capacity_ = 64;             // 默认只缓存少量热点文件，避免占用过多文件描述符
+    int valid_seconds_ = 1;
+};
+
+}  // namespace Yukino
+
+#endif // YUKINO_FILECACHE_H_
@@ -0,0 +1,307 @@
+#include "workflow/WFTaskFactory.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+#include "HttpBodyStream.h"
+#include "spdlog/spdlog.h"
+
+namespace Yukino
+{
+
+/**
+ * @brief 请求体的文件写入端
+ *
+ * 每块数据拷贝一份后交给一个 pwrite 任务异步写入，写入位置由偏移量决定，与完成顺序无关。
+ * 尚未写完的数据超过 MAX_PENDING_BYTES 时说明磁盘跟不上网络，写入以 ENOSPC 失败，之后的数据直接丢弃，
+ * 请求体接收完毕后回复 507。不在网络线程中同步写入，避免一个慢磁盘阻塞同一 poller 上的所有连接。
+ * 写入任务持有本对象的引用，文件在最后一个任务结束后关闭。
+ */
+class BodyFileSink : public std::enable_shared_from_this<BodyFileSink>
+{
+public:
+    static constexpr size_t MAX_PENDING_BYTES = 4 * 1024 * 1024;
+
+    explicit BodyFileSink(int fd) : fd_(fd) {}
+
+    ~BodyFileSink()
+    { close(fd_); }
+
+    void write(const char *data, size_t len, off_t offset);
+
+    SubTask *wait(SubTask *task);
+
+    int error()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+
+private:
+    void write_done(long ret, size_t len, int state, int error);
+
+private:
+    int fd_;
+    std::mutex mutex_;
+    size_t pending_bytes_ = 0;       // 已提交但尚未写完的字节数
+    int pending_tasks_ = 0;          // 尚未结束的写入任务数
+    int error_ = 0;                  // 第一次写入失败的 errno
+    WFConditional *waiter_ = nullptr; // 等待全部写完的条件任务
+};
+
+void BodyFileSink::write(const char *data, size_t len, off_t offset)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_)
+            return;
+
+        if (pending_bytes_ + len > MAX_PENDING_BYTES)
+        {
+            // 磁盘跟不上网络，放弃这次上传，不占用更多内存，也不阻塞网络线程
+            error_ = ENOSPC;
+            return;
+        }
+        pending_bytes_ += len;
+        pending_tasks_++;
+    }
+
+    char *buf = new char[len];
+    memcpy(buf, data, len);
+
+    auto self = shared_from_this();
+    WFFileIOTask *pwrite_task = WFTaskFactory::create_pwrite_task(fd_, buf, len, offset,
+        [self, buf, len](WFFileIOTask *task)
+    {
+        delete []buf;
+        self->write_done(task->get_retval(), len, task->get_state(), task->get_error());
+    });
+    pwrite_task->start();
+}
+
+void BodyFileSink::write_done(long ret, size_t len, int state, int error)
+{
+    WFConditional *waiter = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_)
+        {
+            if (state != WFT_STATE_SUCCESS)
+                error_ = error ? error : EIO;
+            else if (ret < 0 || static_cast<size_t>(ret) != len)
+                error_ = EIO;
+        }
+
+        pending_bytes_ -= len;
+        if (--pending_tasks_ == 0)
+        {
+            waiter = waiter_;
+            waiter_ = nullptr;
+        }
+    }
+
+    if (waiter)
+        waiter->signal(NULL);
+}
+
+SubTask *BodyFileSink::wait(SubTask *task)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_tasks_ == 0)
+        return task;
+
+    waiter_ = WFTaskFactory::create_conditional(task);
+    return waiter_;
+}
+
+BodyStream::BodyStream(const BodyStreamOptions *options, const HttpReq *req,
+                       bool chunked, size_t content_length)
+    : options_(options),
+      req_(req),
+      chunked_(chunked),
+      remaining_(chunked ? 0 : content_length)
+{
+    if (!options_->file_path)
+        return;
+
+    file_path_ = options_->file_path(req_);
+    int fd = open(file_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        error_ = errno;
+        spdlog::error("[YUKINO] Open {} for request body failed: {}", file_path_, strerror(error_));
+        return;
+    }
+    sink_ = std::make_shared<BodyFileSink>(fd);
+}
+
+BodyStream::~BodyStream() = default;
+
+int BodyStream::error() const
+{
+    if (error_)
+        return error_;
+    return sink_ ? sink_->error() : 0;
+}
+
+SubTask *BodyStream::wait_flushed(SubTask *task)
+{
+    return sink_ ? sink_->wait(task) : task;
+}
+
+void BodyStream::deliver(const char *data, size_t len)
+{
+    if (options_->on_chunk)
+        options_->on_chunk(req_, StringPiece(data, len));
+    if (sink_)
+        sink_->write(data, len, received_);
+    received_ += len;
+}
+
+int BodyStream::feed(const char *data, size_t len, size_t *consumed)
+{
+    if (chunked_)
+        return feed_chunked(data, len, consumed);
+
+    // Content-Length 已知，超出上限时直接拒绝，不必等数据到达
+    if (options_->max_body_size && received_ + remaining_ > options_->max_body_size)
+    {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    size_t n = len < remaining_ ? len : remaining_;
+    if (n > 0)
+        deliver(data, n);
+    remaining_ -= n;
+    *consumed = n;
+    return remaining_ == 0 ? 1 : 0;
+}
+
+static inline int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+int BodyStream::feed_chunked(const char *data, size_t len, size_t *consumed)
+{
+    size_t pos = 0;
+
+    while (pos < len && state_ != CHUNK_DONE)
+    {
+        char c = data[pos];
+        switch (state_)
+        {
+        case CHUNK_SIZE:
+        {
+            int v = hex_digit(c);
+            if (v >= 0)
+            {
+                if (chunk_size_ > (SIZE_MAX >> 4))
+                {
+                    errno = EBADMSG;
+                    return -1;
+                }
+                chunk_size_ = chunk_size_ << 4 | v;
+            }
+            else if (c == ';' || c == ' ' || c == '\t')
+                state_ = CHUNK_EXT;
+            else if (c == '\r')
+                state_ = CHUNK_SIZE_LF;
+            else
+            {
+                errno = EBADMSG;
+                return -1;
+            }
+            pos++;
+            break;
+        }
+
+        case CHUNK_EXT:
+            if (c == '\r')
+                state_ = CHUNK_SIZE_LF;
+            pos++;
+            break;
+
+        case CHUNK_SIZE_LF:
+            if (c != '\n')
+            {
+                errno = EBADMSG;
+                return -1;
+            }
+            pos++;
+            if (chunk_size_ == 0)
+            {
+                state_ = CHUNK_TRAILER;
+                break;
+            }
+            if (options_->max_body_size && received_ + chunk_size_ > options_->max_body_size)
+            {
+                errno = EMSGSIZE;
+                return -1;
+            }
+            remaining_ = chunk_size_;
+            chunk_size_ = 0;
+            state_ = CHUNK_DATA;
+            break;
+
+        case CHUNK_DATA:
+        {
+            size_t n = len - pos < remaining_ ? len - pos : remaining_;
+            deliver(data + pos, n);
+            pos += n;
+            remaining_ -= n;
+            if (remaining_ == 0)
+                state_ = CHUNK_DATA_CR;
+            break;
+        }
+
+        case CHUNK_DATA_CR:
+        case CHUNK_LAST_LF:
+        case CHUNK_DATA_LF:
+            if (c != (state_ == CHUNK_DATA_CR ? '\r' : '\n'))
+            {
+                errno = EBADMSG;
+                return -1;
+            }
+            pos++;
+            if (state_ == CHUNK_DATA_CR)
+                state_ = CHUNK_DATA_LF;
+            else if (state_ == CHUNK_DATA_LF)
+                state_ = CHUNK_SIZE;
+            else
+                state_ = CHUNK_DONE;
+            break;
+
+        case CHUNK_TRAILER:
+            // 尾部的头部行直接丢弃，遇到空行表示请求体结束
+            state_ = c == '\r' ? CHUNK_LAST_LF : CHUNK_TRAILER_LINE;
+            pos++;
+            break;
+
+        case CHUNK_TRAILER_LINE:
+            if (c == '\n')
+                state_ = CHUNK_TRAILER;
+            pos++;
+            break;
+
+        case CHUNK_DONE:
+            break;
+        }
+    }
+
+    *consumed = pos;
+    return state_ == CHUNK_DONE ? 1 : 0;
+}
+
+}  // namespace Yukino
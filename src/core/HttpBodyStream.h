@@ -0,0 +1,123 @@
+#ifndef YUKINO_HTTPBODYSTREAM_H_
+#define YUKINO_HTTPBODYSTREAM_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "StringPiece.h"
+
+class SubTask;
+
+namespace Yukino
+{
+
+class HttpReq;
+class BodyFileSink;
+
+// 流式请求体的数据回调，每收到一块请求体数据调用一次（在网络线程中执行，不能阻塞）
+using BodyChunkFunc = std::function<void(const HttpReq *req, const StringPiece &chunk)>;
+
+// 请求体写入文件时，根据请求生成目标文件路径
+using BodyFilePathFunc = std::function<std::string(const HttpReq *req)>;
+
+/**
+ * @brief 路由的流式请求体配置
+ *
+ * 开启后请求体不再缓存在内存中：数据到达时要么依次交给 on_chunk，
+ * 要么通过 WFFileIOTask 直接写入 file_path 返回的文件。
+ * 路由的处理函数在请求体接收完毕（写入文件时为全部写完）后才会调用。
+ */
+struct BodyStreamOptions
+{
+    BodyChunkFunc on_chunk;       // 数据回调
+    BodyFilePathFunc file_path;   // 目标文件路径
+    size_t max_body_size = 0;     // 请求体大小上限，0 表示不限制
+
+    bool enabled() const
+    { return on_chunk || file_path; }
+};
+
+/**
+ * @brief 单个请求的流式请求体状态
+ *
+ * 请求头解析完成后由 HttpReq 创建（位于任务的内存池中），
+ * 负责解码 Content-Length 或 chunked 格式的请求体并把数据交给回调或文件。
+ * 请求体按原样传递，不做 Content-Encoding 解压。
+ */
+class BodyStream
+{
+public:
+    BodyStream(const BodyStreamOptions *options, const HttpReq *req, bool chunked, size_t content_length);
+    ~BodyStream();
+
+    /**
+     * @brief 输入一段网络数据
+     *
+     * @param data 数据
+     * @param len 数据长度
+     * @param consumed 本次消费的字节数，请求体结束后剩余的数据不会被消费
+     * @return int 1 表示请求体结束，0 表示还需要更多数据，-1 表示格式错误或超出大小上限（errno 已设置）
+     */
+    int feed(const char *data, size_t len, size_t *consumed);
+
+    // 已经接收的请求体字节数
+    size_t received() const
+    { return received_; }
+
+    // 请求体是否写入文件
+    bool to_file() const
+    { return sink_ != nullptr; }
+
+    // 目标文件路径（仅写入文件时有效）
+    const std::string &file_path() const
+    { return file_path_; }
+
+    // 写入文件时发生的错误（errno），0 表示没有错误；尚未写完的数据过多时为 ENOSPC
+    int error() const;
+
+    /**
+     * @brief 等待请求体全部写入文件后再执行 task
+     *
+     * @param task 要执行的任务
+     * @return SubTask* 需要放入序列的任务，不写入文件或已经写完时就是 task 本身
+     */
+    SubTask *wait_flushed(SubTask *task);
+
+    void *user_data = nullptr; // 数据回调可以在这里保存自己的状态
+
+private:
+    void deliver(const char *data, size_t len);
+
+    int feed_chunked(const char *data, size_t len, size_t *consumed);
+
+private:
+    enum ChunkState
+    {
+        CHUNK_SIZE,        // 块大小（十六进制）
+        CHUNK_EXT,         // 块扩展，直到 \r\n
+        CHUNK_SIZE_LF,     // 块大小行的 \n
+        CHUNK_DATA,        // 块数据
+        CHUNK_DATA_CR,     // 块数据后的 \r
+        CHUNK_DATA_LF,     // 块数据后的 \n
+        CHUNK_TRAILER,     // 尾部头部行的开头
+        CHUNK_TRAILER_LINE,// 尾部头部行
+        CHUNK_LAST_LF,     // 结束空行的 \n
+        CHUNK_DONE,
+    };
+
+    const BodyStreamOptions *options_;
+    const HttpReq *req_;
+    bool chunked_;
+    size_t remaining_;            // Content-Length 模式下剩余的字节数，chunked 模式下当前块剩余的字节数
+    size_t chunk_size_ = 0;       // 正在解析的块大小
+    ChunkState state_ = CHUNK_SIZE;
+    size_t received_ = 0;
+    int error_ = 0;               // 打开文件失败时的 errno
+    std::string file_path_;
+    std::shared_ptr<BodyFileSink> sink_;
+};
+
+}  // namespace Yukino
+
+#endif // YUKINO_HTTPBODYSTREAM_H_
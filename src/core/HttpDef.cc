@@ -8,15 +8,16 @@ namespace
     /**
      * @brief 检查字符串是否以指定的前缀开头。
      *
-     * @param str 要检查的字符串。
+     * @param str 要检查的字符串（不要求以 '\0' 结尾）。
      * @param start 前缀字符串。
      * @return int 如果 str 以 start 开头，返回 1；否则返回 0。
      */
-    int strstartswith(const char *str, const char *start)
+    int strstartswith(const StringPiece &str, const char *start)
     {
-        while (*str && *start && *str == *start)
+        size_t i = 0;
+        while (i < str.size() && *start && str[i] == *start)
         {
-            ++str;
+            ++i;
             ++start;
         }
         return *start == '\0';
@@ -47,14 +48,14 @@ std::string ContentType::to_str(enum http_content_type type)
  * @param content_type_str 要转换的 MIME 类型字符串。
  * @return enum http_content_type 对应的 HTTP 内容类型枚举值，如果字符串为空，则返回 CONTENT_TYPE_NONE；如果类型未知，则返回 CONTENT_TYPE_UNDEFINED。
  */
-enum http_content_type ContentType::to_enum(const std::string &content_type_str)
+enum http_content_type ContentType::to_enum(const StringPiece &content_type_str)
 {
     if (content_type_str.empty())
     {
         return CONTENT_TYPE_NONE;
     }
 #define XX(name, string, suffix) \
-    if (strstartswith(content_type_str.c_str(), #string)) { \
+    if (strstartswith(content_type_str, #string)) { \
         return name; \
     }
     HTTP_CONTENT_TYPE_MAP(XX)
@@ -3,6 +3,8 @@
 
 #include <string>
 
+#include "StringPiece.h"
+
 namespace Yukino
 {
     // MIME 类型定义，参考 IANA 官方文档：https://www.iana.org/assignments/media-types/media-types.xhtml
@@ -50,7 +52,7 @@ namespace Yukino
         static std::string to_str_by_suffix(const std::string &suffix);
 
         // 将 MIME 类型字符串转换为枚举类型
-        static enum http_content_type to_enum(const std::string &content_type_str);
+        static enum http_content_type to_enum(const StringPiece &content_type_str);
 
         // 根据文件后缀获取对应的枚举类型
         static enum http_content_type to_enum_by_suffix(const std::string &suffix);
@@ -1,11 +1,22 @@
 #include "workflow/WFTaskFactory.h"
+#include "workflow/HttpUtil.h"
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <strings.h>
+#include <openssl/ssl.h>
 #include "HttpFile.h"
 #include "HttpMsg.h"
-#include "PathUtil.h"
 #include "HttpServerTask.h"
-#include "FileUtil.h"
+#include "HttpServer.h"
+#include "HttpHeaderWriter.h"
+#include "FileCache.h"
+#include "Compress.h"
+#include "StrUtil.h"
 #include "ErrorCode.h"
+#include "spdlog/spdlog.h"
 
 namespace Yukino
 {
@@ -44,6 +55,49 @@ namespace
         }
     }
 
+    /**
+     * @brief 压缩发送时异步文件读取任务的回调函数，读取的内容按 Content-Encoding 压缩后追加到响应体
+     *
+     * @param pread_task 异步文件读取任务对象
+     */
+    void pread_compress_callback(WFFileIOTask *pread_task)
+    {
+        FileIOArgs *args = pread_task->get_args();
+        long ret = pread_task->get_retval();
+        auto *resp = static_cast<HttpResp *>(pread_task->user_data);
+
+        if (pread_task->get_state() != WFT_STATE_SUCCESS || ret < 0)
+            resp->Error(StatusFileReadError);
+        else if (resp->append_compressed(static_cast<const char *>(args->buf), ret) != StatusOK)
+            resp->Error(StatusCompressError);
+    }
+
+    // 小于该大小的文件片段直接读入内存后随响应发送
+    constexpr size_t FILE_MAP_THRESHOLD = 256 * 1024;
+
+    /**
+     * @brief 确定文件响应的压缩方法
+     *
+     * gzip 可以分块流式压缩；br 和 zstd 只能整体压缩，只用于读入内存的较小片段。
+     * 无法压缩的情况（空文件、无法识别或没有编译进来的编码、较大片段要求 br 或 zstd）去掉 Content-Encoding 按原样发送。
+     *
+     * @return bool 需要压缩时返回 true
+     */
+    bool file_encoding(HttpResp *resp, size_t size, Compress *method)
+    {
+        auto it = resp->headers.find("Content-Encoding");
+        if (it == resp->headers.end())
+            return false;
+
+        if (size > 0 && compress_method_from_str(StrUtil::trim(it->second), method) &&
+            Compressor::supported(*method) &&
+            (*method == Compress::GZIP || size < FILE_MAP_THRESHOLD))
+            return true;
+
+        resp->headers.erase(it);
+        return false;
+    }
+
     /**
      * @brief 异步文件写入任务的回调函数
      * 
@@ -77,87 +131,699 @@ namespace
         }
     }
 
-}  // namespace
+    // 流式发送时每次读取的块大小，也是每个下载占用的全部缓冲区
+    constexpr size_t FILE_STREAM_CHUNK = 64 * 1024;
 
-// note : [start, end)
-int HttpFile::send_file(const std::string &path, size_t file_start, size_t file_end, HttpResp *resp)
-{
-    // 检查文件是否存在
-    if (!PathUtil::is_file(path))
+    // 发送缓冲区满时重试的等待时间（纳秒），连续失败时加倍，发出数据后恢复
+    constexpr long FILE_STREAM_RETRY_MIN = 1000000;
+    constexpr long FILE_STREAM_RETRY_MAX = 128000000;
+
+    /**
+     * @brief 流式发送文件的上下文，位于任务的内存池中
+     */
+    struct FileStreamCtx
     {
-        return StatusNotFound; // 如果文件不存在，返回状态码 StatusNotFound
+        HttpServerTask *server_task = nullptr; // 所属服务器任务
+        int fd = -1; // 文件描述符
+        off_t offset = 0; // 下一次读取的位置
+        off_t end = 0; // 结束位置（不包含）
+        char *buf = nullptr; // 发送缓冲区
+        size_t cap = 0; // 缓冲区容量
+        size_t len = 0; // 缓冲区中的数据量
+        size_t pos = 0; // 已经发送的数据量
+        long retry_ns = FILE_STREAM_RETRY_MIN; // 下一次重试的等待时间
+        GzipStream *gzip = nullptr; // 压缩发送时的压缩流，不压缩时为空
+        char *in_buf = nullptr; // 压缩发送时的读取缓冲区
+        std::string *out = nullptr; // 压缩发送时的发送缓冲区，存放 chunked 编码的压缩结果
+    };
+
+    // 压缩结果写成一个 chunk 追加到 out
+    void append_chunk(std::string *out, const char *data, size_t len)
+    {
+        char head[24];
+        int head_len = snprintf(head, sizeof head, "%zx\r\n", len);
+        out->append(head, head_len);
+        out->append(data, len);
+        out->append("\r\n", 2);
     }
 
-    // 初始化文件范围的起始和结束位置
-    int start = file_start;
-    int end = file_end;
+    void stream_read(FileStreamCtx *ctx);
 
-    // 如果结束位置为 -1 或起始位置小于 0，需要获取文件大小并调整范围
-    if (end == -1 || start < 0)
+    void stream_flush(FileStreamCtx *ctx);
+
+    void stream_pread_callback(WFFileIOTask *pread_task)
     {
-        size_t file_size;
-        int ret = FileUtil::size(path, &file_size); // 获取文件大小
+        auto *ctx = static_cast<FileStreamCtx *>(pread_task->user_data);
+        long ret = pread_task->get_retval();
+        if (pread_task->get_state() != WFT_STATE_SUCCESS || ret <= 0)
+        {
+            // 响应头已经发出，只能关闭连接
+            spdlog::error("[YUKINO] Stream file read failed at offset {}", ctx->offset);
+            return;
+        }
 
-        if (ret != StatusOK)
+        ctx->offset += ret;
+        if (!ctx->gzip)
         {
-            return ret; // 如果获取文件大小失败，返回错误状态码
+            ctx->len += ret;
+            stream_flush(ctx);
+            return;
         }
 
-        if (end == -1) end = file_size; // 如果结束位置为 -1，设置为文件大小
-        if (start < 0) start = file_size + start; // 如果起始位置为负数，计算从文件末尾开始的位置
+        // 压缩读到的内容，最后一块输出 GZIP 尾部和 chunked 的结束标记
+        std::string *out = ctx->out;
+        bool finish = ctx->offset >= ctx->end;
+        int status = ctx->gzip->update(ctx->in_buf, ret, finish, [out](const char *data, size_t len)
+        {
+            append_chunk(out, data, len);
+        });
+        if (status != StatusOK)
+        {
+            spdlog::error("[YUKINO] Stream file compress failed at offset {}", ctx->offset);
+            return;
+        }
+        if (finish)
+            out->append("0\r\n\r\n", 5);
+
+        ctx->buf = &(*out)[0];
+        ctx->len = out->size();
+        stream_flush(ctx);
     }
 
-    // 检查文件范围是否有效
-    if (end <= start)
+    // 发送缓冲区满，稍后可以重试的错误。TLS 连接上 push 把 SSL_get_error 的结果取负后放入 errno
+    bool push_would_block(int err)
     {
-        return StatusFileRangeInvalid; // 如果结束位置小于或等于起始位置，返回状态码 StatusFileRangeInvalid
+        return err == EWOULDBLOCK || err == EAGAIN ||
+               err == -SSL_ERROR_WANT_WRITE || err == -SSL_ERROR_WANT_READ;
     }
 
-    // 确定文件的内容类型
-    http_content_type content_type = CONTENT_TYPE_NONE;
-    std::string suffix = PathUtil::suffix(path); // 获取文件扩展名
-    if (!suffix.empty())
+    void stream_retry_callback(WFTimerTask *timer_task)
     {
-        content_type = ContentType::to_enum_by_suffix(suffix); // 根据扩展名获取内容类型
+        stream_flush(static_cast<FileStreamCtx *>(timer_task->user_data));
     }
-    if (content_type == CONTENT_TYPE_NONE || content_type == CONTENT_TYPE_UNDEFINED)
+
+    // 读取下一块文件内容，接在已有数据（第一次为响应头）之后
+    // 压缩发送时读入单独的缓冲区，压缩结果再追加到发送缓冲区
+    void stream_read(FileStreamCtx *ctx)
     {
-        content_type = APPLICATION_OCTET_STREAM; // 如果无法确定内容类型，设置为默认的二进制流类型
+        size_t count = ctx->gzip ? FILE_STREAM_CHUNK : ctx->cap - ctx->len;
+        if (static_cast<off_t>(count) > ctx->end - ctx->offset)
+            count = ctx->end - ctx->offset;
+
+        WFFileIOTask *pread_task = WFTaskFactory::create_pread_task(ctx->fd,
+                                                                    ctx->gzip ? ctx->in_buf : ctx->buf + ctx->len,
+                                                                    count,
+                                                                    ctx->offset,
+                                                                    stream_pread_callback);
+        pread_task->user_data = ctx;
+        series_of(ctx->server_task)->push_front(pread_task);
     }
-    resp->headers["Content-Type"] = ContentType::to_str(content_type); // 设置响应头中的 Content-Type
 
-    // 计算要读取的文件片段大小
-    size_t size = end - start;
-    void *buf = malloc(size); // 分配内存用于存储文件片段
+    // 把缓冲区中的数据推送给客户端，发送缓冲区满时退避重试，发完后再读取下一块
+    void stream_flush(FileStreamCtx *ctx)
+    {
+        // 压缩器可能暂时没有输出，此时直接读取下一块
+        if (ctx->pos < ctx->len)
+        {
+            int nwritten = ctx->server_task->push(ctx->buf + ctx->pos, ctx->len - ctx->pos);
+            if (nwritten < 0)
+            {
+                if (!push_would_block(errno))
+                    return;
+                nwritten = 0;
+            }
+            ctx->pos += nwritten;
 
-    // 获取当前的 HttpServerTask 对象
-    HttpServerTask *server_task = task_of(resp);
+            if (nwritten > 0)
+                ctx->retry_ns = FILE_STREAM_RETRY_MIN;
+        }
+
+        if (ctx->pos < ctx->len)
+        {
+            long delay = ctx->retry_ns;
+            if (ctx->retry_ns < FILE_STREAM_RETRY_MAX)
+                ctx->retry_ns *= 2;
+
+            WFTimerTask *timer_task = WFTaskFactory::create_timer_task(delay / 1000000000,
+                                                                       delay % 1000000000,
+                                                                       stream_retry_callback);
+            timer_task->user_data = ctx;
+            series_of(ctx->server_task)->push_front(timer_task);
+            return;
+        }
+
+        ctx->pos = 0;
+        ctx->len = 0;
+        if (ctx->out)
+            ctx->out->clear();
+        if (ctx->offset < ctx->end)
+            stream_read(ctx);
+    }
+
+    // 序列化流式发送的响应头，响应不经过 HttpServerTask::message_out，这里补齐必要的响应头
+    // chunked 为 true 时响应体长度未知，使用 chunked 编码
+    std::string stream_header(HttpResp *resp, size_t size, bool chunked)
+    {
+        if (!resp->get_status_code() || !resp->get_reason_phrase())
+        {
+            const char *status_code_str = resp->get_status_code();
+            protocol::HttpUtil::set_response_status(resp, status_code_str ? atoi(status_code_str) : HttpStatusOK);
+        }
+
+        std::string header;
+        header.reserve(256);
+        header.append("HTTP/1.1 ");
+        header.append(resp->get_status_code());
+        header.append(" ");
+        header.append(resp->get_reason_phrase());
+        header.append("\r\n");
+
+        auto append_line = [&header](const StringPiece &name, const StringPiece &value)
+        {
+            size_t pos = header.size();
+            header.resize(pos + HttpHeaderWriter::line_size(name, value));
+            HttpHeaderWriter::write_line(&header[pos], name, value);
+        };
+
+        for (auto &header_kv : resp->headers)
+        {
+            if (strcasecmp(header_kv.first.c_str(), "Content-Length") == 0 ||
+                strcasecmp(header_kv.first.c_str(), "Connection") == 0 ||
+                strcasecmp(header_kv.first.c_str(), "Transfer-Encoding") == 0)
+                continue;
+            append_line(header_kv.first, header_kv.second);
+        }
+        if (resp->headers.find("Date") == resp->headers.end())
+            append_line("Date", HttpHeaderWriter::http_date());
+
+        // 路由的静态响应头，与 HttpServerTask::message_out 一致，处理函数设置的同名响应头优先
+        const RouteHeaders *route_headers = task_of(resp)->route_headers();
+        if (route_headers)
+        {
+            for (size_t i = 0; i < route_headers->names.size(); i++)
+            {
+                const std::string &name = route_headers->names[i];
+                if (resp->headers.find(name) != resp->headers.end() ||
+                    strcasecmp(name.c_str(), "Content-Length") == 0 ||
+                    strcasecmp(name.c_str(), "Connection") == 0 ||
+                    strcasecmp(name.c_str(), "Transfer-Encoding") == 0)
+                    continue;
+                size_t begin = route_headers->offsets[i];
+                header.append(route_headers->block, begin, route_headers->offsets[i + 1] - begin);
+            }
+        }
+
+        for (auto &cookie : resp->cookies())
+            append_line("Set-Cookie", cookie.dump());
+
+        // 发送完毕后连接随服务器任务一起关闭
+        if (chunked)
+            append_line("Transfer-Encoding", "chunked");
+        else
+            append_line("Content-Length", std::to_string(size));
+        append_line("Connection", "close");
+        header.append("\r\n");
+        return header;
+    }
+
+    /**
+     * @brief 分块流式发送文件片段
+     *
+     * 每个下载只占用一块固定大小的缓冲区：pread 读满一块后通过 push 直接写入连接，
+     * 写完再读下一块。响应头和文件内容都不经过 HttpResp，因此服务器任务设置为不回复。
+     * gzip 为 true 时每块读到的内容压缩后以 chunked 编码发送，压缩流在整个下载中持续使用。
+     */
+    int stream_file(const std::shared_ptr<const FileEntry> &file, size_t start, size_t size, HttpResp *resp,
+                    bool gzip = false)
+    {
+        // 发送完毕前持有缓存项，保证文件描述符有效
+        HttpServerTask *server_task = task_of(resp);
+        server_task->add_callback([file](HttpTask *) {});
+
+        std::string header = stream_header(resp, size, gzip);
+
+        Arena *arena = resp->arena();
+        auto *ctx = arena->create<FileStreamCtx>();
+        ctx->server_task = server_task;
+        ctx->fd = file->fd;
+        ctx->offset = start;
+        ctx->end = start + size;
+        if (gzip)
+        {
+            ctx->gzip = arena->create<GzipStream>(resp->compress_level(size));
+            ctx->in_buf = static_cast<char *>(arena->allocate(FILE_STREAM_CHUNK, 1));
+            ctx->out = arena->create<std::string>(std::move(header));
+            ctx->out->reserve(FILE_STREAM_CHUNK + GzipStream::CHUNK_SIZE);
+
+            server_task->noreply();
+            stream_read(ctx);
+            return StatusOK;
+        }
+
+        ctx->cap = header.size() + FILE_STREAM_CHUNK;
+        ctx->buf = static_cast<char *>(arena->allocate(ctx->cap, 1));
+        memcpy(ctx->buf, header.data(), header.size());
+        ctx->len = header.size();
 
-    // 添加回调函数，用于在任务完成后释放分配的内存
-    server_task->add_callback([buf](HttpTask *server_task)
-                              {
-                                  free(buf); // 释放内存
-                              });
-
-    // 设置响应头中的 Content-Range
-    // https://datatracker.ietf.org/doc/html/rfc7233#section-4.2
-    // Content-Range: bytes 42-1233/1234
-    resp->headers["Content-Range"] = "bytes " + std::to_string(start)
-                                            + "-" + std::to_string(end)
-                                            + "/" + std::to_string(size);
-
-    // 创建异步文件读取任务
-    WFFileIOTask *pread_task = WFTaskFactory::create_pread_task(path,
-                                                                buf,
-                                                                size,
-                                                                static_cast<off_t>(start),
-                                                                pread_callback);
-    pread_task->user_data = resp; // 设置用户数据为 HttpResp 对象
-
-    // 将文件读取任务添加到服务器任务中
-    **server_task << pread_task;
-
-    return StatusOK; // 返回状态码 StatusOK
+        server_task->noreply();
+        stream_read(ctx);
+        return StatusOK;
+    }
+
+    /**
+     * @brief 把文件片段映射到内存后直接作为响应体发送
+     *
+     * 不分配任何堆内存，发送时内核直接从页缓存取数据，同一文件的并发下载共享同一份页缓存。
+     * 映射在任务结束时解除。
+     */
+    int map_file(const std::shared_ptr<const FileEntry> &file, size_t start, size_t size, HttpResp *resp)
+    {
+        static const size_t page_size = sysconf(_SC_PAGESIZE);
+        size_t delta = start % page_size;
+        void *addr = mmap(nullptr, size + delta, PROT_READ, MAP_SHARED, file->fd, start - delta);
+        if (addr == MAP_FAILED)
+            return stream_file(file, start, size, resp);
+
+        madvise(addr, size + delta, MADV_SEQUENTIAL);
+
+        size_t map_size = size + delta;
+        task_of(resp)->add_callback([addr, map_size](HttpTask *)
+        {
+            munmap(addr, map_size);
+        });
+        resp->append_output_body_nocopy(static_cast<char *>(addr) + delta, size);
+        return StatusOK;
+    }
+
+    // 发送文件的 [start, start + size) 片段，状态码和 Content-Range 由调用者设置
+    int send_range(const std::shared_ptr<const FileEntry> &file, size_t start, size_t size, HttpResp *resp)
+    {
+        // 获取当前的 HttpServerTask 对象
+        HttpServerTask *server_task = task_of(resp);
+
+        // 要求压缩时，较大的片段（只能是 gzip）分块读取、压缩并流式发送，较小的片段读入内存后整体压缩
+        Compress method;
+        bool compress = file_encoding(resp, size, &method);
+        if (compress && size >= FILE_MAP_THRESHOLD)
+            return stream_file(file, start, size, resp, true);
+
+        // 较大的片段不再整块读入内存：明文连接直接映射文件，
+        // TLS 连接需要在用户态加密，映射的文件被截断时会触发 SIGBUS，改为分块流式发送
+        if (size >= FILE_MAP_THRESHOLD)
+        {
+            if (server_task->is_ssl())
+                return stream_file(file, start, size, resp);
+            return map_file(file, start, size, resp);
+        }
+
+        if (size == 0)
+            return StatusOK;
+
+        void *buf = malloc(size); // 分配内存用于存储文件片段
+
+        // 添加回调函数，用于在任务完成后释放分配的内存和缓存项的引用
+        server_task->add_callback([buf, file](HttpTask *server_task)
+                                  {
+                                      free(buf); // 释放内存
+                                  });
+
+        // 创建异步文件读取任务，直接使用缓存中已经打开的文件描述符
+        WFFileIOTask *pread_task = WFTaskFactory::create_pread_task(file->fd,
+                                                                    buf,
+                                                                    size,
+                                                                    static_cast<off_t>(start),
+                                                                    compress ? pread_compress_callback : pread_callback);
+        pread_task->user_data = resp; // 设置用户数据为 HttpResp 对象
+
+        // 将文件读取任务添加到服务器任务中
+        **server_task << pread_task;
+
+        return StatusOK; // 返回状态码 StatusOK
+    }
+
+    // 一个 Range 请求最多处理的区间数，超过时忽略 Range 返回整个文件
+    constexpr size_t MAX_RANGES = 16;
+
+    // TLS 连接上多区间响应整块读入内存的上限，超过时忽略 Range 返回整个文件
+    constexpr size_t MULTI_RANGE_BUFFER_MAX = 1024 * 1024;
+
+    // 字节区间 [first, second)
+    using ByteRange = std::pair<size_t, size_t>;
+
+    bool parse_size(const StringPiece &str, size_t *value)
+    {
+        if (str.empty() || str.size() > 19)
+            return false;
+        size_t v = 0;
+        for (const char *p = str.begin(); p != str.end(); p++)
+        {
+            if (*p < '0' || *p > '9')
+                return false;
+            v = v * 10 + (*p - '0');
+        }
+        *value = v;
+        return true;
+    }
+
+    /**
+     * @brief 解析 Range 请求头，如 "bytes=0-499, -500, 9500-"
+     *
+     * @return int 1 表示至少有一个可以满足的区间，0 表示格式不支持（应忽略 Range），-1 表示都无法满足（416）
+     */
+    int parse_range(const StringPiece &value, size_t size, std::vector<ByteRange> *ranges)
+    {
+        StringPiece spec = StrUtil::trim(value);
+        if (!spec.starts_with("bytes="))
+            return 0;
+        spec.remove_prefix(6);
+
+        for (const StringPiece &item : StrUtil::split_piece<StringPiece>(spec, ','))
+        {
+            StringPiece range = StrUtil::trim(item);
+            if (range.empty())
+                continue;
+
+            const char *dash = static_cast<const char *>(memchr(range.data(), '-', range.size()));
+            if (!dash)
+                return 0;
+            StringPiece first(range.data(), dash - range.data());
+            StringPiece last(dash + 1, range.end() - dash - 1);
+
+            size_t start, end;
+            if (first.empty())
+            {
+                // 后缀区间：最后 n 个字节
+                size_t n;
+                if (!parse_size(last, &n))
+                    return 0;
+                if (n == 0 || size == 0)
+                    continue;
+                start = n < size ? size - n : 0;
+                end = size;
+            }
+            else
+            {
+                if (!parse_size(first, &start))
+                    return 0;
+                if (last.empty())
+                    end = size;
+                else
+                {
+                    size_t last_pos;
+                    if (!parse_size(last, &last_pos) || last_pos < start)
+                        return 0;
+                    end = last_pos < size ? last_pos + 1 : size;
+                }
+                if (start >= size)
+                    continue;
+            }
+            ranges->emplace_back(start, end);
+        }
+
+        if (ranges->size() > MAX_RANGES)
+            return 0;
+        return ranges->empty() ? -1 : 1;
+    }
+
+    // If-Range 与当前资源一致时才处理 Range，否则返回整个文件
+    bool if_range_matches(const HttpReq *req, const std::string &etag, time_t mtime)
+    {
+        StringPiece if_range = StrUtil::trim(req->header_view("If-Range"));
+        if (if_range.empty())
+            return true;
+        if (if_range[0] == '"')
+            return if_range == etag;
+        if (if_range.starts_with("W/"))
+            return false;
+
+        time_t date;
+        return HttpHeaderWriter::parse_http_date(if_range, &date) && date == mtime;
+    }
+
+    std::string content_range(size_t start, size_t end, size_t size)
+    {
+        // Content-Range: bytes 42-1233/1234，结束位置包含在内
+        return "bytes " + std::to_string(start) + "-" + std::to_string(end - 1) + "/" + std::to_string(size);
+    }
+
+    /**
+     * @brief 多区间的 multipart/byteranges 响应
+     *
+     * 明文连接把整个文件映射到内存，各部分的头部和文件数据依次不拷贝地追加到响应体；
+     * TLS 连接把所有部分读入一块内存，总大小超过 MULTI_RANGE_BUFFER_MAX 时返回 false。
+     */
+    bool send_multi_range(const std::shared_ptr<const FileEntry> &file,
+                          const std::vector<ByteRange> &ranges, HttpResp *resp)
+    {
+        HttpServerTask *server_task = task_of(resp);
+        bool use_map = !server_task->is_ssl();
+
+        char boundary[32];
+        snprintf(boundary, sizeof boundary, "%016llx",
+                 static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(resp)) ^
+                 static_cast<unsigned long long>(file->mtime.tv_nsec));
+        std::string type = ContentType::to_str(file->content_type);
+
+        // 每个部分的头部，最后一个元素为结束分隔符
+        std::vector<std::string> part_headers;
+        size_t total = 0;
+        for (size_t i = 0; i < ranges.size(); i++)
+        {
+            std::string header;
+            if (i > 0)
+                header.append("\r\n");
+            header.append("--").append(boundary).append("\r\n");
+            header.append("Content-Type: ").append(type).append("\r\n");
+            header.append("Content-Range: ").append(content_range(ranges[i].first, ranges[i].second, file->size));
+            header.append("\r\n\r\n");
+            total += header.size() + ranges[i].second - ranges[i].first;
+            part_headers.emplace_back(std::move(header));
+        }
+        part_headers.emplace_back(std::string("\r\n--") + boundary + "--\r\n");
+        total += part_headers.back().size();
+
+        if (!use_map && total > MULTI_RANGE_BUFFER_MAX)
+            return false;
+
+        Arena *arena = resp->arena();
+        char *map_addr = nullptr;
+        if (use_map)
+        {
+            void *addr = mmap(nullptr, file->size, PROT_READ, MAP_SHARED, file->fd, 0);
+            if (addr == MAP_FAILED)
+            {
+                if (total > MULTI_RANGE_BUFFER_MAX)
+                    return false;
+                use_map = false;
+            }
+            else
+            {
+                map_addr = static_cast<char *>(addr);
+                size_t map_size = file->size;
+                server_task->add_callback([addr, map_size](HttpTask *)
+                {
+                    munmap(addr, map_size);
+                });
+            }
+        }
+
+        resp->set_status(HttpStatusPartialContent);
+        resp->headers["Content-Type"] = std::string("multipart/byteranges; boundary=") + boundary;
+
+        if (use_map)
+        {
+            for (size_t i = 0; i < part_headers.size(); i++)
+            {
+                const std::string &header = part_headers[i];
+                resp->append_output_body_nocopy(arena->copy(header.data(), header.size()), header.size());
+                if (i < ranges.size())
+                    resp->append_output_body_nocopy(map_addr + ranges[i].first,
+                                                    ranges[i].second - ranges[i].first);
+            }
+            return true;
+        }
+
+        // 所有部分依次排列在一块内存中，文件数据由 pread 任务填入对应位置
+        char *buf = static_cast<char *>(arena->allocate(total, 1));
+        char *pos = buf;
+        for (size_t i = 0; i < part_headers.size(); i++)
+        {
+            memcpy(pos, part_headers[i].data(), part_headers[i].size());
+            pos += part_headers[i].size();
+            if (i == ranges.size())
+                break;
+
+            size_t len = ranges[i].second - ranges[i].first;
+            bool last = i + 1 == ranges.size();
+            WFFileIOTask *pread_task = WFTaskFactory::create_pread_task(file->fd, pos, len, ranges[i].first,
+                [resp, buf, total, len, last](WFFileIOTask *task)
+            {
+                // 任何一个部分读取失败都返回错误，全部读完后整块追加到响应体
+                if (task->get_state() != WFT_STATE_SUCCESS || task->get_retval() != static_cast<long>(len))
+                {
+                    if (!resp->get_output_body_size())
+                    {
+                        resp->set_status(HttpStatusOK);
+                        resp->Error(StatusFileReadError);
+                    }
+                    return;
+                }
+                if (last && !resp->get_output_body_size())
+                    resp->append_output_body_nocopy(buf, total);
+            });
+            **server_task << pread_task;
+            pos += len;
+        }
+        server_task->add_callback([file](HttpTask *) {});
+        return true;
+    }
+
+    // 发送整个文件，处理条件请求和 Range 请求
+    int send_whole_file(const std::shared_ptr<const FileEntry> &file, HttpResp *resp)
+    {
+        const HttpReq *req = task_of(resp)->get_req();
+        std::string etag = HttpFile::make_etag(file->ino, file->size, file->mtime);
+        char last_modified[HttpHeaderWriter::HTTP_DATE_LEN];
+        HttpHeaderWriter::format_http_date(file->mtime.tv_sec, last_modified);
+
+        // 压缩后的内容与原文件不同，使用不同的 ETag；压缩内容的长度事先未知，也不支持 Range
+        Compress encoding;
+        bool compress = file_encoding(resp, file->size, &encoding);
+        if (compress)
+            etag.insert(etag.size() - 1, std::string("-") + compress_method_to_str(encoding));
+
+        resp->headers["Content-Type"] = ContentType::to_str(file->content_type);
+        resp->headers["ETag"] = etag;
+        resp->headers["Last-Modified"] = std::string(last_modified, sizeof last_modified);
+        if (!compress)
+            resp->headers["Accept-Ranges"] = "bytes";
+
+        const char *method = req->get_method();
+        bool is_get = strcasecmp(method, "GET") == 0;
+        bool is_head = strcasecmp(method, "HEAD") == 0;
+
+        // 客户端的缓存仍然有效，不读取文件内容
+        // 304 的 Content-Length 必须与完整响应一致，不能由 message_out 补成 0
+        if ((is_get || is_head) && HttpFile::not_modified(req, etag, file->mtime.tv_sec))
+        {
+            resp->set_status(HttpStatusNotModified);
+            if (!compress)
+                resp->headers["Content-Length"] = std::to_string(file->size);
+            return StatusOK;
+        }
+
+        // HEAD 请求只需要响应头
+        if (is_head)
+        {
+            if (!compress)
+                resp->headers["Content-Length"] = std::to_string(file->size);
+            return StatusOK;
+        }
+
+        StringPiece range_header = req->header_view("Range");
+        if (is_get && !compress && !range_header.empty() && if_range_matches(req, etag, file->mtime.tv_sec))
+        {
+            std::vector<ByteRange> ranges;
+            int ret = parse_range(range_header, file->size, &ranges);
+            if (ret < 0)
+            {
+                resp->set_status(HttpStatusRequestedRangeNotSatisfiable);
+                resp->headers["Content-Range"] = "bytes */" + std::to_string(file->size);
+                return StatusOK;
+            }
+
+            if (ret > 0 && ranges.size() == 1)
+            {
+                // 只读取客户端请求的片段
+                resp->set_status(HttpStatusPartialContent);
+                resp->headers["Content-Range"] = content_range(ranges[0].first, ranges[0].second, file->size);
+                return send_range(file, ranges[0].first, ranges[0].second - ranges[0].first, resp);
+            }
+
+            if (ret > 0 && send_multi_range(file, ranges, resp))
+                return StatusOK;
+        }
+
+        return send_range(file, 0, file->size, resp);
+    }
+
+}  // namespace
+
+// note : [start, end)
+int HttpFile::send_file(const std::string &path, size_t file_start, size_t file_end, HttpResp *resp)
+{
+    // 从缓存中获取已打开的文件和元数据，命中时不需要 stat 和 open
+    std::shared_ptr<const FileEntry> file = task_of(resp)->get_server()->get_file_cache().get(path);
+    if (!file)
+    {
+        return StatusNotFound; // 如果文件不存在，返回状态码 StatusNotFound
+    }
+
+    // 发送整个文件时处理条件请求和 Range 请求
+    if (file_start == 0 && file_end == static_cast<size_t>(-1))
+    {
+        return send_whole_file(file, resp);
+    }
+
+    // 初始化文件范围的起始和结束位置，使用 64 位的 off_t，超过 2GB 的文件也不会溢出
+    // 参数是 size_t，负数（从文件末尾算起）按补码传入，转换回有符号数后仍然是负数
+    off_t file_size = static_cast<off_t>(file->size);
+    off_t start = static_cast<off_t>(file_start);
+    off_t end = static_cast<off_t>(file_end);
+
+    // 如果结束位置为 -1 或超过文件大小，设置为文件大小；如果起始位置为负数，计算从文件末尾开始的位置
+    if (end == -1 || end > file_size) end = file_size;
+    if (start < 0) start = file_size + start;
+
+    // 检查文件范围是否有效
+    if (start < 0 || end <= start)
+    {
+        return StatusFileRangeInvalid; // 如果结束位置小于或等于起始位置，返回状态码 StatusFileRangeInvalid
+    }
+
+    // 设置响应头中的 Content-Type（缓存项中已经根据扩展名解析好）
+    resp->headers["Content-Type"] = ContentType::to_str(file->content_type);
+
+    // 处理函数指定的片段就是响应的全部内容，不是对 Range 请求的应答
+    return send_range(file, static_cast<size_t>(start), static_cast<size_t>(end - start), resp);
+}
+
+std::string HttpFile::make_etag(ino_t ino, size_t size, const struct timespec &mtime)
+{
+    char buf[64];
+    int len = snprintf(buf, sizeof buf, "\"%lx-%zx-%lx%09ld\"",
+                       static_cast<unsigned long>(ino), size,
+                       static_cast<unsigned long>(mtime.tv_sec), mtime.tv_nsec);
+    return std::string(buf, len);
+}
+
+bool HttpFile::not_modified(const HttpReq *req, const StringPiece &etag, time_t mtime)
+{
+    // If-None-Match 优先，存在时忽略 If-Modified-Since
+    StringPiece if_none_match = req->header_view("If-None-Match");
+    if (!if_none_match.empty())
+    {
+        // 弱比较：忽略 W/ 前缀
+        StringPiece current = etag;
+        if (current.starts_with("W/"))
+            current.remove_prefix(2);
+        for (const StringPiece &item : StrUtil::split_piece<StringPiece>(if_none_match, ','))
+        {
+            StringPiece tag = StrUtil::trim(item);
+            if (tag.starts_with("W/"))
+                tag.remove_prefix(2);
+            if (tag == "*" || tag == current)
+                return true;
+        }
+        return false;
+    }
+
+    time_t since;
+    StringPiece if_modified_since = req->header_view("If-Modified-Since");
+    if (!if_modified_since.empty() &&
+        HttpHeaderWriter::parse_http_date(StrUtil::trim(if_modified_since), &since))
+        return mtime <= since;
+    return false;
 }
 
 
@@ -169,8 +835,8 @@ void HttpFile::save_file(const std::string &dst_path, const std::string &content
     // 获取当前的 HttpServerTask 对象
     HttpServerTask *server_task = task_of(resp);
 
-    // 创建一个 SaveFileContext 对象，用于保存文件操作的相关信息
-    auto *save_context = new SaveFileContext;
+    // 在内存池中创建一个 SaveFileContext 对象，用于保存文件操作的相关信息，任务结束时随内存池释放
+    auto *save_context = resp->arena()->create<SaveFileContext>();
     save_context->content = content;    // 复制内容
     save_context->notify_msg = notify_msg;  // 复制通知消息
     if (func)
@@ -190,11 +856,6 @@ void HttpFile::save_file(const std::string &dst_path, const std::string &content
     // 将文件写入任务添加到服务器任务中
     **server_task << pwrite_task;
 
-    // 添加回调函数，用于在任务完成后释放 SaveFileContext 对象
-    server_task->add_callback([save_context](HttpTask *) {
-        delete save_context;
-    });
-
     // 设置用户数据为 SaveFileContext 对象
     pwrite_task->user_data = save_context;
 }
@@ -207,8 +868,8 @@ void HttpFile::save_file(const std::string &dst_path, std::string &&content,
     // 获取当前的 HttpServerTask 对象
     HttpServerTask *server_task = task_of(resp);
 
-    // 创建一个 SaveFileContext 对象，用于保存文件操作的相关信息
-    auto *save_context = new SaveFileContext;
+    // 在内存池中创建一个 SaveFileContext 对象，用于保存文件操作的相关信息，任务结束时随内存池释放
+    auto *save_context = resp->arena()->create<SaveFileContext>();
     save_context->content = std::move(content); // 使用右值引用移动内容，避免拷贝
     save_context->notify_msg = std::move(notify_msg); // 使用右值引用移动通知消息，避免拷贝
     if (func)
@@ -228,11 +889,6 @@ void HttpFile::save_file(const std::string &dst_path, std::string &&content,
     // 将文件写入任务添加到服务器任务中
     **server_task << pwrite_task;
 
-    // 添加回调函数，用于在任务完成后释放 SaveFileContext 对象
-    server_task->add_callback([save_context](HttpTask *) {
-        delete save_context;
-    });
-
     // 设置用户数据为 SaveFileContext 对象
     pwrite_task->user_data = save_context;
 }
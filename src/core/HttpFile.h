@@ -1,12 +1,17 @@
 #ifndef YUKINO_HTTPFILE_H_
 #define YUKINO_HTTPFILE_H_
 
+#include <sys/types.h>
+#include <ctime>
 #include <string>
 #include <vector>
 #include <functional>
 
+#include "StringPiece.h"
+
 namespace Yukino
 {
+    class HttpReq; // 前向声明 HttpReq 类，表示 HTTP 请求对象
     class HttpResp; // 前向声明 HttpResp 类，表示 HTTP 响应对象
 
     class HttpFile
@@ -17,6 +22,8 @@ namespace Yukino
 
     public:
         // 发送文件内容到 HTTP 响应中
+        // 发送整个文件时（start 为 0，end 为 -1）会带上 ETag 和 Last-Modified，
+        // 并处理请求中的 If-None-Match、If-Modified-Since（304）以及 Range、If-Range（206、416）
         // 参数：
         // - path: 文件路径
         // - start: 发送文件内容的起始位置
@@ -25,6 +32,16 @@ namespace Yukino
         // 返回值：操作结果，成功返回 0，失败返回其他值
         static int send_file(const std::string &path, size_t start, size_t end, HttpResp *resp);
 
+        // 根据文件的 inode、大小和修改时间生成 ETag（带引号）
+        static std::string make_etag(ino_t ino, size_t size, const struct timespec &mtime);
+
+        // 检查请求的 If-None-Match 和 If-Modified-Since，资源没有变化（应返回 304）时返回 true
+        // 参数：
+        // - req: HTTP 请求对象
+        // - etag: 资源当前的 ETag
+        // - mtime: 资源的最后修改时间
+        static bool not_modified(const HttpReq *req, const StringPiece &etag, time_t mtime);
+
         // 保存内容到文件中，并将结果反馈到 HTTP 响应对象
         // 参数：
         // - dst_path: 目标文件路径
@@ -0,0 +1,115 @@
+#include <strings.h>
+
+#include "HttpHeaderIndex.h"
+
+using namespace Yukino;
+
+// 忽略大小写比较两个等长的名字
+static inline bool name_equal(const StringPiece &name, const char *known, size_t len)
+{
+    return name.size() == len && strncasecmp(name.data(), known, len) == 0;
+}
+
+KnownHeader HttpHeaderIndex::to_known(const StringPiece &name)
+{
+    // 先按长度分派，每个长度最多只需要比较两次
+    switch (name.size())
+    {
+    case 4:
+        if (name_equal(name, "Host", 4))
+            return HEADER_HOST;
+        break;
+    case 6:
+        if (name_equal(name, "Cookie", 6))
+            return HEADER_COOKIE;
+        break;
+    case 10:
+        if (name_equal(name, "Connection", 10))
+            return HEADER_CONNECTION;
+        if (name_equal(name, "Keep-Alive", 10))
+            return HEADER_KEEP_ALIVE;
+        break;
+    case 12:
+        if (name_equal(name, "Content-Type", 12))
+            return HEADER_CONTENT_TYPE;
+        break;
+    case 16:
+        if (name_equal(name, "Content-Encoding", 16))
+            return HEADER_CONTENT_ENCODING;
+        break;
+    default:
+        break;
+    }
+    return HEADER_UNKNOWN;
+}
+
+void HttpHeaderIndex::build(const http_parser_t *parser)
+{
+    if (built_)
+        return;
+
+    for (int i = 0; i < HEADER_KNOWN_MAX; i++)
+        known_[i] = -1;
+
+    // 请求被移出（如转发给上游期间）时没有解析器，按没有请求头处理，
+    // 不标记为已构建，请求移回后再查询时重新构建
+    if (!parser)
+        return;
+
+    // 大多数请求的头部都在十几个以内，预留一次即可
+    entries_.reserve(16);
+
+    http_header_cursor_t cursor;
+    const void *name;
+    size_t name_len;
+    const void *value;
+    size_t value_len;
+
+    http_header_cursor_init(&cursor, parser);
+    // 遍历所有请求头，只记录指向解析缓冲区的位置
+    while (http_header_cursor_next(&name, &name_len, &value, &value_len, &cursor) == 0)
+    {
+        entries_.emplace_back();
+        Entry &entry = entries_.back();
+        entry.name = StringPiece(name, name_len);
+        entry.value.set(StringPiece(value, value_len));
+
+        KnownHeader known = to_known(entry.name);
+        if (known != HEADER_UNKNOWN && known_[known] < 0)
+            known_[known] = static_cast<int>(entries_.size() - 1);
+    }
+    http_header_cursor_deinit(&cursor);
+
+    built_ = true;
+}
+
+StringPiece HttpHeaderIndex::scan(const http_parser_t *parser, const StringPiece &name)
+{
+    http_header_cursor_t cursor;
+    const void *value;
+    size_t value_len;
+    StringPiece result;
+
+    if (!parser)
+        return result;
+
+    http_header_cursor_init(&cursor, parser);
+    if (http_header_cursor_find(name.data(), name.size(), &value, &value_len, &cursor) == 0)
+        result = StringPiece(value, value_len);
+    http_header_cursor_deinit(&cursor);
+    return result;
+}
+
+const HttpHeaderIndex::Entry *HttpHeaderIndex::find(const StringPiece &name) const
+{
+    KnownHeader known = to_known(name);
+    if (known != HEADER_UNKNOWN)
+        return find(known);
+
+    for (const Entry &entry : entries_)
+    {
+        if (name_equal(entry.name, name.data(), name.size()))
+            return &entry;
+    }
+    return nullptr;
+}
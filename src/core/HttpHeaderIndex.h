@@ -0,0 +1,80 @@
+#ifndef YUKINO_HTTPHEADERINDEX_H_
+#define YUKINO_HTTPHEADERINDEX_H_
+
+#include "workflow/http_parser.h"
+
+#include <vector>
+
+#include "StringPiece.h"
+#include "LazyString.h"
+
+namespace Yukino
+{
+
+// 常用请求头，在索引中拥有固定槽位，查找为 O(1)
+enum KnownHeader
+{
+    HEADER_HOST = 0,
+    HEADER_CONTENT_TYPE,
+    HEADER_CONTENT_ENCODING,
+    HEADER_COOKIE,
+    HEADER_CONNECTION,
+    HEADER_KEEP_ALIVE,
+    HEADER_KNOWN_MAX,      // 常用请求头数量
+    HEADER_UNKNOWN = -1,   // 不是常用请求头
+};
+
+/**
+ * @brief 请求头索引
+ *
+ * 名字和值都是指向 workflow 解析缓冲区的 StringPiece，不拷贝任何内容。
+ * 索引在第一次查询时才构建，常用请求头记录在固定槽位中，
+ * 其他请求头按出现顺序线性存放，查找时忽略大小写。
+ * 同名请求头出现多次时，查找结果为第一次出现的值。
+ */
+class HttpHeaderIndex
+{
+public:
+    struct Entry
+    {
+        StringPiece name;  // 请求头名字
+        LazyString value;  // 请求头的值，首次以 std::string 访问时才拷贝
+    };
+
+    // 根据解析器中的请求头构建索引，重复调用不会重复构建；parser 为 NULL 时索引为空
+    void build(const http_parser_t *parser);
+
+    // 是否已经构建
+    bool built() const
+    { return built_; }
+
+    // 清空索引，下次查询时重新构建
+    void reset()
+    {
+        entries_.clear();
+        built_ = false;
+    }
+
+    // 查找请求头（忽略大小写），不存在时返回 nullptr
+    const Entry *find(const StringPiece &name) const;
+
+    // 按常用请求头槽位查找，不存在时返回 nullptr
+    const Entry *find(KnownHeader header) const
+    { return known_[header] < 0 ? nullptr : &entries_[known_[header]]; }
+
+    // 判断请求头名字是否是常用请求头
+    static KnownHeader to_known(const StringPiece &name);
+
+    // 不构建索引，直接在解析器中查找第一个同名请求头（忽略大小写），不存在时返回空
+    // 用于每个请求都要读取、但只读取一次的请求头（如 Host）
+    static StringPiece scan(const http_parser_t *parser, const StringPiece &name);
+
+private:
+    std::vector<Entry> entries_;          // 所有请求头，按出现顺序存放
+    int known_[HEADER_KNOWN_MAX];         // 常用请求头在 entries_ 中的下标，-1 表示不存在
+    bool built_ = false;                  // 是否已经构建
+};
+
+}  // namespace Yukino
+
+#endif // YUKINO_HTTPHEADERINDEX_H_
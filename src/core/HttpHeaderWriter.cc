@@ -0,0 +1,121 @@
+#include <strings.h>
+
+#include "HttpHeaderWriter.h"
+
+using namespace Yukino;
+
+void RouteHeaders::set(const std::string &name, const std::string &value)
+{
+    // 先去掉已有的同名响应头，再追加到末尾
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (strcasecmp(names[i].c_str(), name.c_str()) == 0)
+        {
+            size_t len = offsets[i + 1] - offsets[i];
+            block.erase(offsets[i], len);
+            names.erase(names.begin() + i);
+            offsets.erase(offsets.begin() + i);
+            for (size_t j = i; j < offsets.size(); j++)
+                offsets[j] -= len;
+            break;
+        }
+    }
+
+    if (offsets.empty())
+        offsets.push_back(0);
+
+    size_t pos = block.size();
+    block.resize(pos + HttpHeaderWriter::line_size(name, value));
+    HttpHeaderWriter::write_line(&block[pos], name, value);
+    names.push_back(name);
+    offsets.push_back(block.size());
+}
+
+void HttpHeaderWriter::format_http_date(time_t t, char *buf)
+{
+    static const char days[7][4] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+    static const char months[12][4] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+    struct tm tm;
+    gmtime_r(&t, &tm);
+
+    auto put2 = [](char *p, int v) {
+        p[0] = static_cast<char>('0' + v / 10);
+        p[1] = static_cast<char>('0' + v % 10);
+    };
+
+    // Sun, 06 Nov 1994 08:49:37 GMT
+    memcpy(buf, days[tm.tm_wday], 3);
+    buf[3] = ',';
+    buf[4] = ' ';
+    put2(buf + 5, tm.tm_mday);
+    buf[7] = ' ';
+    memcpy(buf + 8, months[tm.tm_mon], 3);
+    buf[11] = ' ';
+    int year = tm.tm_year + 1900;
+    put2(buf + 12, year / 100 % 100);
+    put2(buf + 14, year % 100);
+    buf[16] = ' ';
+    put2(buf + 17, tm.tm_hour);
+    buf[19] = ':';
+    put2(buf + 20, tm.tm_min);
+    buf[22] = ':';
+    put2(buf + 23, tm.tm_sec);
+    memcpy(buf + 25, " GMT", 4);
+}
+
+bool HttpHeaderWriter::parse_http_date(const StringPiece &str, time_t *t)
+{
+    static const char months[12][4] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                        "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+    // Sun, 06 Nov 1994 08:49:37 GMT
+    if (str.size() != HTTP_DATE_LEN || str[3] != ',' || memcmp(str.data() + 25, " GMT", 4) != 0)
+        return false;
+
+    auto get2 = [&str](int pos, int *v) {
+        char a = str[pos];
+        char b = str[pos + 1];
+        if (a < '0' || a > '9' || b < '0' || b > '9')
+            return false;
+        *v = (a - '0') * 10 + (b - '0');
+        return true;
+    };
+
+    struct tm tm;
+    memset(&tm, 0, sizeof tm);
+    int century, year;
+    if (!get2(5, &tm.tm_mday) || !get2(12, &century) || !get2(14, &year) ||
+        !get2(17, &tm.tm_hour) || !get2(20, &tm.tm_min) || !get2(23, &tm.tm_sec))
+        return false;
+
+    tm.tm_mon = -1;
+    for (int i = 0; i < 12; i++)
+    {
+        if (memcmp(str.data() + 8, months[i], 3) == 0)
+        {
+            tm.tm_mon = i;
+            break;
+        }
+    }
+    if (tm.tm_mon < 0)
+        return false;
+
+    tm.tm_year = century * 100 + year - 1900;
+    *t = timegm(&tm);
+    return true;
+}
+
+StringPiece HttpHeaderWriter::http_date()
+{
+    // 每个线程一份缓存，秒数变化时才重新格式化，不需要加锁
+    static thread_local time_t cached_sec = -1;
+    static thread_local char cached_date[HTTP_DATE_LEN];
+
+    time_t now = time(nullptr);
+    if (now != cached_sec)
+    {
+        format_http_date(now, cached_date);
+        cached_sec = now;
+    }
+    return StringPiece(cached_date, HTTP_DATE_LEN);
+}
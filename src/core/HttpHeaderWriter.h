@@ -0,0 +1,74 @@
+#ifndef YUKINO_HTTPHEADERWRITER_H_
+#define YUKINO_HTTPHEADERWRITER_H_
+
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "StringPiece.h"
+
+namespace Yukino
+{
+
+/**
+ * @brief 路由的静态响应头
+ *
+ * 注册路由时就序列化为 "Name: value\r\n" 形式，发送响应时整块拷贝。
+ * 响应中已经设置了同名响应头时，以响应中的为准。
+ */
+struct RouteHeaders
+{
+    std::vector<std::string> names;  // 响应头名字
+    std::vector<size_t> offsets;     // 每个响应头在 block 中的起始位置，最后一个元素为 block 的长度
+    std::string block;               // 序列化后的响应头
+
+    // 追加一个响应头，同名响应头以后设置的为准
+    void set(const std::string &name, const std::string &value);
+
+    bool empty() const
+    { return names.empty(); }
+};
+
+/**
+ * @brief 响应头序列化工具
+ *
+ * 先统计所有响应头序列化后的总长度，再一次性写入一块连续的内存，
+ * 发送时整块作为一个 iovec 交给 workflow，不再逐个调用 add_header。
+ */
+class HttpHeaderWriter
+{
+public:
+    static constexpr size_t HTTP_DATE_LEN = 29; // "Sun, 06 Nov 1994 08:49:37 GMT" 的长度
+
+    // 一行响应头序列化后的长度
+    static size_t line_size(const StringPiece &name, const StringPiece &value)
+    { return name.size() + value.size() + 4; }
+
+    // 将一行响应头写入 buf，返回写入后的位置
+    static char *write_line(char *buf, const StringPiece &name, const StringPiece &value)
+    {
+        memcpy(buf, name.data(), name.size());
+        buf += name.size();
+        *buf++ = ':';
+        *buf++ = ' ';
+        memcpy(buf, value.data(), value.size());
+        buf += value.size();
+        *buf++ = '\r';
+        *buf++ = '\n';
+        return buf;
+    }
+
+    // 当前时间的 Date 响应头的值，每个线程每秒最多格式化一次
+    static StringPiece http_date();
+
+    // 按 RFC 7231 的 IMF-fixdate 格式化时间，buf 至少 HTTP_DATE_LEN 字节
+    static void format_http_date(time_t t, char *buf);
+
+    // 解析 IMF-fixdate 格式的时间（如 If-Modified-Since），格式不正确时返回 false
+    static bool parse_http_date(const StringPiece &str, time_t *t);
+};
+
+}  // namespace Yukino
+
+#endif // YUKINO_HTTPHEADERWRITER_H_
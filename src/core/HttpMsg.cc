@@ -6,6 +6,10 @@
 
 #include <unistd.h>
 #include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <stdexcept>
+#include <strings.h>
 
 #include "HttpMsg.h"
 #include "UriUtil.h"
@@ -14,7 +18,13 @@
 #include "ErrorCode.h"
 #include "FileUtil.h"
 #include "HttpServerTask.h"
+#include "HttpServer.h"
 #include "CodeUtil.h"
+#include "StrUtil.h"
+#include "Router.h"
+#include "ContentEncoding.h"
+#include "RedisUpstream.h"
+#include "MySQLUpstream.h"
 #include "spdlog/spdlog.h" 
 
 using namespace protocol;
@@ -26,6 +36,7 @@ namespace Yukino
 struct ReqData
 {
     std::string body; // 请求体内容
+    int body_status = StatusOK; // 请求体解压超过上限时为 StatusUncompressTooLarge
     std::map<std::string, std::string> form_kv; // 表单数据的键值对
     Form form; // 表单对象
     Json json; // JSON 数据
@@ -54,6 +65,10 @@ void proxy_http_callback(WFHttpTask *http_task)
     HttpResponse *http_resp = http_task->get_resp();
     HttpResp *server_resp = server_task->get_resp();
 
+    // 先将请求对象移回服务器任务，之后生成响应时（如协商压缩）需要读取请求头
+    auto *server_req = static_cast<HttpRequest *>(server_task->get_req());
+    *server_req = std::move(*http_task->get_req());
+
     // 如果服务器关闭了连接，将状态设置为成功
     if (state == WFT_STATE_SYS_ERROR && error == ECONNRESET)
         state = WFT_STATE_SUCCESS;
@@ -122,33 +137,24 @@ void proxy_http_callback(WFHttpTask *http_task)
         server_resp->Error(StatusProxyError, errmsg);
     }
 
-    // 添加回调函数，用于在任务完成后释放代理上下文
-    server_task->add_callback([proxy_ctx](HttpTask *server_task)
-    {
-        delete proxy_ctx;
-    });
-
-    // 将请求对象移回服务器任务
-    auto *server_req = static_cast<HttpRequest *>(server_task->get_req());
-    *server_req = std::move(*http_task->get_req());
 }
 
-Yukino::Json mysql_concat_json_res(WFMySQLTask *mysql_task)
+// 将 MySQL 任务的结果转换为 JSON，state 和 error 为任务的状态和错误码
+Yukino::Json mysql_json_res(int state, int error, MySQLResponse *mysql_resp)
 {
     Yukino::Json json; // 创建一个 JSON 对象，用于存储最终结果
-    MySQLResponse *mysql_resp = mysql_task->get_resp(); // 获取 MySQL 响应对象
-    MySQLResultCursor cursor(mysql_resp); // 创建一个 MySQL 结果游标
-    const MySQLField *const *fields; // 用于存储字段信息
-    std::vector<MySQLCell> arr; // 用于存储行数据
 
     // 如果任务失败，返回错误信息
-    if (mysql_task->get_state() != WFT_STATE_SUCCESS)
+    if (state != WFT_STATE_SUCCESS)
     {
-        json["error"] = WFGlobal::get_error_string(mysql_task->get_state(),
-                                                   mysql_task->get_error());
+        json["error"] = WFGlobal::get_error_string(state, error);
         return json;
     }
 
+    MySQLResultCursor cursor(mysql_resp); // 创建一个 MySQL 结果游标
+    const MySQLField *const *fields; // 用于存储字段信息
+    std::vector<MySQLCell> arr; // 用于存储行数据
+
     // 遍历所有结果集
     do {
         Yukino::Json result_set; // 创建一个 JSON 对象，用于存储当前结果集
@@ -234,20 +240,25 @@ Yukino::Json mysql_concat_json_res(WFMySQLTask *mysql_task)
     // 如果 MySQL 响应是错误包
     if (mysql_resp->get_packet_type() == MYSQL_PACKET_ERROR)
     {
-        json["errcode"] = mysql_task->get_resp()->get_error_code(); // 错误代码
-        json["errmsg"] = mysql_task->get_resp()->get_error_msg(); // 错误消息
+        json["errcode"] = mysql_resp->get_error_code(); // 错误代码
+        json["errmsg"] = mysql_resp->get_error_msg(); // 错误消息
     }
     else if (mysql_resp->get_packet_type() == MYSQL_PACKET_OK)
     {
         json["status"] = "OK"; // 状态
-        json["affected_rows"] = mysql_task->get_resp()->get_affected_rows(); // 影响的行数
-        json["warnings"] = mysql_task->get_resp()->get_warnings(); // 警告数量
-        json["insert_id"] = mysql_task->get_resp()->get_last_insert_id(); // 插入的 ID
-        json["info"] = mysql_task->get_resp()->get_info(); // 附加信息
+        json["affected_rows"] = mysql_resp->get_affected_rows(); // 影响的行数
+        json["warnings"] = mysql_resp->get_warnings(); // 警告数量
+        json["insert_id"] = mysql_resp->get_last_insert_id(); // 插入的 ID
+        json["info"] = mysql_resp->get_info(); // 附加信息
     }
     return json; // 返回最终结果
 }
 
+Yukino::Json mysql_concat_json_res(WFMySQLTask *mysql_task)
+{
+    return mysql_json_res(mysql_task->get_state(), mysql_task->get_error(), mysql_task->get_resp());
+}
+
 Yukino::Json redis_json_res(WFRedisTask *redis_task)
 {
     // 获取 Redis 请求和响应对象
@@ -322,106 +333,374 @@ Yukino::Json redis_json_res(WFRedisTask *redis_task)
     return js; // 返回最终结果
 }
 
-// MySQL 任务完成后的回调函数
-void mysql_callback(WFMySQLTask *mysql_task)
+// 在内存池中构造一个 chunked 编码的数据块：长度（十六进制）\r\n 数据 \r\n
+static StringPiece make_chunk(Arena *arena, const char *data, size_t len)
+{
+    char head[24];
+    int head_len = snprintf(head, sizeof head, "%zx\r\n", len);
+    char *chunk = static_cast<char *>(arena->allocate(head_len + len + 2, 1));
+    memcpy(chunk, head, head_len);
+    memcpy(chunk + head_len, data, len);
+    memcpy(chunk + head_len + len, "\r\n", 2);
+    return StringPiece(chunk, head_len + len + 2);
+}
+
+// 分块生成的响应体：只有一块时与 HttpResp::String 相同；有多块时需要 gzip 则逐块压缩并以 chunked 编码发送，
+// 其他压缩方法需要完整的数据，拼接后在最后一块一起压缩；不压缩时每块移动到内存池中直接发送
+class BlockBody : public Noncopyable
 {
-    // 将 MySQL 查询结果转换为 JSON 格式
-    Yukino::Json json = mysql_concat_json_res(mysql_task);
+public:
+    explicit BlockBody(HttpResp *resp) : resp_(resp)
+    {}
+
+    void append(std::string *block, bool last)
+    {
+        if (!started_)
+        {
+            if (last)
+            {
+                resp_->String(std::move(*block));
+                return;
+            }
+            start(block->size());
+        }
+
+        if (gzip_)
+            append_gzip(block, last);
+        else if (pending_)
+            append_pending(block, last);
+        else
+            append_plain(block);
+    }
 
+private:
+    void start(size_t size)
+    {
+        started_ = true;
+        negotiated_ = resp_->headers.find("Content-Encoding") == resp_->headers.end();
+        if (!resp_->negotiate_compress(size, &method_))
+            return;
+
+        if (method_ == Compress::GZIP)
+        {
+            // 输出第一块压缩数据时再改用 chunked 编码
+            gzip_.reset(new GzipStream(resp_->compress_level(size)));
+        }
+        else
+        {
+            pending_ = resp_->arena()->create<std::string>();
+            // 压缩成功后再设置 Content-Encoding，失败时按原始数据发送
+            if (negotiated_)
+                resp_->headers.erase("Content-Encoding");
+        }
+    }
+
+    void append_plain(std::string *block)
+    {
+        auto *data = resp_->arena()->create<std::string>(std::move(*block));
+        resp_->append_output_body_nocopy(data->c_str(), data->size());
+    }
+
+    void append_gzip(std::string *block, bool last)
+    {
+        Arena *arena = resp_->arena();
+        HttpResp *resp = resp_;
+        bool *emitted = &emitted_;
+        int status = gzip_->update(block->c_str(), block->size(), last,
+                                   [arena, resp, emitted](const char *out, size_t out_len)
+        {
+            StringPiece chunk = make_chunk(arena, out, out_len);
+            resp->open_chunked_body();
+            resp->append_output_body_nocopy(chunk.data(), chunk.size());
+            *emitted = true;
+        });
+
+        if (status != StatusOK && !emitted_)
+        {
+            // 压缩流初始化失败，还没有输出任何数据时改为发送原始数据
+            gzip_.reset();
+            if (negotiated_)
+                resp_->headers.erase("Content-Encoding");
+            append_plain(block);
+        }
+        // chunked 编码的结束标记在发送响应前由 HttpServerTask::message_out 追加
+    }
+
+    void append_pending(std::string *block, bool last)
+    {
+        pending_->append(*block);
+        if (!last)
+            return;
+
+        if (resp_->append_compressed(method_, pending_->c_str(), pending_->size()) == StatusOK)
+            resp_->headers["Content-Encoding"] = compress_method_to_str(method_);
+        else
+            resp_->append_output_body_nocopy(pending_->c_str(), pending_->size());
+    }
+
+private:
+    HttpResp *resp_;
+    bool started_ = false;
+    bool negotiated_ = false;  // 压缩方法是否由 Accept-Encoding 协商得到
+    bool emitted_ = false;     // 是否已经输出过压缩数据
+    Compress method_;
+    std::unique_ptr<GzipStream> gzip_;
+    std::string *pending_ = nullptr;  // 非 gzip 压缩时拼接的完整数据（位于内存池中）
+};
+
+// MySQL 任务完成后的回调函数，按 encoding 指定的格式输出查询结果
+void mysql_callback(WFMySQLTask *mysql_task, MySQLEncoding encoding)
+{
     // 从 mysql_task 的 user_data 中获取 HttpResp 对象
     auto *server_resp = static_cast<HttpResp *>(mysql_task->user_data);
 
-    // 将 JSON 数据作为字符串发送到 HTTP 响应中
-    server_resp->String(json.dump());
+    if (encoding == MySQLEncoding::ROWS && mysql_task->get_state() != WFT_STATE_SUCCESS)
+    {
+        server_resp->String(mysql_concat_json_res(mysql_task).dump());
+        return;
+    }
+
+    // 查询结果直接序列化，不构建 Json 对象，每攒够一块就追加到响应体中
+    BlockBody body(server_resp);
+    auto flush = [&body](std::string *block, bool last)
+    {
+        body.append(block, last);
+    };
+
+    if (encoding == MySQLEncoding::ROWS)
+    {
+        MySQLJsonWriter writer(flush);
+        writer.write(mysql_task->get_resp());
+        return;
+    }
+
+    bool msgpack = encoding == MySQLEncoding::MSGPACK;
+    server_resp->headers["Content-Type"] = msgpack ? "application/msgpack" : "application/json";
+    MySQLColumnWriter writer(msgpack, flush);
+    if (mysql_task->get_state() != WFT_STATE_SUCCESS)
+        writer.write_error(WFGlobal::get_error_string(mysql_task->get_state(), mysql_task->get_error()));
+    else
+        writer.write(mysql_task->get_resp());
 }
 
 // HttpReq 类的构造函数
-HttpReq::HttpReq() : req_data_(new ReqData)
+HttpReq::HttpReq()
 {
-    // 构造函数中初始化 req_data_，分配一个新的 ReqData 对象
+    // 请求数据在首次访问时才创建，大部分请求不会访问请求体
 }
 
 // HttpReq 类的析构函数
 HttpReq::~HttpReq()
 {
-    // 析构函数中释放 req_data_ 所指向的 ReqData 对象
-    delete req_data_;
+    // 内存池中的请求数据在任务结束时统一释放，这里只释放自己申请的
+    release_req_data();
+}
+
+// 获取请求数据，属于服务器任务的请求从内存池中分配
+ReqData *HttpReq::req_data() const
+{
+    if (!req_data_)
+    {
+        if (arena_)
+        {
+            req_data_ = arena_->create<ReqData>();
+            req_data_in_arena_ = true;
+        }
+        else
+        {
+            req_data_ = new ReqData;
+            req_data_in_arena_ = false;
+        }
+    }
+    return req_data_;
+}
+
+// 释放不属于内存池的请求数据
+void HttpReq::release_req_data()
+{
+    if (req_data_ && !req_data_in_arena_)
+        delete req_data_;
+    req_data_ = nullptr;
+    req_data_in_arena_ = false;
+}
+
+// 接收网络数据，开启了流式请求体时绕过解析器的缓存
+int HttpReq::append(const void *buf, size_t *size)
+{
+    if (body_stream_)
+    {
+        size_t consumed = 0;
+        int ret = body_stream_->feed(static_cast<const char *>(buf), *size, &consumed);
+        *size = consumed;
+        if (ret > 0)
+            this->parser->complete = 1;
+        return ret;
+    }
+
+    int ret = HttpRequest::append(buf, size);
+    if (ret < 0 || stream_checked_ || !stream_router_ || !http_parser_header_complete(this->parser))
+        return ret;
+
+    stream_checked_ = true;
+    init_body_stream();
+    if (!body_stream_)
+        return ret;
+
+    // 解析器已经缓存的请求体数据交给 BodyStream，然后从解析缓冲区中去掉
+    http_parser_t *parser = this->parser;
+    const char *body = static_cast<const char *>(parser->msgbuf) + parser->header_offset;
+    size_t len = parser->msgsize - parser->header_offset;
+    parser->msgsize = parser->header_offset;
+
+    size_t consumed = 0;
+    int stream_ret = body_stream_->feed(body, len, &consumed);
+    if (stream_ret < 0)
+        return -1;
+
+    if (stream_ret > 0 || ret > 0)
+    {
+        parser->complete = 1;
+        return 1;
+    }
+    return 0;
+}
+
+// 根据请求行中的路径查找路由的流式请求体配置
+void HttpReq::init_body_stream()
+{
+    const http_parser_t *parser = this->parser;
+    if (!arena_ || (!parser->chunked && parser->content_length == 0))
+        return;
+
+    // 去掉绝对 URI 中的协议和主机部分，以及查询字符串和片段
+    const char *uri = http_parser_get_uri(parser);
+    if (!uri)
+        return;
+    if (strncasecmp(uri, "http://", 7) == 0 || strncasecmp(uri, "https://", 8) == 0)
+    {
+        uri = strchr(strstr(uri, "://") + 3, '/');
+        if (!uri)
+            uri = "/";
+    }
+    size_t len = strcspn(uri, "?#");
+
+    // 与 HttpServer::process 一样规范化路径后再匹配路由
+    char *path = static_cast<char *>(arena_->allocate(CodeUtil::normalize_path_bound(len), 1));
+    StringPiece route(path, CodeUtil::normalize_path(uri, len, path));
+
+    const BodyStreamOptions *options = stream_router_->find_body_stream(route);
+    if (options)
+        body_stream_ = arena_->create<BodyStream>(options, this, parser->chunked != 0, parser->content_length);
 }
 
 // 获取 HTTP 请求体内容
 std::string &HttpReq::body() const
 {
-    // 如果请求体内容为空，则进行解码和解压处理
-    if (req_data_->body.empty())
+    ReqData *data = req_data();
+
+    // 流式请求体已经交给路由的回调或文件，不再缓存
+    if (body_stream_)
+        return data->body;
+
+    // 如果请求体内容为空，则进行解码和解压处理（解压超过上限时不再重复尝试）
+    if (data->body.empty() && data->body_status == StatusOK)
     {
         // 解码分块传输编码的请求体内容
         std::string content = protocol::HttpUtil::decode_chunked_body(this);
 
         // 获取请求头中的 Content-Encoding 字段
-        const std::string &header = this->header("Content-Encoding");
+        StringPiece encoding = StrUtil::trim(this->header_view("Content-Encoding"));
 
         // 初始化状态码为成功
         int status = StatusOK;
 
-        // 检查是否为 gzip 压缩的请求体
-        if (header.find("gzip") != std::string::npos)
+        // 按 Content-Encoding 解压请求体，支持 gzip、br、zstd，以及 deflate（zlib 格式，由 ungzip 自动识别）
+        // 解压结果受大小和压缩比的上限约束（HttpServer::decompress_limit），超过时立即停止
+        static const ContentEncoding default_encoding{};
+        const ContentEncoding &encoding = content_encoding_ ? *content_encoding_ : default_encoding;
+        size_t max_size = encoding.decompress_limit(content.size());
+        Compress method;
+        if (compress_method_from_str(encoding, &method))
         {
-            // 尝试解压 gzip 压缩的请求体
-            status = Compressor::ungzip(&content, &req_data_->body);
+            status = Compressor::uncompress(method, content.data(), content.size(), &data->body, max_size);
+        }
+        else if (encoding.size() == 7 && strncasecmp(encoding.data(), "deflate", 7) == 0)
+        {
+            status = Compressor::ungzip(content.data(), content.size(), &data->body, max_size);
         }
         else
         {
-            // 如果不是 gzip 压缩，设置状态码为未压缩
+            // 如果没有压缩或编码无法识别，设置状态码为未压缩
             status = StatusNoUncomrpess;
         }
 
+        if (status == StatusUncompressTooLarge)
+        {
+            // 丢弃请求体，响应在发送前改为 413（见 HttpServerTask::message_out）
+            spdlog::warn("[YUKINO] Request body of {} bytes exceeds the decompress limit of {} bytes",
+                         content.size(), max_size);
+            data->body.clear();
+            data->body_status = status;
+        }
         // 如果解压失败，则直接使用原始内容
-        if(status != StatusOK)
+        else if(status != StatusOK)
         {
-            req_data_->body = std::move(content);
+            data->body = std::move(content);
         }
     }
     // 返回请求体内容
-    return req_data_->body;
+    return data->body;
+}
+
+// 请求体解压后是否超过了上限
+bool HttpReq::body_too_large() const
+{
+    return req_data_ && req_data_->body_status == StatusUncompressTooLarge;
 }
 
 // 获取 HTTP 请求的表单键值对
 std::map<std::string, std::string> &HttpReq::form_kv() const
 {
+    ReqData *data = req_data();
+
     // 如果请求的内容类型为 application/x-www-form-urlencoded 且表单键值对为空，则解析表单数据
-    if (content_type_ == APPLICATION_URLENCODED && req_data_->form_kv.empty())
+    if (content_type() == APPLICATION_URLENCODED && data->form_kv.empty())
     {
         // 获取请求体内容
         StringPiece body_piece(this->body());
 
         // 解析表单数据为键值对
-        req_data_->form_kv = Urlencode::parse_post_kv(body_piece);
+        data->form_kv = Urlencode::parse_post_kv(body_piece);
     }
     // 返回表单键值对
-    return req_data_->form_kv;
+    return data->form_kv;
 }
 
 // 获取 HTTP 请求的表单对象
 Form &HttpReq::form() const
 {
+    ReqData *data = req_data();
+
     // 如果请求的内容类型为 multipart/form-data 且表单对象为空，则解析表单数据
-    if (content_type_ == MULTIPART_FORM_DATA && req_data_->form.empty())
+    if (content_type() == MULTIPART_FORM_DATA && data->form.empty())
     {
         // 获取请求体内容
         StringPiece body_piece(this->body());
 
         // 解析表单数据为表单对象
-        req_data_->form = multi_part_.parse_multipart(body_piece);
+        data->form = multi_part_.parse_multipart(body_piece);
     }
     // 返回表单对象
-    return req_data_->form;
+    return data->form;
 }
 
 // 获取 HTTP 请求中的 JSON 数据
 Yukino::Json &HttpReq::json() const
 {
+    ReqData *data = req_data();
+
     // 如果请求的内容类型是 JSON 且 JSON 数据为空
-    if (content_type_ == APPLICATION_JSON && req_data_->json.empty())
+    if (content_type() == APPLICATION_JSON && data->json.empty())
     {
         // 获取请求体内容
         const std::string &body_content = this->body();
@@ -430,28 +709,116 @@ Yukino::Json &HttpReq::json() const
         // 如果解析成功
         if (tmp.is_valid())
         {
-            // 将解析后的 JSON 数据移动到 req_data_->json 中
-            req_data_->json = std::move(tmp);
+            // 将解析后的 JSON 数据移动到请求数据中
+            data->json = std::move(tmp);
         }
     }
     // 返回 JSON 数据
-    return req_data_->json;
+    return data->json;
+}
+
+// 获取请求体的只读 JSON 视图
+JsonView HttpReq::json_view() const
+{
+    if (content_type() != APPLICATION_JSON)
+        return JsonView();
+    return JsonView(this->body());
 }
 
 // 获取路由参数中的值
-const std::string &HttpReq::param(const std::string &key) const
+const std::string &HttpReq::param(const StringPiece &key) const
 {
-    // 如果路由参数中存在该键
-    if (route_params_.count(key))
-        return route_params_.at(key); // 返回对应的值
+    // 如果路由参数中存在该键，按需物化为 std::string
+    const RouteParam *param = route_params_.find(key);
+    if (param)
+        return param->value.str();
     else
         return string_not_found; // 否则返回一个表示未找到的字符串
 }
 
-// 检查路由参数中是否存在某个键
-bool HttpReq::has_param(const std::string &key) const
+// 获取路由参数中的值（不拷贝）
+StringPiece HttpReq::param_view(const StringPiece &key) const
 {
-    return route_params_.count(key) > 0; // 如果存在该键，返回 true
+    const RouteParam *param = route_params_.find(key);
+    return param ? param->value.view() : StringPiece();
+}
+
+// 检查路由参数中是否存在某个键
+bool HttpReq::has_param(const StringPiece &key) const
+{
+    return route_params_.find(key) != nullptr; // 如果存在该键，返回 true
+}
+
+// 将参数值拷贝到栈上的缓冲区，以便交给 strtoxx 系列函数解析
+// 数字参数不会很长，放不下的值不截断（截断会得到另一个数字），直接按超出范围抛出 out_of_range
+static const char *param_to_cstr(const StringPiece &value, char *buf, size_t buf_size, const char *func)
+{
+    size_t len = value.size();
+    if (len >= buf_size)
+        throw std::out_of_range(func);
+    memcpy(buf, value.data(), len);
+    buf[len] = '\0';
+    return buf;
+}
+
+// 与 std::stoi 保持一致：无法转换时抛出 invalid_argument，溢出时抛出 out_of_range
+template<>
+int HttpReq::param<int>(const StringPiece &key) const
+{
+    const RouteParam *param = route_params_.find(key);
+    if (!param)
+        return 0;
+
+    char buf[64];
+    const char *str = param_to_cstr(param->value.view(), buf, sizeof buf, "stoi");
+    char *end;
+    errno = 0;
+    long val = strtol(str, &end, 10);
+    if (end == str)
+        throw std::invalid_argument("stoi");
+    if (errno == ERANGE || val < INT_MIN || val > INT_MAX)
+        throw std::out_of_range("stoi");
+    return static_cast<int>(val);
+}
+
+// 与 std::stoul 保持一致
+template<>
+size_t HttpReq::param<size_t>(const StringPiece &key) const
+{
+    const RouteParam *param = route_params_.find(key);
+    if (!param)
+        return 0;
+
+    char buf[64];
+    const char *str = param_to_cstr(param->value.view(), buf, sizeof buf, "stoul");
+    char *end;
+    errno = 0;
+    unsigned long val = strtoul(str, &end, 10);
+    if (end == str)
+        throw std::invalid_argument("stoul");
+    if (errno == ERANGE)
+        throw std::out_of_range("stoul");
+    return static_cast<size_t>(val);
+}
+
+// 与 std::stod 保持一致
+template<>
+double HttpReq::param<double>(const StringPiece &key) const
+{
+    const RouteParam *param = route_params_.find(key);
+    if (!param)
+        return 0.0;
+
+    char buf[64];
+    const char *str = param_to_cstr(param->value.view(), buf, sizeof buf, "stod");
+    char *end;
+    errno = 0;
+    double val = strtod(str, &end);
+    if (end == str)
+        throw std::invalid_argument("stod");
+    if (errno == ERANGE)
+        throw std::out_of_range("stod");
+    return val;
 }
 
 // 获取查询字符串中的值
@@ -480,11 +847,23 @@ bool HttpReq::has_query(const std::string &key) const
     return query_params_.find(key) != query_params_.end(); // 如果存在该键，返回 true
 }
 
-// 如果内容类型是 multipart/form-data，则填充multi_part_的边界字符串
-void HttpReq::fill_content_type()
+// 获取请求的内容类型
+http_content_type HttpReq::content_type() const
 {
+    fill_content_type();
+    return content_type_;
+}
+
+// 解析 Content-Type 请求头，如果内容类型是 multipart/form-data，则填充multi_part_的边界字符串
+void HttpReq::fill_content_type() const
+{
+    // 只解析一次，大部分请求不访问请求体，也就不需要内容类型
+    if (content_type_filled_)
+        return;
+    content_type_filled_ = true;
+
     // 获取请求头中的 Content-Type 字段
-    const std::string &content_type_str = header("Content-Type");
+    StringPiece content_type_str = header_view("Content-Type");
     // 将内容类型字符串转换为枚举值
     content_type_ = ContentType::to_enum(content_type_str);
 
@@ -492,13 +871,16 @@ void HttpReq::fill_content_type()
     if (content_type_ == MULTIPART_FORM_DATA)
     {
         // 尝试找到 boundary 参数
-        const char *boundary = strstr(content_type_str.c_str(), "boundary=");
+        static const char kBoundary[] = "boundary=";
+        const char *boundary = static_cast<const char *>(memmem(content_type_str.data(), content_type_str.size(),
+                                                                kBoundary, sizeof kBoundary - 1));
         if (boundary == nullptr)
         {
             return; // 如果没有找到 boundary 参数，直接返回
         }
-        boundary += strlen("boundary="); // 跳过 "boundary=" 字符串
-        StringPiece boundary_piece(boundary); // 创建一个 StringPiece 对象
+        boundary += sizeof kBoundary - 1; // 跳过 "boundary=" 字符串
+        // 创建一个 StringPiece 对象，截止到请求头末尾
+        StringPiece boundary_piece(boundary, content_type_str.end() - boundary);
 
         // 去掉 boundary 参数值的引号
         StringPiece boundary_str = StrUtil::trim_pairs(boundary_piece, R"(""'')");
@@ -508,48 +890,32 @@ void HttpReq::fill_content_type()
 }
 
 // 获取 HTTP 请求头中的某个值
-const std::string &HttpReq::header(const std::string &key) const
+const std::string &HttpReq::header(const StringPiece &key) const
 {
-    // 在 headers_ 中查找指定的键
-    const auto it = headers_.find(key);
+    // 在请求头索引中查找指定的键，按需物化为 std::string
+    headers_.build(this->get_parser());
+    const HttpHeaderIndex::Entry *entry = headers_.find(key);
 
-    // 如果未找到或对应的值为空，返回一个表示未找到的字符串
-    if (it == headers_.end() || it->second.empty())
+    // 如果未找到，返回一个表示未找到的字符串
+    if (!entry)
         return string_not_found;
 
-    // 返回找到的第一个值
-    return it->second[0];
+    return entry->value.str();
 }
 
-// 检查 HTTP 请求头中是否存在某个键
-bool HttpReq::has_header(const std::string &key) const
+// 获取 HTTP 请求头中的某个值（不拷贝）
+StringPiece HttpReq::header_view(const StringPiece &key) const
 {
-    // 如果 headers_ 中存在该键，返回 true
-    return headers_.count(key) > 0;
+    headers_.build(this->get_parser());
+    const HttpHeaderIndex::Entry *entry = headers_.find(key);
+    return entry ? entry->value.view() : StringPiece();
 }
 
-// 填充 HTTP 请求头映射
-void HttpReq::fill_header_map()
+// 检查 HTTP 请求头中是否存在某个键
+bool HttpReq::has_header(const StringPiece &key) const
 {
-    // 初始化 HTTP 请求头游标
-    http_header_cursor_t cursor;
-    struct protocol::HttpMessageHeader header;
-
-    http_header_cursor_init(&cursor, this->get_parser());
-    // 遍历所有请求头
-    while (http_header_cursor_next(&header.name, &header.name_len,
-                                   &header.value, &header.value_len,
-                                   &cursor) == 0)
-    {
-        // 构造请求头的键
-        std::string key(static_cast<const char *>(header.name), header.name_len);
-
-        // 将请求头的值添加到映射中
-        headers_[key].emplace_back(static_cast<const char *>(header.value), header.value_len);
-    }
-
-    // 释放 HTTP 请求头游标
-    http_header_cursor_deinit(&cursor);
+    headers_.build(this->get_parser());
+    return headers_.find(key) != nullptr;
 }
 
 // 获取 HTTP 请求中的所有 Cookie
@@ -558,9 +924,8 @@ const std::map<std::string, std::string> &HttpReq::cookies() const
     // 如果 Cookie 映射为空且存在 "Cookie" 请求头
     if (cookies_.empty() && this->has_header("Cookie"))
     {
-        // 获取 "Cookie" 请求头的值
-        const std::string &cookie = this->header("Cookie");
-        StringPiece cookie_piece(cookie);
+        // 获取 "Cookie" 请求头的值，直接在解析缓冲区上切分
+        StringPiece cookie_piece = this->header_view("Cookie");
         // 解析 Cookie
         cookies_ = HttpCookie::split(cookie_piece);
     }
@@ -588,6 +953,9 @@ const std::string &HttpReq::cookie(const std::string &key) const
 HttpReq::HttpReq(HttpReq&& other)
     : HttpRequest(std::move(other)),
     content_type_(other.content_type_),
+    content_type_filled_(other.content_type_filled_),
+    route_path_(std::move(other.route_path_)),
+    route_view_(other.route_view_),
     route_match_path_(std::move(other.route_match_path_)),
     route_full_path_(std::move(other.route_full_path_)),
     route_params_(std::move(other.route_params_)),
@@ -597,9 +965,18 @@ HttpReq::HttpReq(HttpReq&& other)
     headers_(std::move(other.headers_)),
     parsed_uri_(std::move(other.parsed_uri_))
 {
-    // 移动 req_data_ 指针
+    other.headers_.reset();
+
+    // 移动 req_data_ 指针，内存池仍归原来的服务器任务所有
     req_data_ = other.req_data_;
+    req_data_in_arena_ = other.req_data_in_arena_;
     other.req_data_ = nullptr;
+    other.req_data_in_arena_ = false;
+    body_stream_ = other.body_stream_;
+    other.body_stream_ = nullptr;
+
+    // 短字符串移动时会发生拷贝，需要把指向旧缓冲区的视图平移过来
+    rebase_route_views(other.route_path_.data());
 }
 
 // HttpReq 的移动赋值运算符
@@ -608,12 +985,21 @@ HttpReq &HttpReq::operator=(HttpReq&& other)
     // 调用基类的移动赋值运算符
     HttpRequest::operator=(std::move(other));
     content_type_ = other.content_type_;
+    content_type_filled_ = other.content_type_filled_;
 
-    // 移动 req_data_ 指针
+    // 移动 req_data_ 指针，先释放自己原有的请求数据
+    release_req_data();
     req_data_ = other.req_data_;
+    req_data_in_arena_ = other.req_data_in_arena_;
     other.req_data_ = nullptr;
+    other.req_data_in_arena_ = false;
+    body_stream_ = other.body_stream_;
+    other.body_stream_ = nullptr;
 
     // 移动其他成员变量
+    const char *old_route_base = other.route_path_.data();
+    route_path_ = std::move(other.route_path_);
+    route_view_ = other.route_view_;
     route_match_path_ = std::move(other.route_match_path_);
     route_full_path_ = std::move(other.route_full_path_);
     route_params_ = std::move(other.route_params_);
@@ -621,57 +1007,86 @@ HttpReq &HttpReq::operator=(HttpReq&& other)
     cookies_ = std::move(other.cookies_);
     multi_part_ = std::move(other.multi_part_);
     headers_ = std::move(other.headers_);
+    other.headers_.reset();
     parsed_uri_ = std::move(other.parsed_uri_);
+    rebase_route_views(old_route_base);
 
     return *this;
 }
 
-// 向 HTTP 响应中添加字符串内容（左值引用）
-void HttpResp::String(const std::string &str)
+// 将指向旧溢出缓冲区的视图平移到 route_path_
+void HttpReq::rebase_route_views(const char *old_base)
 {
-    // 创建一个字符串对象用于存储压缩后的数据
-    auto *compress_data = new std::string;
+    if (old_base == route_path_.data())
+        return;
 
-    // 尝试压缩字符串内容
-    int ret = this->compress(&str, compress_data);
+    size_t len = route_path_.size();
+    const char *new_base = route_path_.data();
+    if (route_view_.data() >= old_base && route_view_.data() < old_base + len)
+        route_view_ = StringPiece(new_base + (route_view_.data() - old_base), route_view_.size());
+    route_params_.rebase(old_base, len, new_base);
+    route_match_path_.rebase(old_base, len, new_base);
+}
 
-    // 如果压缩失败
-    if (ret != StatusOK)
+// 规范化请求路径，parsed_uri_.path 保持原样，current_path() 仍然返回原始路径
+const StringPiece &HttpReq::normalize_route_path()
+{
+    if (!parsed_uri_.path)
     {
-        // 直接将原始字符串添加到响应体中
-        this->append_output_body(static_cast<const void *>(str.c_str()), str.size());
+        route_view_ = StringPiece("/");
+        return route_view_;
+    }
+
+    size_t len = strlen(parsed_uri_.path);
+    size_t bound = CodeUtil::normalize_path_bound(len);
+    if (arena_)
+    {
+        char *buf = static_cast<char *>(arena_->allocate(bound, 1));
+        route_view_ = StringPiece(buf, CodeUtil::normalize_path(parsed_uri_.path, len, buf));
     }
     else
     {
-        // 如果压缩成功，将压缩后的数据添加到响应体中
-        this->append_output_body_nocopy(compress_data->c_str(), compress_data->size());
+        route_path_.resize(bound);
+        route_path_.resize(CodeUtil::normalize_path(parsed_uri_.path, len, &route_path_[0]));
+        route_view_ = StringPiece(route_path_);
     }
+    return route_view_;
+}
+
+// 小于该大小的响应体一次压缩完，带 Content-Length 发送；
+// 更大的 gzip 响应体按 GzipStream::CHUNK_SIZE 分块压缩，以 chunked 编码发送，不需要按整个响应体预分配压缩缓冲区
+static constexpr size_t GZIP_CHUNKED_THRESHOLD = 64 * 1024;
 
-    // 添加回调函数，在任务完成后释放压缩数据
-    task_of(this)->add_callback([compress_data](HttpTask *) { delete compress_data; });
+// 向 HTTP 响应中添加字符串内容（左值引用）
+void HttpResp::String(const std::string &str)
+{
+    // 尝试压缩字符串内容，压缩结果位于内存池中
+    int ret = this->append_compressed(str.c_str(), str.size());
+
+    // 如果压缩失败
+    if (ret != StatusOK)
+    {
+        // 将原始字符串拷贝到内存池中，小响应不会产生额外的堆分配
+        const char *data = this->arena()->copy(str.c_str(), str.size());
+        this->append_output_body_nocopy(data, str.size());
+    }
 }
 
 // 向 HTTP 响应中添加字符串内容（右值引用优化）
 void HttpResp::String(std::string &&str)
 {
-    // 创建一个字符串对象用于存储数据
-    auto *data = new std::string;
-
     // 尝试压缩字符串内容
-    int ret = this->compress(&str, data);
+    int ret = this->append_compressed(str.c_str(), str.size());
 
     // 如果压缩失败
     if (ret != StatusOK)
     {
-        // 将原始字符串移动到数据对象中
-        *data = std::move(str);
-    }
-
-    // 将数据添加到响应体中
-    this->append_output_body_nocopy(data->c_str(), data->size());
+        // 在内存池中创建一个字符串对象，将原始字符串移动进去，任务结束时随内存池释放
+        auto *data = this->arena()->create<std::string>(std::move(str));
 
-    // 添加回调函数，在任务完成后释放数据对象
-    task_of(this)->add_callback([data](HttpTask *) { delete data; });
+        // 将数据添加到响应体中
+        this->append_output_body_nocopy(data->c_str(), data->size());
+    }
 }
 
 // 向 HTTP 响应中添加多部分表单编码数据（常量引用）
@@ -841,30 +1256,167 @@ void HttpResp::String(MultiPartEncoder *encoder)
     }
 }
 
-// 压缩数据
-int HttpResp::compress(const std::string * const data, std::string *compress_data)
+// 按 Content-Encoding 压缩数据并追加到响应体
+int HttpResp::append_compressed(const char *data, size_t len)
 {
-    // 初始化状态码为成功
-    int status = StatusOK;
+    bool negotiated = headers.find("Content-Encoding") == headers.end();
+    Compress method;
+    if (!this->negotiate_compress(len, &method))
+        return StatusNoComrpess;
+
+    int status = this->append_compressed(method, data, len);
+    // 协商得到的编码压缩失败时撤销 Content-Encoding，由调用者追加原始数据
+    if (status != StatusOK && negotiated)
+        headers.erase("Content-Encoding");
+    return status;
+}
+
+// 选择响应体的压缩方法
+bool HttpResp::negotiate_compress(size_t len, Compress *method)
+{
+    auto it = headers.find("Content-Encoding");
+    if (it != headers.end())
+    {
+        // 指定了无法识别的编码时返回未压缩，由调用者追加原始数据
+        return compress_method_from_str(StrUtil::trim(it->second), method);
+    }
 
-    // 检查响应头中是否存在 Content-Encoding 字段
-    if (headers.find("Content-Encoding") != headers.end())
+    // 没有指定编码时按 Accept-Encoding 自动协商
+    auto type = headers.find("Content-Type");
+    const ContentEncoding &encoding = task_of(this)->get_server()->get_content_encoding();
+    if (!encoding.enabled() ||
+        !encoding.negotiate(task_of(this)->get_req()->header_view("Accept-Encoding"),
+                            type != headers.end() ? StringPiece(type->second) : StringPiece("text/plain"),
+                            len, method))
+        return false;
+
+    headers["Content-Encoding"] = compress_method_to_str(*method);
+    std::string &vary = headers["Vary"];
+    if (vary.empty())
+        vary = "Accept-Encoding";
+    else if (vary.find("Accept-Encoding") == std::string::npos)
+        vary.append(", Accept-Encoding");
+    return true;
+}
+
+// 按指定的压缩方法压缩数据并追加到响应体
+int HttpResp::append_compressed(Compress method, const char *data, size_t len)
+{
+    Arena *arena = this->arena();
+    // 已经以 chunked 编码发送时之后的数据都要写成 chunk；响应体中已经有其他数据时不能再改用 chunked 编码
+    bool chunked = chunked_body_ ||
+                   (method == Compress::GZIP && len >= GZIP_CHUNKED_THRESHOLD && this->get_output_body_size() == 0);
+    if (!chunked)
     {
-        // 如果存在 Content-Encoding 字段且包含 gzip
-        if (headers["Content-Encoding"].find("gzip") != std::string::npos)
+        // 在内存池中创建一个字符串对象用于存储压缩后的数据，任务结束时随内存池释放
+        auto *compress_data = arena->create<std::string>();
+        int status = Compressor::compress(method, data, len, compress_data, this->compress_level(len));
+        if (status == StatusOK)
+            this->append_output_body_nocopy(compress_data->c_str(), compress_data->size());
+        return status;
+    }
+
+    // 每块压缩结果直接写成一个 chunk
+    std::vector<StringPiece> chunks;
+    int status;
+    if (method == Compress::GZIP)
+    {
+        GzipStream stream(this->compress_level(len));
+        status = stream.update(data, len, true, [arena, &chunks](const char *out, size_t out_len)
         {
-            // 调用 Compressor::gzip 方法对数据进行 gzip 压缩
-            status = Compressor::gzip(data, compress_data);
-        }
-    } 
+            chunks.push_back(make_chunk(arena, out, out_len));
+        });
+    }
     else
     {
-        // 如果没有指定 Content-Encoding 字段，设置状态码为未压缩
-        status = StatusNoComrpess;
+        std::string compress_data;
+        status = Compressor::compress(method, data, len, &compress_data, this->compress_level(len));
+        if (status == StatusOK && !compress_data.empty())
+            chunks.push_back(make_chunk(arena, compress_data.data(), compress_data.size()));
     }
+    if (status != StatusOK)
+        return status;
 
-    // 返回压缩状态码
-    return status;
+    this->open_chunked_body();
+    for (const StringPiece &chunk : chunks)
+        this->append_output_body_nocopy(chunk.data(), chunk.size());
+    return StatusOK;
+}
+
+// 以 chunked 编码发送响应体
+void HttpResp::open_chunked_body()
+{
+    if (chunked_body_)
+        return;
+
+    chunked_body_ = true;
+    headers.erase("Content-Length");
+    headers["Transfer-Encoding"] = "chunked";
+}
+
+// 获取所属服务器任务的内存池
+Arena *HttpResp::arena()
+{
+    return task_of(this)->arena();
+}
+
+// 编码响应，响应头由 HttpServerTask::message_out 预先序列化到一块连续的内存中
+int HttpResp::encode(struct iovec vectors[], int max)
+{
+    if (header_block_.empty())
+        return this->HttpResponse::encode(vectors, max);
+
+    // 先空出第一个向量，交给基类编码状态行、解析器中的响应头和响应体
+    int cnt = this->HttpResponse::encode(vectors + 1, max - 1);
+    if (cnt < 0)
+        return cnt;
+
+    // 状态行以单独的 "\r\n" 向量结尾，将其前移一位后把响应头插在它后面
+    for (int i = 0; i < cnt; i++)
+    {
+        vectors[i] = vectors[i + 1];
+        if (vectors[i].iov_len == 2 && memcmp(vectors[i].iov_base, "\r\n", 2) == 0)
+        {
+            vectors[i + 1].iov_base = const_cast<char *>(header_block_.data());
+            vectors[i + 1].iov_len = header_block_.size();
+            return cnt + 1;
+        }
+    }
+
+    errno = EBADMSG;
+    return -1;
+}
+
+// 读取响应体时使用的向量数，超过时基类会把末尾的块合并成一块
+static constexpr int OUTPUT_BODY_IOV_MAX = 2048;
+
+bool HttpResp::get_output_body_blocks(std::vector<StringPiece> *blocks)
+{
+    blocks->clear();
+    if (header_block_.empty())
+        return false;
+
+    // 基类依次编码状态行、解析器中的响应头、空行和响应体，响应体的块在末尾，按总长度从后往前取出
+    std::vector<struct iovec> vectors(OUTPUT_BODY_IOV_MAX);
+    int cnt = this->HttpResponse::encode(vectors.data(), OUTPUT_BODY_IOV_MAX);
+    if (cnt < 0)
+        return false;
+
+    size_t remain = this->get_output_body_size();
+    int first = cnt;
+    while (remain > 0 && first > 0)
+    {
+        first--;
+        if (vectors[first].iov_len > remain)
+            return false;
+        remain -= vectors[first].iov_len;
+    }
+    if (remain > 0)
+        return false;
+
+    for (int i = first; i < cnt; i++)
+        blocks->emplace_back(vectors[i].iov_base, vectors[i].iov_len);
+    return true;
 }
 
 // 设置错误响应（无错误信息）
@@ -889,6 +1441,18 @@ void HttpResp::Error(int error_code, const std::string &errmsg)
         // 如果是路由相关错误，设置状态码为 404 Not Found
         status_code = 404;
         break;
+    case StatusUncompressTooLarge:
+        // 请求体解压后超过上限，设置状态码为 413 Payload Too Large
+        status_code = 413;
+        break;
+    case StatusFileWriteError:
+        // 请求体写入文件失败（包括磁盘跟不上网络），设置状态码为 507 Insufficient Storage
+        status_code = 507;
+        break;
+    case StatusMySQLParamMismatch:
+        // 语句的参数个数不对是服务器端的编程错误，设置状态码为 500 Internal Server Error
+        status_code = 500;
+        break;
     default:
         break;
     }
@@ -1170,18 +1734,13 @@ void HttpResp::Push(const std::string &cond_name, const PushFunc &push_cb, const
     // 将 HTTP 响应头部推送到客户端
     server_task->push(http_header.c_str(), http_header.size());
 
-    // 创建 PushTaskCtx 对象
-    auto* push_task_ctx = new PushTaskCtx;
+    // 在内存池中创建 PushTaskCtx 对象，任务结束时随内存池释放
+    auto* push_task_ctx = arena()->create<PushTaskCtx>();
     push_task_ctx->server_task = server_task; // 设置 HttpServerTask 对象
     push_task_ctx->cond_name = cond_name; // 设置条件名称
     push_task_ctx->push_cb = push_cb; // 设置推送回调函数
     push_task_ctx->push_err_cb = err_cb; // 设置错误回调函数
 
-    // 添加回调函数，在任务完成后释放 PushTaskCtx 对象
-    server_task->add_callback([push_task_ctx](HttpTask *server_task) {
-        delete push_task_ctx;
-    });
-
     // 创建定时器任务用于推送数据
     auto* push_task = WFTaskFactory::create_timer_task(0, 0, push_func);
     push_task->user_data = push_task_ctx; // 设置定时器任务的用户数据
@@ -1279,8 +1838,11 @@ void HttpResp::Json(const Yukino::Json &json)
     // 设置响应头中的 Content-Type 为 application/json
     this->headers["Content-Type"] = "application/json";
 
-    // 将 JSON 对象序列化为字符串并添加到响应体中
-    this->String(json.dump());
+    // 直接序列化到内存池中的字符串，不需要压缩时整块作为响应体发送，不再拷贝
+    auto *body = this->arena()->create<std::string>();
+    json.dump_to(body);
+    if (this->append_compressed(body->c_str(), body->size()) != StatusOK)
+        this->append_output_body_nocopy(body->c_str(), body->size());
 }
 
 // 设置 JSON 响应（使用字符串）
@@ -1308,6 +1870,12 @@ void HttpResp::set_compress(const enum Compress &compress)
     headers["Content-Encoding"] = compress_method_to_str(compress);
 }
 
+// 获取实际使用的压缩级别：响应或路由指定的级别优先，否则按响应体大小选择
+CompressLevel HttpResp::compress_level(size_t size) const
+{
+    return task_of(this)->get_server()->get_content_encoding().level_for(compress_level_, size);
+}
+
 // 获取当前任务的状态
 int HttpResp::get_state() const
 {
@@ -1348,8 +1916,8 @@ void HttpResp::Http(const std::string &url, int redirect_max, size_t size_limit)
                                                             0,
                                                             proxy_http_callback);
 
-    // 创建代理上下文
-    auto *proxy_ctx = new ProxyCtx;
+    // 在内存池中创建代理上下文，任务结束时随内存池释放
+    auto *proxy_ctx = arena()->create<ProxyCtx>();
     proxy_ctx->url = http_url; // 设置目标 URL
     proxy_ctx->server_task = server_task; // 设置服务器任务
     proxy_ctx->is_keep_alive = server_req->is_keep_alive(); // 设置是否保持连接
@@ -1410,9 +1978,19 @@ void HttpResp::Http(const std::string &url, int redirect_max, size_t size_limit)
 
 // 执行 MySQL 查询（不带回调函数）
 void HttpResp::MySQL(const std::string &url, const std::string &sql)
+{
+    this->MySQL(url, sql, MySQLEncoding::ROWS);
+}
+
+// 执行 MySQL 查询，按指定的格式输出结果
+void HttpResp::MySQL(const std::string &url, const std::string &sql, MySQLEncoding encoding)
 {
     // 创建 MySQL 任务
-    WFMySQLTask *mysql_task = WFTaskFactory::create_mysql_task(url, 0, mysql_callback);
+    WFMySQLTask *mysql_task = WFTaskFactory::create_mysql_task(url, 0,
+    [encoding](WFMySQLTask *mysql_task)
+    {
+        mysql_callback(mysql_task, encoding);
+    });
     // 设置查询语句
     mysql_task->get_req()->set_query(sql);
     // 设置任务的用户数据为当前 HttpResp 对象
@@ -1474,6 +2052,86 @@ void HttpResp::MySQL(const std::string &url, const std::string &sql, const MySQL
     this->add_task(mysql_task);
 }
 
+// 使用预先注册的上游执行 MySQL 查询
+void HttpResp::MySQL(const MySQLUpstream &upstream, const std::string &sql, MySQLEncoding encoding)
+{
+    WFMySQLTask *mysql_task = upstream.create_task(sql, [encoding](WFMySQLTask *mysql_task)
+    {
+        mysql_callback(mysql_task, encoding);
+    });
+    mysql_task->user_data = this;
+    this->add_task(mysql_task);
+}
+
+// 使用预先注册的上游执行 MySQL 查询（带 JSON 回调函数）
+void HttpResp::MySQL(const MySQLUpstream &upstream, const std::string &sql, const MySQLJsonFunc &func)
+{
+    WFMySQLTask *mysql_task = upstream.create_task(sql, [func](WFMySQLTask *mysql_task)
+    {
+        Yukino::Json json = mysql_concat_json_res(mysql_task);
+        func(&json);
+    });
+    this->add_task(mysql_task);
+}
+
+// 使用预先注册的上游执行带占位符的语句
+void HttpResp::MySQL(const MySQLUpstream &upstream, const MySQLStatement &stmt,
+                     const std::vector<MySQLParam> &params, MySQLEncoding encoding)
+{
+    std::string sql;
+    if (!stmt.bind(params, &sql))
+    {
+        this->Error(StatusMySQLParamMismatch, upstream.name());
+        return;
+    }
+    this->MySQL(upstream, sql, encoding);
+}
+
+// 使用预先注册的上游执行带占位符的语句（带 JSON 回调函数）
+void HttpResp::MySQL(const MySQLUpstream &upstream, const MySQLStatement &stmt,
+                     const std::vector<MySQLParam> &params, const MySQLJsonFunc &func)
+{
+    std::string sql;
+    if (!stmt.bind(params, &sql))
+    {
+        this->Error(StatusMySQLParamMismatch, upstream.name());
+        return;
+    }
+    this->MySQL(upstream, sql, func);
+}
+
+// 使用预先注册的上游同时执行多条 MySQL 查询
+void HttpResp::MySQL(const MySQLUpstream &upstream, const std::vector<std::string> &sqls)
+{
+    this->MySQL(upstream, sqls, MySQLJsonFunc([this](Yukino::Json *json)
+    {
+        this->Json(*json);
+    }));
+}
+
+// 使用预先注册的上游同时执行多条 MySQL 查询（带 JSON 回调函数）
+void HttpResp::MySQL(const MySQLUpstream &upstream, const std::vector<std::string> &sqls,
+                     const MySQLJsonFunc &func)
+{
+    this->MySQL(upstream, sqls, MySQLBatchFunc([func](std::vector<MySQLReply> *replies)
+    {
+        Yukino::Json results = Yukino::Json::Array();
+        for (MySQLReply &reply : *replies)
+            results.push_back(mysql_json_res(reply.state, reply.error, &reply.resp));
+
+        Yukino::Json json;
+        json.push_back("results", results);
+        func(&json);
+    }));
+}
+
+// 使用预先注册的上游同时执行多条 MySQL 查询（带自定义回调函数）
+void HttpResp::MySQL(const MySQLUpstream &upstream, const std::vector<std::string> &sqls,
+                     const MySQLBatchFunc &func)
+{
+    this->add_task(upstream.create_batch(sqls, func));
+}
+
 // 执行 Redis 命令
 void HttpResp::Redis(const std::string &url, const std::string &command,
         const std::vector<std::string>& params)
@@ -1527,6 +2185,64 @@ void HttpResp::Redis(const std::string &url, const std::string &command,
     this->add_task(redis_task);
 }
 
+// 使用预先注册的上游执行一条 Redis 命令
+void HttpResp::Redis(const RedisUpstream &upstream, const std::string &command,
+        const std::vector<std::string>& params)
+{
+    this->Redis(upstream, command, params, [this](Yukino::Json *json)
+    {
+        this->Json(*json);
+    });
+}
+
+// 使用预先注册的上游执行一条 Redis 命令（带 JSON 回调函数）
+void HttpResp::Redis(const RedisUpstream &upstream, const std::string &command,
+        const std::vector<std::string>& params, const RedisJsonFunc &func)
+{
+    WFRedisTask *redis_task = upstream.create_task(command, params, [func](WFRedisTask *redis_task)
+    {
+        RedisReply reply;
+        reply.state = redis_task->get_state();
+        reply.error = redis_task->get_error();
+        if (reply.state == WFT_STATE_SUCCESS)
+            redis_task->get_resp()->get_result(reply.value);
+
+        Yukino::Json js;
+        if (reply.state == WFT_STATE_SUCCESS)
+            js.push_back("reply", RedisUpstream::reply_to_json(reply.value));
+        else
+            js = RedisUpstream::reply_to_json(reply);
+        func(&js);
+    });
+    this->add_task(redis_task);
+}
+
+// 使用预先注册的上游同时执行多条 Redis 命令
+void HttpResp::Redis(const RedisUpstream &upstream, const std::vector<RedisCommand> &commands)
+{
+    this->Redis(upstream, commands, [this](Yukino::Json *json)
+    {
+        this->Json(*json);
+    });
+}
+
+// 使用预先注册的上游同时执行多条 Redis 命令（带 JSON 回调函数）
+void HttpResp::Redis(const RedisUpstream &upstream, const std::vector<RedisCommand> &commands,
+        const RedisJsonFunc &func)
+{
+    ParallelWork *pwork = upstream.create_batch(commands, [func](std::vector<RedisReply> *replies)
+    {
+        Yukino::Json array = Yukino::Json::Array();
+        for (const RedisReply &reply : *replies)
+            array.push_back(RedisUpstream::reply_to_json(reply));
+
+        Yukino::Json js;
+        js.push_back("replies", array);
+        func(&js);
+    });
+    this->add_task(pwork);
+}
+
 // 发起重定向响应
 void HttpResp::Redirect(const std::string& location, int status_code)
 {
@@ -1551,7 +2267,9 @@ void HttpResp::add_task(SubTask *task)
 HttpResp::HttpResp(HttpResp&& other)
 : HttpResponse(std::move(other)), // 调用基类的移动构造函数
 headers(std::move(other.headers)), // 移动响应头映射
-cookies_(std::move(other.cookies_)) // 移动 Cookie 列表
+cookies_(std::move(other.cookies_)), // 移动 Cookie 列表
+compress_level_(other.compress_level_), // 复制压缩级别
+chunked_body_(other.chunked_body_)
 {
     user_data = other.user_data; // 移动用户数据指针
     other.user_data = nullptr; // 将源对象的用户数据指针置空
@@ -1573,6 +2291,10 @@ HttpResp &HttpResp::operator=(HttpResp&& other)
     // 移动 Cookie 列表
     cookies_ = std::move(other.cookies_);
 
+    // 复制压缩级别
+    compress_level_ = other.compress_level_;
+    chunked_body_ = other.chunked_body_;
+
     // 返回当前对象的引用
     return *this;
 }
@@ -17,6 +17,11 @@
 #include "Noncopyable.h"
 #include "HttpFile.h"
 #include "Json.h"
+#include "JsonView.h"
+#include "RouteParams.h"
+#include "HttpHeaderIndex.h"
+#include "Arena.h"
+#include "HttpBodyStream.h"
 
 namespace protocol
 {
@@ -27,6 +32,24 @@ namespace Yukino
 {
     struct ReqData; // 前向声明 ReqData 结构体
     class MySQL; // 前向声明 MySQL 类
+    class HttpServerTask; // 前向声明 HttpServerTask 类
+    class HttpServer; // 前向声明 HttpServer 类
+    class Router; // 前向声明 Router 类
+    class ContentEncoding; // 前向声明 ContentEncoding 类
+    class RedisUpstream; // 前向声明 RedisUpstream 类
+    class MySQLUpstream; // 前向声明 MySQLUpstream 类
+    class MySQLStatement; // 前向声明 MySQLStatement 类
+    class MySQLParam; // 前向声明 MySQLParam 类
+    struct MySQLReply; // 前向声明 MySQLReply 结构体
+    struct RedisCommand; // 前向声明 RedisCommand 结构体
+
+    // HttpResp::MySQL 输出查询结果的格式
+    enum class MySQLEncoding
+    {
+        ROWS,     // 按行输出的 JSON，NULL 输出为字符串 "NULL"（默认，与 mysql_concat_json_res 相同）
+        COLUMNS,  // 按列输出的 JSON，每列带有名称和类型，NULL 输出为 null，数值保持数值类型（见 MySQLColumnWriter）
+        MSGPACK,  // 与 COLUMNS 结构相同的 MessagePack，Content-Type 为 application/msgpack
+    };
 
     /**
      * @brief HttpReq 类，表示 HTTP 请求对象
@@ -41,10 +64,19 @@ namespace Yukino
         /**
          * @brief 获取请求体内容
          * 
+         * 路由开启了流式请求体时（见 BluePrint::stream_body），请求体不会缓存，这里返回空字符串
+         * 
          * @return std::string& 请求体内容的引用
          */
         std::string &body() const;
 
+        /**
+         * @brief 请求体解压后是否超过了上限（见 HttpServer::decompress_limit）
+         * 
+         * 超过上限时 body() 为空，json()、form()、form_kv() 也都为空，响应在发送前改为 413
+         */
+        bool body_too_large() const;
+
         /**
          * @brief 获取 POST 请求的表单数据，body类型为application/x-www-form-urlencoded
          * 
@@ -68,20 +100,37 @@ namespace Yukino
         Yukino::Json &json() const;
 
         /**
-         * @brief 获取请求的内容类型
+         * @brief 获取请求体的只读 JSON 视图，不构建 DOM
+         * 
+         * 按路径访问时才扫描请求体，没有访问到的部分不会被解析，字符串值直接指向 body()，
+         * 只读取大请求体中少数几个字段时比 json() 快得多。内容类型不是 JSON 时返回无效的视图。
+         * 
+         * @return JsonView 指向 body() 的视图，在请求结束前有效
+         */
+        JsonView json_view() const;
+
+        /**
+         * @brief 获取请求的内容类型，首次调用时才解析 Content-Type 请求头
          * 
          * @return http_content_type 请求的内容类型
          */
-        http_content_type content_type() const
-        { return content_type_; }
+        http_content_type content_type() const;
 
         /**
-         * @brief 获取请求头中的某个值
+         * @brief 获取请求头中的某个值（忽略大小写，同名请求头返回第一个）
          * 
          * @param key 请求头的键
          * @return const std::string& 请求头的值
          */
-        const std::string &header(const std::string &key) const;
+        const std::string &header(const StringPiece &key) const;
+
+        /**
+         * @brief 获取请求头中的某个值，不产生任何拷贝
+         * 
+         * @param key 请求头的键
+         * @return StringPiece 指向解析缓冲区的请求头的值，不存在时为空
+         */
+        StringPiece header_view(const StringPiece &key) const;
 
         /**
          * @brief 检查请求头中是否存在某个键
@@ -89,15 +138,25 @@ namespace Yukino
          * @param key 请求头的键
          * @return bool 是否存在该键
          */
-        bool has_header(const std::string &key) const;
+        bool has_header(const StringPiece &key) const;
 
         /**
          * @brief 获取路由参数中的某个值
          * 
+         * 参数值平时只以 StringPiece 的形式指向请求路径，首次调用本函数时才会拷贝为 std::string
+         * 
          * @param key 路由参数的键
          * @return const std::string& 请求参数的值
          */
-        const std::string &param(const std::string &key) const;
+        const std::string &param(const StringPiece &key) const;
+
+        /**
+         * @brief 获取路由参数中的某个值，不产生任何拷贝
+         * 
+         * @param key 路由参数的键
+         * @return StringPiece 指向请求路径的参数值，不存在时为空
+         */
+        StringPiece param_view(const StringPiece &key) const;
 
         /**
          * @brief 获取路由参数中的某个值，并将其转换为指定类型
@@ -105,9 +164,11 @@ namespace Yukino
          * @tparam T 要转换的目标类型
          * @param key 请求参数的键
          * @return T 转换后的值
+         * @throw std::invalid_argument 无法转换时抛出
+         * @throw std::out_of_range 超出目标类型的范围或值超过 63 个字符时抛出
          */
         template<typename T>
-        T param(const std::string &key) const;
+        T param(const StringPiece &key) const;
 
         /**
          * @brief 检查请求参数中是否存在某个键
@@ -115,7 +176,7 @@ namespace Yukino
          * @param key 请求参数的键
          * @return bool 是否存在该键
          */
-        bool has_param(const std::string &key) const;
+        bool has_param(const StringPiece &key) const;
 
         /**
          * @brief 获取查询字符串中的某个值
@@ -157,7 +218,7 @@ namespace Yukino
          * @return const std::string& 匹配的路由路径
          */
         const std::string &match_path() const
-        { return route_match_path_; }
+        { return route_match_path_.str(); }
 
         /**
          * @brief 获取服务端注册完整的路由路径
@@ -165,7 +226,7 @@ namespace Yukino
          * @return const std::string& 完整的路由路径
          */
         const std::string &full_path() const
-        { return route_full_path_; }
+        { return route_full_path_.str(); }
 
         /**
          * @brief 获取客户端当前请求的路径
@@ -192,46 +253,68 @@ namespace Yukino
 
     public:
         /**
-         * @brief 如果内容类型是 multipart/form-data，则填充multi_part_的边界字符串
+         * @brief 解析 Content-Type 请求头，如果内容类型是 multipart/form-data，则填充multi_part_的边界字符串
+         *
+         * 只在第一次调用时解析，content_type()、form()、json() 等需要内容类型时自动调用
          */
-        void fill_content_type();
+        void fill_content_type() const;
 
         /**
-         * @brief 填充请求头映射
+         * @brief 获取路由参数表，路由匹配时直接写入，避免中间拷贝
+         * 
+         * @return RouteParams& 路由参数表
          */
-        void fill_header_map();
+        RouteParams &route_params()
+        { return route_params_; }
 
         /**
-         * @brief 设置路由参数
+         * @brief 获取路由参数表
          * 
-         * @param params 路由参数的键值对
+         * @return const RouteParams& 路由参数表
          */
-        void set_route_params(std::map<std::string, std::string> &&params)
-        { route_params_ = std::move(params); }
+        const RouteParams &route_params() const
+        { return route_params_; }
 
         /**
-         * @brief 设置匹配的路由路径
+         * @brief 规范化解析后的 URI 路径，并将其作为路由匹配的依据
+         * 
+         * 结果写入任务的内存池（没有内存池时写入 route_path_），原始路径不变，见 CodeUtil::normalize_path
          * 
-         * @param match_path 匹配的路由路径
+         * @return const StringPiece& 规范化后的请求路径
          */
-        void set_route_match_path(const std::string &match_path)
-        { route_match_path_ = match_path; }
+        const StringPiece &normalize_route_path();
 
         /**
-         * @brief 设置完整的路由路径
+         * @brief 直接指定用于路由匹配的路径（例如默认路由）
+         * 
+         * @param route_path 规范形式的路径，所指向的缓冲区需要在请求结束前保持有效
+         */
+        void set_route_path(const StringPiece &route_path)
+        { route_view_ = route_path; }
+
+        /**
+         * @brief 获取用于路由匹配的请求路径
+         * 
+         * @return const StringPiece& 规范化后的请求路径
+         */
+        const StringPiece &route_path() const
+        { return route_view_; }
+
+        /**
+         * @brief 设置匹配的路由路径
          * 
-         * @param route_full_path 完整的路由路径
+         * @param match_path 匹配的路由路径，所指向的缓冲区需要在请求结束前保持有效
          */
-        void set_full_path(const std::string &route_full_path)
-        { route_full_path_ = route_full_path; }
+        void set_route_match_path(const StringPiece &match_path)
+        { route_match_path_.set(match_path); }
 
         /**
-         * @brief 设置完整的路由路径（右值引用优化）
+         * @brief 设置完整的路由路径
          * 
-         * @param route_full_path 完整的路由路径
+         * @param route_full_path 完整的路由路径，所指向的缓冲区需要在请求结束前保持有效
          */
-        void set_full_path(std::string &&route_full_path)
-        { route_full_path_ = std::move(route_full_path); }
+        void set_full_path(const StringPiece &route_full_path)
+        { route_full_path_.set(route_full_path); }
 
         /**
          * @brief 设置查询字符串的键值对
@@ -284,64 +367,90 @@ namespace Yukino
          */
         HttpReq &operator=(HttpReq&& other);
 
+        /**
+         * @brief 获取请求所属的内存池
+         * 
+         * @return Arena* 服务器任务的内存池，不属于服务器任务时为 nullptr
+         */
+        Arena *arena() const
+        { return arena_; }
+
+        /**
+         * @brief 获取流式请求体的状态
+         * 
+         * @return BodyStream* 路由开启了流式请求体且请求带有请求体时有效，否则为 nullptr
+         */
+        BodyStream *body_stream() const
+        { return body_stream_; }
+
+    protected:
+        /**
+         * @brief 接收网络数据
+         * 
+         * 请求头解析完成后，如果匹配的路由开启了流式请求体，之后的数据不再交给解析器缓存，
+         * 而是直接交给 BodyStream，请求体大小也不再受 request_size_limit 的限制
+         */
+        int append(const void *buf, size_t *size) override;
+
     private:
-        // 定义一个类型别名 HeaderMap，用于表示 HTTP请求头部的映射结构，并且键值通过MapStringCaseLess使其不区分大小写
-        using HeaderMap = std::map<std::string, std::vector<std::string>, MapStringCaseLess>;
+        // 请求头解析完成后检查路由是否开启了流式请求体，需要时创建 BodyStream
+        void init_body_stream();
 
-        http_content_type content_type_; // 请求的内容类型
-        ReqData *req_data_; // 请求数据指针
+    private:
+        // 获取请求数据，首次访问时才创建（优先从内存池中分配）
+        ReqData *req_data() const;
 
-        std::string route_match_path_; // 匹配的路由路径
-        std::string route_full_path_; // 完整的路由路径
+        // 释放不属于内存池的请求数据
+        void release_req_data();
 
-        std::map<std::string, std::string> route_params_; // 路由参数
+        /**
+         * @brief 移动后将路由参数和匹配路径的视图平移到新的 route_path_ 上
+         * 
+         * @param old_base 移动前 route_path_ 的数据指针
+         */
+        void rebase_route_views(const char *old_base);
+
+    private:
+        mutable http_content_type content_type_; // 请求的内容类型
+        mutable bool content_type_filled_ = false; // 是否已经解析过 Content-Type 请求头
+        mutable ReqData *req_data_ = nullptr; // 请求数据指针（首次访问时创建）
+        mutable bool req_data_in_arena_ = false; // 请求数据是否由内存池管理
+        Arena *arena_ = nullptr; // 所属服务器任务的内存池，移动时不转移
+
+        BodyStream *body_stream_ = nullptr; // 流式请求体（位于内存池中）
+        const Router *stream_router_ = nullptr; // 路由中存在流式请求体时由服务器设置
+        const ContentEncoding *content_encoding_ = nullptr; // 所属服务器的解压上限，由服务器设置，移动时不转移
+        bool stream_checked_ = false; // 是否已经检查过流式请求体
+
+        friend class HttpServerTask;
+        friend class HttpServer;
+
+        std::string route_path_; // 没有内存池时保存规范化的请求路径
+        StringPiece route_view_; // 用于路由匹配的请求路径（指向 parsed_uri_.path 或 route_path_）
+        LazyString route_match_path_; // 匹配的路由路径（指向 route_view_）
+        LazyString route_full_path_; // 完整的路由路径（指向注册的路由字符串）
+
+        RouteParams route_params_; // 路由参数（值指向 route_view_）
         std::map<std::string, std::string> query_params_; // 查询字符串的键值对
         mutable std::map<std::string, std::string> cookies_; // Cookie 的键值对
 
-        MultiPartForm multi_part_; // 多部分表单
-        HeaderMap headers_; // 请求头映射
+        mutable MultiPartForm multi_part_; // 多部分表单（边界在解析内容类型时填充）
+        mutable HttpHeaderIndex headers_; // 请求头索引（首次查询时构建）
 
         ParsedURI parsed_uri_; // 解析后的 URI 信息
 };
 
-// 特化模板函数，将字符串参数转换为 int 类型
+// 特化模板函数，将路由参数转换为 int 类型，不存在时返回 0
 template<>
-inline int HttpReq::param<int>(const std::string &key) const
-{
-    // 检查 route_params_ 中是否存在指定的键
-    if (route_params_.count(key))
-        // 如果存在，将对应的字符串值转换为 int 类型
-        return std::stoi(route_params_.at(key));
-    else
-        // 如果不存在，返回默认值 0
-        return 0;
-}
+int HttpReq::param<int>(const StringPiece &key) const;
 
-// 特化模板函数，将字符串参数转换为 size_t 类型
+// 特化模板函数，将路由参数转换为 size_t 类型，不存在时返回 0
 template<>
-inline size_t HttpReq::param<size_t>(const std::string &key) const
-{
-    // 检查 route_params_ 中是否存在指定的键
-    if (route_params_.count(key))
-        // 如果存在，将对应的字符串值转换为 unsigned long 类型，然后强制转换为 size_t
-        return static_cast<size_t>(std::stoul(route_params_.at(key)));
-    else
-        // 如果不存在，返回默认值 0
-        return 0;
-}
+size_t HttpReq::param<size_t>(const StringPiece &key) const;
 
-// 特化模板函数，将字符串参数转换为 double 类型
+// 特化模板函数，将路由参数转换为 double 类型，不存在时返回 0.0
 template<>
-inline double HttpReq::param<double>(const std::string &key) const
-{
-    // 检查 route_params_ 中是否存在指定的键
-    if (route_params_.count(key))
-        // 如果存在，将对应的字符串值转换为 double 类型
-        return std::stod(route_params_.at(key));
-    else
-        // 如果不存在，返回默认值 0.0
-        return 0.0;
-}
+double HttpReq::param<double>(const StringPiece &key) const;
 
 /**
  * @brief HttpResp 类，表示 HTTP 响应对象
@@ -357,6 +466,8 @@ public:
 
     using MySQLFunc = std::function<void(protocol::MySQLResultCursor *cursor)>; // MySQL 回调函数类型
 
+    using MySQLBatchFunc = std::function<void(std::vector<MySQLReply> *replies)>; // MySQL 并行查询回调函数类型
+
     using RedisJsonFunc = std::function<void(Yukino::Json *json)>; // Redis JSON 回调函数类型
 
     using RedisFunc = std::function<void(WFRedisTask *redis_task)>; // Redis 回调函数类型
@@ -410,6 +521,13 @@ public:
     // 设置压缩方式
     void set_compress(const Compress &compress);
 
+    // 设置压缩级别，覆盖路由的压缩级别（BluePrint::set_compress_level），AUTO 表示按 HttpServer::compress_level 的策略选择
+    void set_compress_level(CompressLevel level)
+    { compress_level_ = level; }
+
+    // 长度为 size 的响应体实际使用的压缩级别
+    CompressLevel compress_level(size_t size) const;
+
     // 添加 Cookie
     void add_cookie(HttpCookie &&cookie)
     { cookies_.emplace_back(std::move(cookie)); }
@@ -438,10 +556,36 @@ public:
     // MySQL 请求
     void MySQL(const std::string &url, const std::string &sql);
 
+    // 按指定的格式输出查询结果
+    void MySQL(const std::string &url, const std::string &sql, MySQLEncoding encoding);
+
     void MySQL(const std::string &url, const std::string &sql, const MySQLJsonFunc &func);
 
     void MySQL(const std::string &url, const std::string &sql, const MySQLFunc &func);
 
+    // 使用预先注册的 MySQL 上游（见 MySQLUpstream::add）执行查询，不再解析 URL
+    void MySQL(const MySQLUpstream &upstream, const std::string &sql,
+               MySQLEncoding encoding = MySQLEncoding::ROWS);
+
+    void MySQL(const MySQLUpstream &upstream, const std::string &sql, const MySQLJsonFunc &func);
+
+    // 使用预先注册的 MySQL 上游执行带占位符的语句，参数转义后拼接到语句中
+    // 参数个数与占位符个数不一致属于编程错误：不发出查询，直接回复 500 并记录错误日志
+    void MySQL(const MySQLUpstream &upstream, const MySQLStatement &stmt, const std::vector<MySQLParam> &params,
+               MySQLEncoding encoding = MySQLEncoding::ROWS);
+
+    void MySQL(const MySQLUpstream &upstream, const MySQLStatement &stmt, const std::vector<MySQLParam> &params,
+               const MySQLJsonFunc &func);
+
+    // 使用预先注册的 MySQL 上游同时执行多条查询，所有查询完成后响应一次，总耗时取决于最慢的一条
+    // 响应为 {"results": [结果, ...]}，每个结果的格式与 MySQLEncoding::ROWS 相同，顺序与 sqls 相同
+    void MySQL(const MySQLUpstream &upstream, const std::vector<std::string> &sqls);
+
+    void MySQL(const MySQLUpstream &upstream, const std::vector<std::string> &sqls, const MySQLJsonFunc &func);
+
+    // 并行查询，回调中用 MySQLResultCursor(&reply.resp) 读取每条查询的结果
+    void MySQL(const MySQLUpstream &upstream, const std::vector<std::string> &sqls, const MySQLBatchFunc &func);
+
     // Redis 请求
     void Redis(const std::string &url, const std::string &command,
             const std::vector<std::string>& params);
@@ -452,6 +596,22 @@ public:
     void Redis(const std::string &url, const std::string &command,
             const std::vector<std::string>& params, const RedisFunc &func);
 
+    // 使用预先注册的 Redis 上游（见 RedisUpstream::add）执行一条命令，任意类型的回复都转换为 JSON
+    // 响应为 {"reply": 回复}，任务失败时为 {"errmsg": 错误信息}
+    void Redis(const RedisUpstream &upstream, const std::string &command,
+            const std::vector<std::string>& params);
+
+    void Redis(const RedisUpstream &upstream, const std::string &command,
+            const std::vector<std::string>& params, const RedisJsonFunc &func);
+
+    // 使用预先注册的 Redis 上游同时执行多条命令，所有命令完成后响应一次
+    // 命令之间没有执行顺序，只适用于互不依赖的命令，相互依赖的命令使用 RedisUpstream::create_sequence
+    // 响应为 {"replies": [回复, ...]}，顺序与 commands 相同，失败的命令为 {"errmsg": 错误信息}
+    void Redis(const RedisUpstream &upstream, const std::vector<RedisCommand> &commands);
+
+    void Redis(const RedisUpstream &upstream, const std::vector<RedisCommand> &commands,
+            const RedisJsonFunc &func);
+
     // 重定向
     void Redirect(const std::string& location, int status_code);
 
@@ -492,10 +652,36 @@ public:
     {
         headers[key] = val;
     }
-private:
-    // 压缩数据
-    int compress(const std::string * const data, std::string *compress_data);
 
+    // 获取所属服务器任务的内存池，任务结束时统一释放
+    Arena *arena();
+
+    // 按 Content-Encoding 压缩数据并追加到响应体，较大的 gzip 数据分块压缩并以 chunked 编码发送
+    // （响应体中已经有其他数据时整体压缩，以 Content-Length 发送；已经以 chunked 编码发送时之后的数据都写成 chunk）
+    // 没有设置 Content-Encoding 且开启了自动压缩（HttpServer::compress）时按 Accept-Encoding 协商
+    // 返回 StatusNoComrpess 表示不需要压缩，其他非 StatusOK 值表示压缩失败，此时都没有追加任何数据
+    int append_compressed(const char *data, size_t len);
+
+    // 按指定的压缩方法压缩数据并追加到响应体，不修改响应头
+    int append_compressed(Compress method, const char *data, size_t len);
+
+    // 按与 append_compressed 相同的规则选择压缩方法，len 为响应体的（预计）大小，用于分块生成的响应体
+    // 由 Accept-Encoding 协商得到时同时设置 Content-Encoding 和 Vary 响应头，返回 false 表示不需要压缩
+    bool negotiate_compress(size_t len, Compress *method);
+
+    // 以 chunked 编码发送响应体，之后追加的数据需要自行写成 chunk，重复调用没有影响
+    // 结束标记由 HttpServerTask::message_out 在发送前追加，因此可以多次追加数据
+    void open_chunked_body();
+
+    // 按块读取已经生成的响应体（与发送的字节相同，包括 chunked 编码），块指向响应自身的数据，任务结束前有效
+    // 用于在任务回调中保存响应，响应还没有经过 HttpServerTask::message_out 或编码失败时返回 false
+    bool get_output_body_blocks(std::vector<StringPiece> *blocks);
+
+protected:
+    // 编码响应，将预先序列化的响应头整块插入到状态行之后
+    int encode(struct iovec vectors[], int max) override;
+
+private:
     // 构造推送头部
     std::string construct_push_header();
 
@@ -534,6 +720,11 @@ public:
 
 private:
     std::vector<HttpCookie> cookies_; // Cookie 列表
+    CompressLevel compress_level_ = CompressLevel::AUTO; // 路由或处理函数指定的压缩级别
+    StringPiece header_block_; // 序列化后的响应头（位于任务的内存池中）
+    bool chunked_body_ = false; // 响应体以 chunked 编码发送，结束标记尚未追加
+
+    friend class HttpServerTask;
 };
 
 // 定义一个类型别名 HttpTask，表示基于 HttpReq 和 HttpResp 的网络任务。
@@ -1,5 +1,6 @@
 #include "workflow/HttpMessage.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "HttpServer.h"
@@ -10,6 +11,7 @@
 #include "Router.h"
 #include "ErrorCode.h"
 #include "CodeUtil.h"
+#include "AssetCache.h"
 #include "spdlog/spdlog.h" 
 
 using namespace Yukino;
@@ -24,15 +26,14 @@ void HttpServer::process(HttpTask *task)
     const char *request_uri;
     std::string uri_str;
 
-    // 填充请求头和内容类型
-    req->fill_header_map();
-    req->fill_content_type();
-
-    // 获取 Host 头部
-    const std::string &host = req->header("Host");
+    // 内容类型在访问请求体时才解析，Host 直接在解析器中查找，
+    // 处理函数不读取请求头时不构建请求头索引
+    StringPiece host = HttpHeaderIndex::scan(req->get_parser(), "Host");
 
     // 检查 Host 头部是否有效
-    if (host.empty() || host.find_first_of("/?#") != std::string::npos)
+    static const char kHostInvalid[] = "/?#";
+    if (host.empty() ||
+        std::find_first_of(host.begin(), host.end(), kHostInvalid, kHostInvalid + 3) != host.end())
     {
         resp->set_status(HttpStatusBadRequest); // 设置状态码为 400 Bad Request
         return;
@@ -50,7 +51,8 @@ void HttpServer::process(HttpTask *task)
     {
         // 如果请求 URI 以 / 开头，拼接完整的 URI
         const char *scheme = this->get_ssl_ctx() ? "https://" : "http://";
-        uri_str = scheme + host + req->get_request_uri();
+        uri_str = scheme;
+        uri_str.append(host.data(), host.size()).append(req->get_request_uri());
     }
     else
     {
@@ -70,41 +72,6 @@ void HttpServer::process(HttpTask *task)
     if (!uri.path)
         uri.path = strdup("/"); // 如果路径为空，设置为 "/"
 
-    // 处理路径中的 "." 和 ".."
-    std::string route("/");
-    const char *pos = uri.path;
-    while (*pos)
-    {
-        const char *slash = pos;
-        while (*slash && *slash != '/')
-            slash++;
-
-        size_t n = slash - pos;
-        if (n == 0 || (n == 1 && *pos == '.'))
-            ; // 忽略单个 "."
-        else if (n == 2 && *pos == '.' && pos[1] == '.')
-        {
-            // 处理 ".."，回退到上一级目录
-            if (route.size() > 1)
-            {
-                n = route.find_last_of('/', route.size() - 2);
-                route.resize(n + 1);
-            }
-        }
-        else
-        {
-            // 添加路径段
-            route.append(pos, slash);
-            if (*slash)
-                route.push_back('/');
-        }
-
-        if (!*slash)
-            break;
-
-        pos = slash + 1;
-    }
-
     // 处理查询参数
     if (uri.query)
     {
@@ -114,16 +81,21 @@ void HttpServer::process(HttpTask *task)
 
     // 设置解析后的 URI
     req->set_parsed_uri(std::move(uri));
+
+    // 单次遍历原地处理路径中的 "." 和 ".."，并转换为与注册路由一致的规范编码
+    // 路由参数和匹配路径都直接引用规范化后的路径，不再拷贝
+    StringPiece route = req->normalize_route_path();
     std::string verb = req->get_method(); // 获取 HTTP 方法
-    int ret = blue_print_.router().call(str_to_verb(verb), CodeUtil::url_encode(route), server_task);
+    int ret = blue_print_.router().call(str_to_verb(verb), route, server_task);
     if(ret != StatusOK && !default_route_.empty())
     {
         // 如果路由匹配失败且设置了默认路由，尝试匹配默认路由
-        ret = blue_print_.router().call(str_to_verb(verb), CodeUtil::url_encode(default_route_), server_task);
+        req->set_route_path(default_route_);
+        ret = blue_print_.router().call(str_to_verb(verb), default_route_, server_task);
     }
     if (ret != StatusOK) {
         // 如果路由匹配失败，返回错误响应
-        resp->Error(ret, verb + " " + route);
+        resp->Error(ret, verb + " " + route.as_string());
     }
     if(track_func_)
     {
@@ -135,14 +107,20 @@ void HttpServer::process(HttpTask *task)
 // 创建新的会话
 CommSession *HttpServer::new_session(long long seq, CommConnection *conn)
 {
-    // 创建一个新的 HttpServerTask 对象
-    HttpTask *task = new HttpServerTask(this, this->WFServer<HttpReq, HttpResp>::process);
+    // 创建一个新的 HttpServerTask 对象，服务器级的配置通过 server 读取
+    HttpServerTask *task = new HttpServerTask(this, this->WFServer<HttpReq, HttpResp>::process);
+    task->server = this;
     // 设置任务的 Keep-Alive 超时时间
     task->set_keep_alive(this->params.keep_alive_timeout);
     // 设置任务的接收超时时间
     task->set_receive_timeout(this->params.receive_timeout);
     // 设置请求的最大大小限制
     task->get_req()->set_size_limit(this->params.request_size_limit);
+    // 有路由开启了流式请求体时，请求头解析完成后需要查找路由
+    if (blue_print_.router().has_body_stream())
+        task->get_req()->stream_router_ = &blue_print_.router();
+    // 请求体解压时使用本服务器的上限
+    task->get_req()->content_encoding_ = &content_encoding_;
 
     return task;
 }
@@ -199,18 +177,22 @@ int HttpServer::serve_static(const char* path, BluePrint &bp)
         route = "/*";
     }
     // 注册 GET 请求的处理函数
-    bp.GET(route, [path_str, is_file](const HttpReq *req, HttpResp *resp) {
-        std::string match_path = req->match_path();
-        if(is_file)
-        {
-            // 如果路径是文件，直接返回文件内容
-            resp->File(path_str);
-        } 
-        else
+    bp.GET(route, [this, path_str, is_file](const HttpReq *req, HttpResp *resp) {
+        // 如果路径是文件，直接返回文件内容；如果路径是目录，返回目录下的文件内容
+        std::string file_path = is_file ? path_str : path_str + "/" + req->match_path();
+
+        // 开启了热点资源缓存时，小文件直接从内存返回，不读磁盘也不重复压缩
+        // Range 请求交给 File() 处理
+        if (asset_cache_.enabled() && req->header_view("Range").empty())
         {
-            // 如果路径是目录，返回目录下的文件内容
-            resp->File(path_str + "/" + match_path);
+            std::shared_ptr<const Asset> asset = asset_cache_.get(file_path);
+            if (asset)
+            {
+                AssetCache::send(asset, req, resp);
+                return;
+            }
         }
+        resp->File(file_path);
     });
     return StatusOK;
 }
@@ -9,6 +9,13 @@
 
 #include "HttpMsg.h"
 #include "BluePrint.h"
+#include "CodeUtil.h"
+#include "FileCache.h"
+#include "AssetCache.h"
+#include "ContentEncoding.h"
+#include "RedisUpstream.h"
+#include "MySQLUpstream.h"
+#include "ResponseCache.h"
 
 namespace Yukino
 {
@@ -536,7 +543,8 @@ public:
     // 设置默认路由
     void set_default_route(const std::string& default_route)
     {
-        default_route_ = default_route;
+        // 与注册的路由一样保存为规范形式，匹配时无需再编码
+        default_route_ = CodeUtil::canonical_route(default_route);
     }
 
     // 注册一个 BluePrint 对象，并指定 URL 前缀
@@ -552,6 +560,23 @@ public:
         for_each(*tp, GlobalAspectFunc());
     }
 
+    // 启动服务器，参数与 WFServerBase::start 的各个重载一致
+    // 启动前先冻结路由表，之后的请求都走扁平匹配路径
+    template <typename... ARGS>
+    int start(ARGS &&...args)
+    {
+        blue_print_.router_.freeze();
+        return WFServerBase::start(std::forward<ARGS>(args)...);
+    }
+
+    // 使用已有的监听套接字启动服务器，同样先冻结路由表
+    template <typename... ARGS>
+    int serve(ARGS &&...args)
+    {
+        blue_print_.router_.freeze();
+        return WFServerBase::serve(std::forward<ARGS>(args)...);
+    }
+
     // 停止服务器
     void stop()
     {
@@ -562,7 +587,8 @@ public:
 public:
     // HttpServer 类的构造函数
     HttpServer() :
-    WFServer(std::bind(&HttpServer::process, this, std::placeholders::_1))
+    WFServer(std::bind(&HttpServer::process, this, std::placeholders::_1)),
+    asset_cache_(file_cache_)
     {}
 
     // 设置最大连接数
@@ -607,6 +633,56 @@ public:
     return *this;
     }
 
+    // 设置本服务器的静态文件缓存：最多缓存的文件数（默认 64，0 表示关闭缓存，不超过 RLIMIT_NOFILE 的四分之一）
+    // 和两次校验修改时间的间隔（秒），同一进程中的其他服务器不受影响
+    HttpServer &file_cache(size_t max_files, int valid_seconds)
+    {
+    file_cache_.set_capacity(max_files);
+    file_cache_.set_valid_seconds(valid_seconds);
+    return *this;
+    }
+
+    // 开启本服务器 Static() 的热点资源内存缓存：总字节数上限（含预压缩版本，0 表示关闭）和单个文件的大小上限
+    HttpServer &static_cache(size_t max_bytes, size_t max_file_size)
+    {
+    asset_cache_.set_capacity(max_bytes, max_file_size);
+    return *this;
+    }
+
+    // 本服务器的静态文件缓存，resp->File() 通过它打开文件
+    FileCache &get_file_cache()
+    { return file_cache_; }
+
+    // 开启本服务器响应的自动压缩：没有设置 Content-Encoding 的 String()、Json() 响应按 Accept-Encoding 选择 zstd、br 或 gzip
+    // 响应体小于 min_size 字节或 Content-Type 不在 mime_types 中时不压缩，同一进程中的其他服务器不受影响
+    HttpServer &compress(size_t min_size = 1024,
+                         const std::vector<std::string> &mime_types = ContentEncoding::default_mime_types())
+    {
+    content_encoding_.enable(min_size, mime_types);
+    return *this;
+    }
+
+    // 设置本服务器请求体解压的上限：解压后最多 max_size 字节，且不超过压缩数据大小的 max_ratio 倍（0 表示不限制）
+    // 超过上限时 req->body() 为空，json()、form()、form_kv() 也都为空，响应固定为 413
+    HttpServer &decompress_limit(size_t max_size, size_t max_ratio)
+    {
+    content_encoding_.set_decompress_limit(max_size, max_ratio);
+    return *this;
+    }
+
+    // 设置本服务器没有指定压缩级别的路由使用的压缩级别：响应体小于 large_size 字节时用 level，否则用 large_level
+    // 例如 compress_level(CompressLevel::FASTEST, 256 * 1024, CompressLevel::BEST)；单个路由用 BluePrint::set_compress_level 覆盖
+    HttpServer &compress_level(CompressLevel level, size_t large_size = 0,
+                               CompressLevel large_level = CompressLevel::DEFAULT)
+    {
+    content_encoding_.set_level_policy(level, large_size, large_level);
+    return *this;
+    }
+
+    // 本服务器的压缩配置，响应压缩时通过它协商编码和选择级别
+    const ContentEncoding &get_content_encoding() const
+    { return content_encoding_; }
+
     // 使用 TrackFunc 类型的跟踪函数
     using TrackFunc = std::function<void(HttpTask *server_task)>;
 
@@ -650,6 +726,9 @@ private:
     std::string default_route_; // 默认路由
     BluePrint blue_print_; // 内部 BluePrint 对象
     TrackFunc track_func_; // 跟踪函数
+    FileCache file_cache_; // 静态文件缓存（需要先于 asset_cache_ 构造）
+    AssetCache asset_cache_; // Static() 的热点资源内存缓存
+    ContentEncoding content_encoding_; // 响应压缩和请求体解压的配置
 };
 
 }  // namespace Yukino
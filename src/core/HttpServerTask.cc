@@ -2,10 +2,13 @@
 #include "workflow/HttpMessage.h"
 
 #include <arpa/inet.h>
+#include <climits>
+#include <cctype>
 
 #include "HttpServerTask.h"
 #include "HttpServer.h"
-#include "StrUtil.h"
+#include "HttpHeaderWriter.h"
+#include "ErrorCode.h"
 
 using namespace protocol;
 
@@ -19,14 +22,20 @@ HttpServerTask::HttpServerTask(CommService *service,
                                 ProcFunc& process) :
         WFServerTask(service, WFGlobal::get_scheduler(), process),
         req_is_alive_(false),
-        req_has_keep_alive_header_(false)
+        req_keep_alive_timeout_(-1),
+        req_keep_alive_max_(-1)
 {
+    // 请求数据从任务的内存池中分配
+    this->req.arena_ = &arena_;
+
     // 设置任务的回调函数
     WFServerTask::set_callback([this](HttpTask *task) {
         for(auto &cb : cb_list_)
         {
             cb(task);
         }
+        // 所有回调执行完毕，统一释放本次请求在内存池中分配的对象
+        arena_.reset();
     });
 }
 
@@ -38,75 +47,246 @@ void HttpServerTask::handle(int state, int error)
     // 如果任务状态是 WFT_STATE_TOREPLY（需要回复客户端）
     if (state == WFT_STATE_TOREPLY)
     {
+        req_keep_alive_timeout_ = -1;
+        req_keep_alive_max_ = -1;
+
         // 检查请求是否支持 Keep-Alive
         req_is_alive_ = this->req.is_keep_alive();
-        // 检查请求是否包含 Keep-Alive 头部
+        // 如果请求包含 Keep-Alive 头部，直接在解析缓冲区上解析其参数
         if (req_is_alive_ && this->req.has_keep_alive_header())
-        {
-            // 创建一个 HTTP 头部游标，用于解析请求头部
-            HttpHeaderCursor req_cursor(&this->req);
-            struct HttpMessageHeader header{};
-
-            // 设置要查找的头部名称为 "Keep-Alive"
-            header.name = "Keep-Alive";
-            header.name_len = strlen("Keep-Alive");
-            // 在请求头部中查找 "Keep-Alive" 头部
-            req_has_keep_alive_header_ = req_cursor.find(&header);
-            // 如果找到 "Keep-Alive" 头部，保存其值
-            if (req_has_keep_alive_header_)
-            {
-                req_keep_alive_.assign((const char *) header.value,
-                                        header.value_len);
-            }
-        }
+            parse_keep_alive(this->req.header_view("Keep-Alive"));
     }
     // 调用父类的 handle 方法，继续处理任务
     this->WFServerTask::handle(state, error);
 }
 
+// 去掉首尾的空白字符
+static inline StringPiece trim_view(StringPiece piece)
+{
+    while (!piece.empty() && isspace(static_cast<unsigned char>(piece[0])))
+        piece.remove_prefix(1);
+    while (!piece.empty() && isspace(static_cast<unsigned char>(piece[static_cast<int>(piece.size()) - 1])))
+        piece.remove_suffix(1);
+    return piece;
+}
+
+// 将非负整数解析为 int，遇到非数字字符即停止（与 atoi 的行为一致）
+static inline int view_to_int(const StringPiece &piece)
+{
+    long val = 0;
+    for (size_t i = 0; i < piece.size() && isdigit(static_cast<unsigned char>(piece[i])); i++)
+    {
+        val = val * 10 + (piece[i] - '0');
+        if (val > INT_MAX)
+            return INT_MAX;
+    }
+    return static_cast<int>(val);
+}
+
+// 解析 Keep-Alive 头部，每个参数只取第一次出现的值
+void HttpServerTask::parse_keep_alive(const StringPiece &value)
+{
+    const char *pos = value.data();
+    const char *end = value.data() + value.size();
+    while (pos < end)
+    {
+        const char *comma = static_cast<const char *>(memchr(pos, ',', end - pos));
+        if (!comma)
+            comma = end;
+
+        // 没有 '=' 的参数值视为 0
+        StringPiece key(pos, comma - pos);
+        StringPiece val;
+        const char *eq = static_cast<const char *>(memchr(pos, '=', comma - pos));
+        if (eq)
+        {
+            key = StringPiece(pos, eq - pos);
+            val = trim_view(StringPiece(eq + 1, comma - eq - 1));
+        }
+        key = trim_view(key);
+
+        if (key.size() == 7 && strncasecmp(key.data(), "timeout", 7) == 0)
+        {
+            if (req_keep_alive_timeout_ < 0)
+                req_keep_alive_timeout_ = view_to_int(val);
+        }
+        else if (key.size() == 3 && strncasecmp(key.data(), "max", 3) == 0)
+        {
+            if (req_keep_alive_max_ < 0)
+                req_keep_alive_max_ = view_to_int(val);
+        }
+
+        pos = comma + 1;
+    }
+}
+
+namespace
+{
+
+// message_out 需要特殊处理的响应头
+enum OutHeader
+{
+    OUT_HEADER_OTHER,
+    OUT_HEADER_DATE,
+    OUT_HEADER_CONNECTION,
+    OUT_HEADER_CONTENT_TYPE,
+    OUT_HEADER_CONTENT_LENGTH,
+    OUT_HEADER_TRANSFER_ENCODING,
+};
+
+// 按长度分派识别响应头名字
+OutHeader to_out_header(const std::string &name)
+{
+    switch (name.size())
+    {
+    case 4:
+        if (strcasecmp(name.c_str(), "Date") == 0)
+            return OUT_HEADER_DATE;
+        break;
+    case 10:
+        if (strcasecmp(name.c_str(), "Connection") == 0)
+            return OUT_HEADER_CONNECTION;
+        break;
+    case 12:
+        if (strcasecmp(name.c_str(), "Content-Type") == 0)
+            return OUT_HEADER_CONTENT_TYPE;
+        break;
+    case 14:
+        if (strcasecmp(name.c_str(), "Content-Length") == 0)
+            return OUT_HEADER_CONTENT_LENGTH;
+        break;
+    case 17:
+        if (strcasecmp(name.c_str(), "Transfer-Encoding") == 0)
+            return OUT_HEADER_TRANSFER_ENCODING;
+        break;
+    default:
+        break;
+    }
+    return OUT_HEADER_OTHER;
+}
+
+// 忽略大小写查找子串
+bool contains_nocase(const std::string &str, const char *token)
+{
+    size_t len = strlen(token);
+    for (size_t i = 0; i + len <= str.size(); i++)
+    {
+        if (strncasecmp(str.c_str() + i, token, len) == 0)
+            return true;
+    }
+    return false;
+}
+
+}  // namespace
+
 // 在发送响应前，对响应做一些必须的设置，然后调用父类的发送接口
+// 所有响应头先统计总长度，再一次性序列化到内存池中的一块连续内存，编码时整块发送
 CommMessageOut *HttpServerTask::message_out()
 {
     // 获取当前任务的 HTTP 响应对象
     HttpResp *resp = this->get_resp();
 
+    // 请求体解压超过上限时，丢弃处理函数写入的内容，回复 413
+    if (this->get_req()->body_too_large())
+    {
+        resp->headers.clear();
+        resp->clear_output_body();
+        resp->chunked_body_ = false;
+        resp->Error(StatusUncompressTooLarge);
+    }
+
+    // 以 chunked 编码发送的响应体在这里结束，之后不会再追加数据
+    if (resp->chunked_body_)
+    {
+        resp->append_output_body_nocopy("0\r\n\r\n", 5);
+        resp->chunked_body_ = false;
+    }
+
     // 获取响应头的引用
     std::map<std::string, std::string, MapStringCaseLess> &headers = resp->headers;
 
-    // 如果没有设置 Content-Type 头部，设置默认值为 "text/plain"
-    if(headers.find("Content-Type") == headers.end())
+    bool has_content_type = false;
+    bool has_date = false;
+    bool has_connection = resp->has_connection_header();
+    bool has_content_length = resp->has_content_length_header();
+    bool is_chunked = resp->is_chunked();
+    bool is_alive = req_is_alive_;
+    if (has_connection)
+        is_alive = resp->is_keep_alive();
+
+    // 统计自定义响应头的长度，同时识别需要特殊处理的响应头
+    size_t size = 0;
+    for (auto &header_kv : headers)
     {
-        headers["Content-Type"] = "text/plain";
+        size += HttpHeaderWriter::line_size(header_kv.first, header_kv.second);
+        switch (to_out_header(header_kv.first))
+        {
+        case OUT_HEADER_DATE:
+            has_date = true;
+            break;
+        case OUT_HEADER_CONTENT_TYPE:
+            has_content_type = true;
+            break;
+        case OUT_HEADER_CONTENT_LENGTH:
+            has_content_length = true;
+            break;
+        case OUT_HEADER_TRANSFER_ENCODING:
+            if (contains_nocase(header_kv.second, "chunked"))
+                is_chunked = true;
+            break;
+        case OUT_HEADER_CONNECTION:
+            has_connection = true;
+            if (contains_nocase(header_kv.second, "close"))
+                is_alive = false;
+            else if (contains_nocase(header_kv.second, "keep-alive"))
+                is_alive = true;
+            break;
+        default:
+            break;
+        }
     }
 
-    // 如果没有设置 Date 头部，设置为当前时间
-    if(headers.find("Date") == headers.end())
+    // 路由的静态响应头，响应中设置了同名响应头时逐个跳过
+    bool route_headers_overridden = false;
+    if (route_headers_)
     {
-        headers["Date"] = Timestamp::now().to_format_str("%a, %d %b %Y %H:%M:%S GMT");
+        if (!headers.empty())
+        {
+            for (const std::string &name : route_headers_->names)
+            {
+                if (headers.find(name) != headers.end())
+                {
+                    route_headers_overridden = true;
+                    break;
+                }
+            }
+        }
+        size += route_headers_->block.size();
     }
 
-    // 定义一个 HTTP 消息头部结构
-    struct HttpMessageHeader header;
+    // 如果没有设置 Content-Type 头部，设置默认值为 "text/plain"
+    static const StringPiece default_content_type("text/plain");
+    if (!has_content_type)
+        size += HttpHeaderWriter::line_size("Content-Type", default_content_type);
 
-    // 遍历所有自定义头部，添加到响应中
-    for(auto &header_kv : headers)
+    // 如果没有设置 Date 头部，使用当前线程每秒缓存一次的时间
+    StringPiece date;
+    if (!has_date)
     {
-        header.name = header_kv.first.c_str();
-        header.name_len = header_kv.first.size();
-        header.value = header_kv.second.c_str();
-        header.value_len = header_kv.second.size();
-        resp->protocol::HttpResponse::add_header(&header);
+        date = HttpHeaderWriter::http_date();
+        size += HttpHeaderWriter::line_size("Date", date);
     }
 
-    // 遍历所有 Cookie，添加到响应中
-    for(auto &cookie : resp->cookies())
+    // Cookie 需要先序列化才能知道长度
+    std::vector<std::string> cookie_strs;
+    if (!resp->cookies().empty())
     {
-        std::string cookie_str = cookie.dump();
-        header.name = "Set-Cookie";
-        header.name_len = 10;
-        header.value = cookie_str.c_str();
-        header.value_len = cookie_str.size();
-        resp->protocol::HttpResponse::add_header(&header);
+        cookie_strs.reserve(resp->cookies().size());
+        for (auto &cookie : resp->cookies())
+        {
+            cookie_strs.emplace_back(cookie.dump());
+            size += HttpHeaderWriter::line_size("Set-Cookie", cookie_strs.back());
+        }
     }
 
     // 如果没有设置 HTTP 版本，设置默认值为 "HTTP/1.1"
@@ -128,64 +308,25 @@ CommMessageOut *HttpServerTask::message_out()
     }
 
     // 如果没有设置分块传输编码且没有设置 Content-Length 头部，设置 Content-Length
-    if (!resp->is_chunked() && !resp->has_content_length_header())
+    char length_buf[32];
+    StringPiece content_length;
+    if (!is_chunked && !has_content_length)
     {
-        char buf[32];
-        header.name = "Content-Length";
-        header.name_len = strlen("Content-Length");
-        header.value = buf;
-        header.value_len = sprintf(buf, "%zu", resp->get_output_body_size());
-        resp->protocol::HttpResponse::add_header(&header);
+        int len = snprintf(length_buf, sizeof length_buf, "%zu", resp->get_output_body_size());
+        content_length = StringPiece(length_buf, len);
+        size += HttpHeaderWriter::line_size("Content-Length", content_length);
     }
 
     // 确定是否保持连接
-    bool is_alive;
-
-    if (resp->has_connection_header())
-        is_alive = resp->is_keep_alive();
-    else
-        is_alive = req_is_alive_;
-
     if (!is_alive)
         this->keep_alive_timeo = 0;
     else
     {
-        // 如果请求包含 Keep-Alive 头部，解析其参数
-        if (req_has_keep_alive_header_)
-        {
-            int flag = 0;
-            std::vector<std::string> params = StrUtil::split(req_keep_alive_, ',');
-
-            for (const auto &kv: params)
-            {
-                std::vector<std::string> arr = StrUtil::split(kv, '=');
-                if (arr.size() < 2)
-                    arr.emplace_back("0");
-
-                std::string key = StrUtil::strip(arr[0]);
-                std::string val = StrUtil::strip(arr[1]);
-                if (!(flag & 1) && strcasecmp(key.c_str(), "timeout") == 0)
-                {
-                    flag |= 1;
-                    // 设置 Keep-Alive 超时时间
-                    this->keep_alive_timeo = 1000 * atoi(val.c_str());
-                    if (flag == 3)
-                        break;
-                } else if (!(flag & 2) && strcasecmp(key.c_str(), "max") == 0)
-                {
-                    flag |= 2;
-                    // 如果请求的连接数达到最大值，关闭连接
-                    if (this->get_seq() >= atoi(val.c_str()))
-                    {
-                        this->keep_alive_timeo = 0;
-                        break;
-                    }
-
-                    if (flag == 3)
-                        break;
-                }
-            }
-        }
+        // 请求的 Keep-Alive 头部中的参数，max 达到上限时直接关闭连接
+        if (req_keep_alive_max_ >= 0 && this->get_seq() >= req_keep_alive_max_)
+            this->keep_alive_timeo = 0;
+        else if (req_keep_alive_timeout_ >= 0)
+            this->keep_alive_timeo = 1000 * req_keep_alive_timeout_;
 
         // 限制 Keep-Alive 超时时间不超过最大值
         if ((unsigned int) this->keep_alive_timeo > HTTP_KEEPALIVE_MAX)
@@ -193,23 +334,57 @@ CommMessageOut *HttpServerTask::message_out()
     }
 
     // 如果没有设置 Connection 头部，添加默认值
-    if (!resp->has_connection_header())
+    StringPiece connection;
+    if (!has_connection)
+    {
+        connection = this->keep_alive_timeo == 0 ? StringPiece("close") : StringPiece("Keep-Alive");
+        size += HttpHeaderWriter::line_size("Connection", connection);
+    }
+
+    // 一次性写入所有响应头
+    char *block = static_cast<char *>(arena_.allocate(size, 1));
+    char *pos = block;
+
+    if (!has_content_type)
+        pos = HttpHeaderWriter::write_line(pos, "Content-Type", default_content_type);
+    if (!has_date)
+        pos = HttpHeaderWriter::write_line(pos, "Date", date);
+
+    for (auto &header_kv : headers)
+        pos = HttpHeaderWriter::write_line(pos, header_kv.first, header_kv.second);
+
+    if (route_headers_)
     {
-        header.name = "Connection";
-        header.name_len = 10;
-        if (this->keep_alive_timeo == 0)
+        if (!route_headers_overridden)
         {
-            header.value = "close";
-            header.value_len = 5;
-        } else
+            memcpy(pos, route_headers_->block.data(), route_headers_->block.size());
+            pos += route_headers_->block.size();
+        }
+        else
         {
-            header.value = "Keep-Alive";
-            header.value_len = 10;
+            for (size_t i = 0; i < route_headers_->names.size(); i++)
+            {
+                if (headers.find(route_headers_->names[i]) != headers.end())
+                    continue;
+                size_t begin = route_headers_->offsets[i];
+                size_t len = route_headers_->offsets[i + 1] - begin;
+                memcpy(pos, route_headers_->block.data() + begin, len);
+                pos += len;
+            }
         }
-
-        resp->protocol::HttpResponse::add_header(&header);
     }
 
+    for (const std::string &cookie_str : cookie_strs)
+        pos = HttpHeaderWriter::write_line(pos, "Set-Cookie", cookie_str);
+
+    if (!content_length.empty())
+        pos = HttpHeaderWriter::write_line(pos, "Content-Length", content_length);
+    if (!connection.empty())
+        pos = HttpHeaderWriter::write_line(pos, "Connection", connection);
+
+    // 被覆盖的静态响应头没有写入，实际长度可能小于预估长度
+    resp->header_block_ = StringPiece(block, pos - block);
+
     // 调用父类的 message_out 方法，完成消息构建
     return this->WFServerTask::message_out();
 }
@@ -283,4 +458,27 @@ bool HttpServerTask::close_flag() const
     return server->close_flag_;
 }
 
+bool HttpServerTask::is_ssl() const
+{
+    // 服务器配置了 SSL 证书时所有连接都经过 TLS
+    return server && server->get_ssl_ctx() != nullptr;
+}
+
+void HttpServerTask::push_handler_gate(std::function<void()> &&handler)
+{
+    deferred_handler_ = std::move(handler);
+    // gate 任务排在当前序列中，它的回调决定是否执行处理函数
+    **this << handler_gate_;
+    handler_gate_ = nullptr;
+}
+
+void HttpServerTask::resume_handler()
+{
+    // 只执行一次，处理函数添加的任务接在 gate 任务之后
+    std::function<void()> handler = std::move(deferred_handler_);
+    deferred_handler_ = nullptr;
+    if (handler)
+        handler();
+}
+
 } // namespace Yukino
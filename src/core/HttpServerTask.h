@@ -3,11 +3,14 @@
 
 #include "HttpMsg.h"
 #include "Noncopyable.h"
+#include "Arena.h"
 
 namespace Yukino
 {
 
 class HttpServer;
+class Router;
+struct RouteHeaders;
 
 /**
  * @brief HttpServerTask 类，表示 HTTP 服务器任务
@@ -30,6 +33,8 @@ public:
 
     // 声明 HttpServer 为友元类
     friend class HttpServer;
+    // 声明 Router 为友元类，匹配路由时设置路由的静态响应头
+    friend class Router;
 
     /**
      * @brief 构造函数
@@ -55,15 +60,47 @@ public:
     void add_callback(ServerCallBack &&cb)
     { cb_list_.emplace_back(std::move(cb)); }
 
+    /**
+     * @brief 获取请求级内存池
+     * 
+     * 请求处理过程中的临时对象从这里分配，所有回调执行完毕后统一释放。
+     * 
+     * @return Arena* 内存池
+     */
+    Arena *arena()
+    { return &arena_; }
+
+    /**
+     * @brief 获取处理该请求的服务器，服务器级的配置（如文件缓存、压缩）从这里读取
+     * 
+     * @return HttpServer* 创建该任务的服务器
+     */
+    HttpServer *get_server() const
+    { return server; }
+
+    /**
+     * @brief 获取匹配路由的静态响应头
+     * 
+     * @return const RouteHeaders* 没有匹配的路由或路由没有静态响应头时返回 nullptr
+     */
+    const RouteHeaders *route_headers() const
+    { return route_headers_; }
+
     /**
      * @brief 获取响应对象的偏移量
      * 
+     * 偏移量是常量，只在第一次调用时构造一个临时任务计算，之后 task_of(resp) 不再有额外开销
+     * 
      * @return size_t 响应对象的偏移量
      */
     static size_t get_resp_offset()
     {
-        HttpServerTask task(nullptr);
-        return task.resp_offset();
+        static const size_t offset = []
+        {
+            HttpServerTask task(nullptr);
+            return task.resp_offset();
+        }();
+        return offset;
     }
 
     /**
@@ -87,6 +124,49 @@ public:
      */
     bool close_flag() const;
 
+    /**
+     * @brief 连接是否使用 TLS
+     * 
+     * @return bool 服务器配置了 SSL 证书时返回 true
+     */
+    bool is_ssl() const;
+
+    /**
+     * @brief 推迟处理函数的执行
+     * 
+     * 由切面在 before 中调用（例如 ResponseCache 中等待同一个键的请求）：路由的包装函数不立即执行处理函数，
+     * 而是保存它并把 gate 任务加入序列，gate 的回调中调用 resume_handler() 才会执行，不调用则直接回复。
+     * 请求被之后的切面拦截时 gate 任务仍会执行，但没有保存处理函数，handler_deferred() 返回 false。
+     * 
+     * @param gate 尚未启动的任务
+     */
+    void defer_handler(SubTask *gate)
+    { handler_gate_ = gate; }
+
+    /**
+     * @brief 是否有切面推迟了处理函数
+     */
+    bool handler_gated() const
+    { return handler_gate_ != nullptr; }
+
+    /**
+     * @brief 保存被推迟的处理函数，并把 gate 任务加入序列，由路由的包装函数调用
+     * 
+     * @param handler 处理函数，请求被拦截时为空
+     */
+    void push_handler_gate(std::function<void()> &&handler);
+
+    /**
+     * @brief 是否保存了被推迟的处理函数（请求没有被之后的切面拦截）
+     */
+    bool handler_deferred() const
+    { return static_cast<bool>(deferred_handler_); }
+
+    /**
+     * @brief 在 gate 任务的回调中执行被推迟的处理函数
+     */
+    void resume_handler();
+
 protected:
     /**
      * @brief 处理任务状态
@@ -129,11 +209,22 @@ private:
             WFServerTask(nullptr, nullptr, proc)
     {}
 
+    /**
+     * @brief 解析请求的 Keep-Alive 头，如 "timeout=5, max=50"
+     * 
+     * @param value Keep-Alive 头的值
+     */
+    void parse_keep_alive(const StringPiece &value);
+
 private:
     bool req_is_alive_; // 请求是否存活
-    bool req_has_keep_alive_header_; // 请求是否包含 Keep-Alive 头
-    std::string req_keep_alive_; // Keep-Alive 头的值
+    int req_keep_alive_timeout_; // Keep-Alive 头中的 timeout 参数（秒），-1 表示没有
+    int req_keep_alive_max_; // Keep-Alive 头中的 max 参数，-1 表示没有
+    const RouteHeaders *route_headers_ = nullptr; // 匹配路由的静态响应头
+    SubTask *handler_gate_ = nullptr; // 推迟处理函数的 gate 任务
+    std::function<void()> deferred_handler_; // 被推迟的处理函数
     std::vector<ServerCallBack> cb_list_; // 回调函数列表
+    Arena arena_; // 请求级内存池
     HttpServer* server = nullptr; // 指向 HttpServer 的指针
 };
 
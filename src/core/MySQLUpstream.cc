@@ -0,0 +1,50 @@
+#include "workflow/Workflow.h"
+
+#include "MySQLUpstream.h"
+#include "UpstreamRegistry.h"
+
+using namespace Yukino;
+using namespace protocol;
+
+const MySQLUpstream *MySQLUpstream::add(const std::string &name, const std::string &url,
+                                        size_t max_connections, int retry_max)
+{
+    return UpstreamRegistry<MySQLUpstream>::add("mysql", "3306", name, url, max_connections, retry_max);
+}
+
+const MySQLUpstream *MySQLUpstream::get(const std::string &name)
+{
+    return UpstreamRegistry<MySQLUpstream>::get(name);
+}
+
+WFMySQLTask *MySQLUpstream::create_task(const std::string &sql, mysql_callback_t callback) const
+{
+    WFMySQLTask *task = WFTaskFactory::create_mysql_task(uri_, retry_max_, std::move(callback));
+    task->get_req()->set_query(sql);
+    return task;
+}
+
+ParallelWork *MySQLUpstream::create_batch(const std::vector<std::string> &sqls, BatchFunc func) const
+{
+    // 结果在每条查询的回调中移出（任务在回调之后就会销毁），并行任务结束时交给 func 后释放
+    auto *replies = new std::vector<MySQLReply>(sqls.size());
+    ParallelWork *pwork = Workflow::create_parallel_work([replies, func](const ParallelWork *)
+    {
+        func(replies);
+        delete replies;
+    });
+
+    for (size_t i = 0; i < sqls.size(); i++)
+    {
+        WFMySQLTask *task = this->create_task(sqls[i], [replies, i](WFMySQLTask *task)
+        {
+            MySQLReply &reply = (*replies)[i];
+            reply.state = task->get_state();
+            reply.error = task->get_error();
+            if (reply.state == WFT_STATE_SUCCESS)
+                reply.resp = std::move(*task->get_resp());
+        });
+        pwork->add_series(Workflow::create_series_work(task, nullptr));
+    }
+    return pwork;
+}
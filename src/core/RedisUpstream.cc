@@ -0,0 +1,111 @@
+#include "workflow/WFGlobal.h"
+#include "workflow/Workflow.h"
+
+#include "RedisUpstream.h"
+#include "UpstreamRegistry.h"
+
+using namespace Yukino;
+using namespace protocol;
+
+const RedisUpstream *RedisUpstream::add(const std::string &name, const std::string &url,
+                                        size_t max_connections, int retry_max)
+{
+    return UpstreamRegistry<RedisUpstream>::add("redis", "6379", name, url, max_connections, retry_max);
+}
+
+const RedisUpstream *RedisUpstream::get(const std::string &name)
+{
+    return UpstreamRegistry<RedisUpstream>::get(name);
+}
+
+WFRedisTask *RedisUpstream::create_task(const std::string &command, const std::vector<std::string> &params,
+                                        redis_callback_t callback) const
+{
+    WFRedisTask *task = WFTaskFactory::create_redis_task(uri_, retry_max_, std::move(callback));
+    task->get_req()->set_request(command, params);
+    return task;
+}
+
+ParallelWork *RedisUpstream::create_batch(const std::vector<RedisCommand> &commands, BatchFunc func) const
+{
+    return this->create_work(commands, std::move(func), false);
+}
+
+ParallelWork *RedisUpstream::create_sequence(const std::vector<RedisCommand> &commands, BatchFunc func) const
+{
+    return this->create_work(commands, std::move(func), true);
+}
+
+ParallelWork *RedisUpstream::create_work(const std::vector<RedisCommand> &commands, BatchFunc func,
+                                         bool sequential) const
+{
+    // 结果在每条命令的回调中保存（任务在回调之后就会销毁），并行任务结束时交给 func 后释放
+    auto *replies = new std::vector<RedisReply>(commands.size());
+    ParallelWork *pwork = Workflow::create_parallel_work([replies, func](const ParallelWork *)
+    {
+        func(replies);
+        delete replies;
+    });
+
+    SeriesWork *series = nullptr;
+
+    for (size_t i = 0; i < commands.size(); i++)
+    {
+        WFRedisTask *task = this->create_task(commands[i].command, commands[i].params,
+        [replies, i](WFRedisTask *task)
+        {
+            RedisReply &reply = (*replies)[i];
+            reply.state = task->get_state();
+            reply.error = task->get_error();
+            if (reply.state == WFT_STATE_SUCCESS)
+                task->get_resp()->get_result(reply.value);
+        });
+        if (!sequential || !series)
+        {
+            series = Workflow::create_series_work(task, nullptr);
+            pwork->add_series(series);
+        }
+        else
+        {
+            series->push_back(task);
+        }
+    }
+    return pwork;
+}
+
+Json RedisUpstream::reply_to_json(const RedisValue &value)
+{
+    switch (value.get_type())
+    {
+    case REDIS_REPLY_TYPE_STRING:
+    case REDIS_REPLY_TYPE_STATUS:
+        return Json(value.string_value());
+    case REDIS_REPLY_TYPE_INTEGER:
+        return Json(value.int_value());
+    case REDIS_REPLY_TYPE_ERROR:
+    {
+        Json json;
+        json["error"] = value.string_value();
+        return json;
+    }
+    case REDIS_REPLY_TYPE_ARRAY:
+    {
+        Json json = Json::Array();
+        for (size_t i = 0; i < value.arr_size(); i++)
+            json.push_back(reply_to_json(value.arr_at(i)));
+        return json;
+    }
+    default:
+        return Json(nullptr);
+    }
+}
+
+Json RedisUpstream::reply_to_json(const RedisReply &reply)
+{
+    if (reply.state == WFT_STATE_SUCCESS)
+        return reply_to_json(reply.value);
+
+    Json json;
+    json["errmsg"] = WFGlobal::get_error_string(reply.state, reply.error);
+    return json;
+}
@@ -0,0 +1,115 @@
+#ifndef YUKINO_REDISUPSTREAM_H_
+#define YUKINO_REDISUPSTREAM_H_
+
+#include "workflow/WFTaskFactory.h"
+#include "workflow/URIParser.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Json.h"
+#include "Noncopyable.h"
+
+namespace Yukino
+{
+
+template <typename T>
+class UpstreamRegistry;
+
+// 批量执行中的一条 Redis 命令
+struct RedisCommand
+{
+    std::string command;
+    std::vector<std::string> params;
+};
+
+// 批量执行中一条命令的结果，state 不是 WFT_STATE_SUCCESS 时 value 为 nil
+struct RedisReply
+{
+    int state = WFT_STATE_UNDEFINED;
+    int error = 0;
+    protocol::RedisValue value;
+};
+
+/**
+ * @brief 预先注册的 Redis 上游
+ *
+ * 服务器启动前通过 RedisUpstream::add 按名字注册，URL 只在注册时解析一次，之后每次请求直接使用解析结果。
+ * 注册表是进程级的，同一进程中的所有 HttpServer 共用同一组上游和连接池，上游名在进程内唯一。
+ * 指定了 max_connections 时会为该地址创建一个 workflow upstream，连接数上限只作用于这个上游，
+ * 超过上限的请求在连接池中排队，不影响其他地址的全局连接配置。
+ * 注册表在服务器运行期间只读，多个线程可以同时查找和使用。
+ */
+class RedisUpstream : public Noncopyable
+{
+public:
+    // 批量执行的回调，replies 与命令一一对应
+    using BatchFunc = std::function<void(std::vector<RedisReply> *replies)>;
+
+    /**
+     * @brief 注册 Redis 上游，对进程中的所有服务器生效
+     *
+     * @param name 上游名，只能包含字母、数字、'-' 和 '_'
+     * @param url Redis URL，如 redis://:password@127.0.0.1:6379/0
+     * @param max_connections 到该地址的最大连接数，0 表示使用 workflow 的全局配置
+     * @param retry_max 每条命令失败时的最大重试次数
+     * @return const RedisUpstream* 注册的上游，URL 无法解析、名字重复或不合法时返回 nullptr
+     */
+    static const RedisUpstream *add(const std::string &name, const std::string &url,
+                                    size_t max_connections = 0, int retry_max = 2);
+
+    // 按名字查找已注册的上游，不存在时返回 nullptr
+    static const RedisUpstream *get(const std::string &name);
+
+    const std::string &name() const
+    { return name_; }
+
+    // 创建一条命令的 Redis 任务，不重新解析 URL
+    WFRedisTask *create_task(const std::string &command, const std::vector<std::string> &params,
+                             redis_callback_t callback) const;
+
+    /**
+     * @brief 创建批量执行多条命令的并行任务
+     *
+     * 每条命令是一个独立的 Redis 任务，在该上游的连接池中同时发出，总耗时接近一次往返而不是所有命令耗时之和。
+     * 命令可能使用不同的连接，服务器执行的先后顺序不确定，只适用于互不依赖的命令（如多个 GET）。
+     * 所有命令完成后调用一次 func，结果顺序与 commands 相同。
+     */
+    ParallelWork *create_batch(const std::vector<RedisCommand> &commands, BatchFunc func) const;
+
+    /**
+     * @brief 创建按顺序执行多条命令的任务
+     *
+     * 所有命令在同一个序列中依次执行，上一条命令完成（无论成功与否）后才发出下一条，
+     * 用于相互依赖的命令（如先 SET 再 EXPIRE），总耗时为所有命令耗时之和。回调与 create_batch 相同。
+     */
+    ParallelWork *create_sequence(const std::vector<RedisCommand> &commands, BatchFunc func) const;
+
+    /**
+     * @brief 将任意类型的 Redis 回复转换为 JSON
+     *
+     * nil 为 null，整数为数值，字符串和状态为字符串，错误回复为 {"error": 错误信息}，数组递归转换
+     */
+    static Json reply_to_json(const protocol::RedisValue &value);
+
+    // 一条命令的结果转换为 JSON：成功时与 reply_to_json 相同，任务失败时为 {"errmsg": 错误信息}
+    static Json reply_to_json(const RedisReply &reply);
+
+private:
+    RedisUpstream() = default;
+
+    friend class UpstreamRegistry<RedisUpstream>;
+
+    // sequential 为 true 时所有命令放在同一个序列中，否则每条命令一个序列
+    ParallelWork *create_work(const std::vector<RedisCommand> &commands, BatchFunc func, bool sequential) const;
+
+private:
+    std::string name_;
+    ParsedURI uri_;
+    int retry_max_ = 2;
+};
+
+}  // namespace Yukino
+
+#endif  // YUKINO_REDISUPSTREAM_H_
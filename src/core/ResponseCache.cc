@@ -0,0 +1,497 @@
+#include "workflow/HttpUtil.h"
+#include "workflow/WFTaskFactory.h"
+
+#include <strings.h>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "ResponseCache.h"
+#include "HttpMsg.h"
+#include "HttpServerTask.h"
+#include "Noncopyable.h"
+#include "StringPiece.h"
+#include "StrUtil.h"
+
+using namespace Yukino;
+using namespace protocol;
+
+namespace
+{
+
+// 每个缓存项除数据外的估计开销（链表节点、哈希表节点、控制块）
+constexpr size_t ENTRY_OVERHEAD = 128;
+
+// 缓存的响应，命中的请求直接引用其中的数据，发送完毕前由响应持有引用
+struct CachedResponse : public Noncopyable
+{
+    int status = 0;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+};
+
+using ResponsePtr = std::shared_ptr<const CachedResponse>;
+
+// 从已经生成的响应中读取的结果
+struct Capture
+{
+    ResponsePtr response;    // 响应不能交给同一个键的其他请求时为空
+    bool storable = false;   // 能否放入缓存
+    bool pass = false;       // 该键的响应不能分享，有效期内不再合并请求
+};
+
+// 缓存键的一个字段：长度:内容，字段中出现任何字符都不会与相邻字段混淆
+void append_field(std::string *key, const StringPiece &field)
+{
+    key->append(std::to_string(field.size()));
+    key->push_back(':');
+    key->append(field.data(), field.size());
+}
+
+// 忽略大小写查找子串
+bool contains_nocase(const std::string &str, const char *token)
+{
+    size_t len = strlen(token);
+    for (size_t i = 0; i + len <= str.size(); i++)
+    {
+        if (strncasecmp(str.c_str() + i, token, len) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool equals_nocase(const StringPiece &a, const StringPiece &b)
+{
+    return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+// 只对当前连接有效的响应头，由 HttpServerTask::message_out 为每个响应重新生成
+bool is_per_connection(const std::string &name)
+{
+    return strcasecmp(name.c_str(), "Date") == 0 ||
+           strcasecmp(name.c_str(), "Connection") == 0 ||
+           strcasecmp(name.c_str(), "Keep-Alive") == 0;
+}
+
+void add_header(std::map<std::string, std::string, MapStringCaseLess> *headers,
+                const std::string &name, const std::string &value)
+{
+    std::string &dst = (*headers)[name];
+    if (!dst.empty())
+        dst.append(", ");
+    dst.append(value);
+}
+
+void send(const ResponsePtr &response, HttpResp *resp)
+{
+    resp->set_status(response->status);
+    for (const auto &header : response->headers)
+        resp->headers[header.first] = header.second;
+
+    if (!response->body.empty())
+    {
+        // 响应发送完毕前持有缓存项的引用
+        task_of(resp)->add_callback([response](HttpTask *) {});
+        resp->append_output_body_nocopy(response->body.data(), response->body.size());
+    }
+}
+
+}  // namespace
+
+class ResponseCache::Store : public Noncopyable
+{
+public:
+    Store(time_t ttl, size_t max_bytes, const std::vector<std::string> &vary, size_t shards) :
+        ttl_(ttl),
+        shard_max_bytes_(max_bytes / shards),
+        vary_(vary),
+        shards_(shards)
+    {
+    }
+
+    bool before(const HttpReq *req, HttpResp *resp, const std::shared_ptr<Store> &self);
+
+    void clear();
+
+    size_t bytes() const;
+
+private:
+    struct Entry
+    {
+        std::string key;
+        ResponsePtr response;  // 为空时表示该键的响应不能分享，有效期内不再合并请求
+        time_t expire;
+        size_t bytes;
+    };
+
+    using EntryList = std::list<Entry>;
+    using EntryMap = std::unordered_map<std::string, EntryList::iterator>;
+
+    // 等待第一个请求的响应的请求，result 由计数任务的回调释放
+    struct Waiter
+    {
+        WFCounterTask *counter;
+        ResponsePtr *result;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        EntryList lru;                 // 表头为最近使用的缓存项
+        EntryMap map;
+        std::unordered_map<std::string, std::vector<Waiter>> flights;  // 正在执行处理函数的键
+        size_t bytes = 0;
+    };
+
+    std::string make_key(const HttpReq *req) const;
+
+    Shard &shard_of(const std::string &key)
+    { return shards_[std::hash<std::string>()(key) % shards_.size()]; }
+
+    // 第一个请求的任务回调：保存响应并唤醒等待的请求
+    void finish(const std::string &key, HttpResp *resp);
+
+    Capture capture(HttpResp *resp) const;
+
+    // 响应的 Vary 是否都在缓存键中
+    bool vary_covered(const std::string &vary) const;
+
+    // 以下函数调用前需要加锁
+    void insert(Shard &shard, const std::string &key, const ResponsePtr &response);
+
+    void erase(Shard &shard, EntryMap::iterator it);
+
+    void evict(Shard &shard);
+
+private:
+    time_t ttl_;
+    size_t shard_max_bytes_;
+    std::vector<std::string> vary_;
+    std::vector<Shard> shards_;
+};
+
+std::string ResponseCache::Store::make_key(const HttpReq *req) const
+{
+    std::string key;
+    key.reserve(128);
+    append_field(&key, req->get_method());
+    append_field(&key, req->current_path());
+    for (const auto &kv : req->query_list())
+    {
+        append_field(&key, kv.first);
+        append_field(&key, kv.second);
+    }
+
+    // 查询参数的个数不固定，用字段中不会出现在开头的字符与请求头分隔
+    key.push_back('|');
+    append_field(&key, req->header_view("Accept-Encoding"));
+    for (const std::string &name : vary_)
+        append_field(&key, req->header_view(name));
+    return key;
+}
+
+bool ResponseCache::Store::before(const HttpReq *req, HttpResp *resp, const std::shared_ptr<Store> &self)
+{
+    std::string key = make_key(req);
+    Shard &shard = shard_of(key);
+    ResponsePtr cached;
+    WFCounterTask *counter = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it != shard.map.end())
+        {
+            if (it->second->expire > time(nullptr))
+            {
+                if (!it->second->response)
+                    return true;
+
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                cached = it->second->response;
+            }
+            else
+                erase(shard, it);
+        }
+
+        if (!cached)
+        {
+            auto flight = shard.flights.find(key);
+            if (flight == shard.flights.end())
+            {
+                shard.flights.emplace(key, std::vector<Waiter>());
+            }
+            else
+            {
+                // 处理函数推迟到计数任务之后，第一个请求的响应生成后计数，在它的回调中回复，
+                // 响应不能分享（自行发送的文件、Set-Cookie 等）时执行自己的处理函数
+                auto *result = new ResponsePtr;
+                counter = WFTaskFactory::create_counter_task(1, [result, resp](WFCounterTask *)
+                {
+                    HttpServerTask *server_task = task_of(resp);
+                    // 被之后的切面拦截的请求保留切面写入的响应
+                    if (server_task->handler_deferred())
+                    {
+                        if (*result)
+                            send(*result, resp);
+                        else
+                            server_task->resume_handler();
+                    }
+                    delete result;
+                });
+                flight->second.push_back(Waiter{counter, result});
+            }
+        }
+    }
+
+    if (cached)
+    {
+        send(cached, resp);
+        return false;
+    }
+
+    if (counter)
+    {
+        task_of(resp)->defer_handler(counter);
+        return true;
+    }
+
+    // 响应在任务回调中才完整（压缩、代理等都已完成），此时保存
+    std::shared_ptr<Store> store = self;
+    task_of(resp)->add_callback([store, key](HttpTask *task)
+    {
+        store->finish(key, task->get_resp());
+    });
+    return true;
+}
+
+void ResponseCache::Store::finish(const std::string &key, HttpResp *resp)
+{
+    Capture result = capture(resp);
+    Shard &shard = shard_of(key);
+    std::vector<Waiter> waiters;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto flight = shard.flights.find(key);
+        if (flight != shard.flights.end())
+        {
+            waiters.swap(flight->second);
+            shard.flights.erase(flight);
+        }
+
+        if (result.storable)
+            insert(shard, key, result.response);
+        else if (result.pass)
+            insert(shard, key, nullptr);
+    }
+
+    for (const Waiter &waiter : waiters)
+    {
+        *waiter.result = result.response;
+        waiter.counter->count();
+    }
+}
+
+Capture ResponseCache::Store::capture(HttpResp *resp) const
+{
+    Capture result;
+    const char *code = resp->get_status_code();
+    // 其他状态码（错误、重定向等）只属于这一次请求，等待的请求执行自己的处理函数
+    if (!code || atoi(code) != HttpStatusOK)
+        return result;
+
+    // 超过分片上限的响应放不进缓存，不复制响应体，有效期内该键的请求也不再合并
+    if (resp->get_output_body_size() > shard_max_bytes_)
+    {
+        result.pass = true;
+        return result;
+    }
+
+    // 处理函数自行发送了响应（发送文件、分块推送），没有完整的响应可以分享
+    std::vector<StringPiece> blocks;
+    if (!resp->get_output_body_blocks(&blocks))
+    {
+        result.pass = true;
+        return result;
+    }
+
+    // 处理函数设置的响应头，以及代理转发时保留在解析器中的上游响应头
+    std::map<std::string, std::string, MapStringCaseLess> headers;
+    for (const auto &header : resp->headers)
+        add_header(&headers, header.first, header.second);
+
+    HttpHeaderCursor cursor(resp);
+    std::string name;
+    std::string value;
+    while (cursor.next(name, value))
+        add_header(&headers, name, value);
+
+    auto response = std::make_shared<CachedResponse>();
+    response->status = HttpStatusOK;
+
+    bool shareable = resp->cookies().empty();
+    bool storable = true;
+    for (auto &header : headers)
+    {
+        if (is_per_connection(header.first))
+            continue;
+
+        if (strcasecmp(header.first.c_str(), "Set-Cookie") == 0)
+        {
+            shareable = false;
+        }
+        else if (strcasecmp(header.first.c_str(), "Cache-Control") == 0)
+        {
+            if (contains_nocase(header.second, "private"))
+                shareable = false;
+            if (contains_nocase(header.second, "no-store") || contains_nocase(header.second, "no-cache"))
+                storable = false;
+        }
+        else if (strcasecmp(header.first.c_str(), "Vary") == 0)
+        {
+            if (!vary_covered(header.second))
+                shareable = false;
+        }
+        response->headers.emplace_back(header.first, std::move(header.second));
+    }
+
+    if (!shareable)
+    {
+        result.pass = true;
+        return result;
+    }
+
+    response->body.reserve(resp->get_output_body_size());
+    for (const StringPiece &block : blocks)
+        response->body.append(block.data(), block.size());
+
+    result.response = std::move(response);
+    result.storable = storable && ttl_ > 0;
+    return result;
+}
+
+bool ResponseCache::Store::vary_covered(const std::string &vary) const
+{
+    for (const StringPiece &entry : StrUtil::split_piece<StringPiece>(vary, ','))
+    {
+        StringPiece name = StrUtil::trim(entry);
+        if (name.empty() || equals_nocase(name, "Accept-Encoding"))
+            continue;
+
+        bool found = false;
+        for (const std::string &key_name : vary_)
+        {
+            if (equals_nocase(name, key_name))
+            {
+                found = true;
+                break;
+            }
+        }
+
+        // "Vary: *" 不会与任何请求头相同
+        if (!found)
+            return false;
+    }
+    return true;
+}
+
+void ResponseCache::Store::insert(Shard &shard, const std::string &key, const ResponsePtr &response)
+{
+    auto it = shard.map.find(key);
+    if (it != shard.map.end())
+        erase(shard, it);
+
+    size_t bytes = key.size() * 2 + ENTRY_OVERHEAD;
+    if (response)
+    {
+        bytes += response->body.size();
+        for (const auto &header : response->headers)
+            bytes += header.first.size() + header.second.size();
+    }
+    if (bytes > shard_max_bytes_)
+        return;
+
+    shard.lru.push_front(Entry{key, response, time(nullptr) + ttl_, bytes});
+    shard.map.emplace(key, shard.lru.begin());
+    shard.bytes += bytes;
+    evict(shard);
+}
+
+void ResponseCache::Store::erase(Shard &shard, EntryMap::iterator it)
+{
+    shard.bytes -= it->second->bytes;
+    shard.lru.erase(it->second);
+    shard.map.erase(it);
+}
+
+void ResponseCache::Store::evict(Shard &shard)
+{
+    while (shard.bytes > shard_max_bytes_ && !shard.lru.empty())
+    {
+        shard.bytes -= shard.lru.back().bytes;
+        shard.map.erase(shard.lru.back().key);
+        shard.lru.pop_back();
+    }
+}
+
+void ResponseCache::Store::clear()
+{
+    for (Shard &shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.map.clear();
+        shard.lru.clear();
+        shard.bytes = 0;
+    }
+}
+
+size_t ResponseCache::Store::bytes() const
+{
+    size_t total = 0;
+    for (const Shard &shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.bytes;
+    }
+    return total;
+}
+
+ResponseCache::ResponseCache(time_t ttl, size_t max_bytes, const std::vector<std::string> &vary, size_t shards) :
+    store_(std::make_shared<Store>(ttl, max_bytes, vary, shards > 0 ? shards : 1))
+{
+}
+
+bool ResponseCache::before(const HttpReq *req, HttpResp *resp)
+{
+    const char *method = req->get_method();
+    if (!method || (strcasecmp(method, "GET") != 0 && strcasecmp(method, "HEAD") != 0))
+        return true;
+
+    // 条件请求和范围请求的响应（304、206）取决于不在缓存键中的请求头，不查找缓存也不合并
+    for (const char *name : {"If-None-Match", "If-Modified-Since", "Range", "If-Range"})
+    {
+        if (!req->header_view(name).empty())
+            return true;
+    }
+
+    return store_->before(req, resp, store_);
+}
+
+bool ResponseCache::after(const HttpReq *req, HttpResp *resp)
+{
+    return true;
+}
+
+void ResponseCache::clear()
+{
+    store_->clear();
+}
+
+size_t ResponseCache::bytes() const
+{
+    return store_->bytes();
+}
@@ -0,0 +1,70 @@
+#ifndef YUKINO_RESPONSECACHE_H_
+#define YUKINO_RESPONSECACHE_H_
+
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Aspect.h"
+
+namespace Yukino
+{
+
+/**
+ * @brief 响应缓存切面
+ *
+ * 缓存键由请求方法、请求路径、查询参数（query_list）、Accept-Encoding 和指定的请求头组成，
+ * 命中时直接用缓存的状态码、响应头和响应体回复，不再执行处理函数。缓存按键的哈希值分片，
+ * 每个分片有独立的锁、LRU 链表和字节数上限（总上限 / 分片数），过期的缓存项在查找时删除。
+ *
+ * 同一个键同时未命中的请求只有第一个执行处理函数，其余请求推迟各自的处理函数（见 HttpServerTask::defer_handler），
+ * 第一个请求的响应生成后直接使用它（single-flight），等待不占用线程。
+ *
+ * 只缓存 GET 和 HEAD 请求的 200 响应，带 Cache-Control: no-store 或 no-cache 的响应不缓存，
+ * 其他状态码的响应也不交给等待的请求。带 If-None-Match、If-Modified-Since、Range 或 If-Range 的请求不经过缓存。
+ * 带 Set-Cookie、Cache-Control: private 或 Vary 了缓存键之外的请求头的响应属于单个客户端，
+ * 处理函数自行发送的响应（发送文件、分块推送）也没有完整的内容可以分享，这时等待的请求执行自己的处理函数，
+ * 之后的一个有效期内该键的请求不再合并，直接执行处理函数。
+ *
+ * 可以作为路由的切面，如 svr.GET("/catalog", handler, ResponseCache(10))，但路由切面先于全局切面执行，
+ * 命中时会跳过通过 HttpServer::Use 注册的鉴权等切面，只适用于不依赖全局切面的路由。
+ * 有全局鉴权时应通过 HttpServer::Use 注册，并且需要在鉴权等切面之后注册，命中时前面的切面都已经执行过。
+ */
+class ResponseCache : public Aspect
+{
+public:
+    /**
+     * @brief 创建响应缓存
+     *
+     * @param ttl 缓存的有效期（秒），0 表示不缓存，只合并并发的相同请求
+     * @param max_bytes 缓存的总字节数上限（响应体、响应头和缓存键）
+     * @param vary 参与缓存键的请求头，Accept-Encoding 总是参与
+     * @param shards 分片数，越多锁竞争越少，单个响应的大小不能超过每个分片的上限
+     */
+    explicit ResponseCache(time_t ttl, size_t max_bytes = 64 * 1024 * 1024,
+                           const std::vector<std::string> &vary = {}, size_t shards = 16);
+
+    // 复制和移动都共享同一个缓存：路由切面在每个请求中复制一次，HttpServer::Use 从传入的对象移动构造
+    ResponseCache(const ResponseCache &other) = default;
+
+    bool before(const HttpReq *req, HttpResp *resp) override;
+
+    // 响应在 before 注册的任务回调中保存，这里不需要处理
+    bool after(const HttpReq *req, HttpResp *resp) override;
+
+    // 清空缓存，不影响正在执行的请求
+    void clear();
+
+    // 当前缓存占用的字节数
+    size_t bytes() const;
+
+private:
+    class Store;
+
+    std::shared_ptr<Store> store_;
+};
+
+}  // namespace Yukino
+
+#endif // YUKINO_RESPONSECACHE_H_
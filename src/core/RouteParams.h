@@ -0,0 +1,105 @@
+#ifndef YUKINO_ROUTEPARAMS_H_
+#define YUKINO_ROUTEPARAMS_H_
+
+#include <string>
+#include <vector>
+
+#include "StringPiece.h"
+#include "LazyString.h"
+
+namespace Yukino
+{
+
+/**
+ * @brief 单个路由参数
+ *
+ * key 指向注册路由时保存的路由字符串（生命周期与服务器相同），
+ * value 指向请求路径（生命周期与请求相同）。
+ */
+struct RouteParam
+{
+    StringPiece key;   // 参数名（已去掉花括号和空格）
+    LazyString value;  // 参数值
+};
+
+/**
+ * @brief 路由参数表
+ *
+ * 路由参数通常只有寥寥几个，前 INLINE_SIZE 个参数直接存放在对象内部，
+ * 只有超出时才会使用 std::vector，因此匹配路由时不会产生堆内存分配。
+ */
+class RouteParams
+{
+public:
+    static constexpr size_t INLINE_SIZE = 8; // 内联存放的参数个数
+
+    // 追加一个参数，同名参数以后出现的为准
+    void add(const StringPiece &key, const StringPiece &value)
+    {
+        RouteParam *param = find_param(key);
+        if (!param)
+        {
+            if (size_ < INLINE_SIZE)
+                param = &inline_[size_];
+            else
+            {
+                overflow_.emplace_back();
+                param = &overflow_.back();
+            }
+            param->key = key;
+            size_++;
+        }
+        param->value.set(value);
+    }
+
+    // 查找参数，不存在时返回 nullptr
+    const RouteParam *find(const StringPiece &key) const
+    { return const_cast<RouteParams *>(this)->find_param(key); }
+
+    // 按下标访问参数
+    const RouteParam &at(size_t index) const
+    { return index < INLINE_SIZE ? inline_[index] : overflow_[index - INLINE_SIZE]; }
+
+    // 参数个数
+    size_t size() const
+    { return size_; }
+
+    // 是否没有参数
+    bool empty() const
+    { return size_ == 0; }
+
+    // 清空所有参数（不释放内联存储）
+    void clear()
+    {
+        size_ = 0;
+        overflow_.clear();
+    }
+
+    // 将指向旧缓冲区的参数值平移到新缓冲区
+    void rebase(const char *old_base, size_t len, const char *new_base)
+    {
+        for (size_t i = 0; i < size_; i++)
+            const_cast<RouteParam &>(at(i)).value.rebase(old_base, len, new_base);
+    }
+
+private:
+    RouteParam *find_param(const StringPiece &key)
+    {
+        for (size_t i = 0; i < size_; i++)
+        {
+            RouteParam &param = const_cast<RouteParam &>(at(i));
+            if (param.key == key)
+                return &param;
+        }
+        return nullptr;
+    }
+
+private:
+    RouteParam inline_[INLINE_SIZE];  // 内联存储
+    std::vector<RouteParam> overflow_; // 超出内联容量的参数
+    size_t size_ = 0;                  // 参数个数
+};
+
+}  // namespace Yukino
+
+#endif // YUKINO_ROUTEPARAMS_H_
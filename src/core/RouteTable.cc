@@ -69,9 +69,35 @@ VerbHandler &RouteTableNode::find_or_create(const StringPiece &route, size_t cur
     }
 }
 
+VerbHandler *RouteTableNode::find_exact(const StringPiece &route, size_t cursor)
+{
+    // 与 find_or_create 相同的路径切分方式，找不到子节点时返回 nullptr 而不是创建
+    if (cursor == route.size())
+        return &verb_handler_;
+
+    if (cursor == 0 && route.as_string() == "/")
+    {
+        auto it = children_.find(route);
+        return it == children_.end() ? nullptr : it->second->find_exact(route, cursor + 1);
+    }
+
+    if (cursor == route.size() - 1 && route[cursor] == '/')
+        return &verb_handler_;
+
+    if (route[cursor] == '/')
+        cursor++;
+
+    size_t anchor = cursor;
+    while (cursor < route.size() && route[cursor] != '/')
+        cursor++;
+
+    auto it = children_.find(StringPiece(route.begin() + anchor, cursor - anchor));
+    return it == children_.end() ? nullptr : it->second->find_exact(route, cursor);
+}
+
 RouteTableNode::iterator RouteTableNode::find(const StringPiece &route, size_t cursor,
-                                              std::map<std::string, std::string> &route_params,
-                                              std::string &route_match_path) const
+                                              RouteParams &route_params,
+                                              StringPiece &route_match_path) const
 {
     assert(cursor >= 0); // 确保游标位置有效
 
@@ -81,7 +107,7 @@ RouteTableNode::iterator RouteTableNode::find(const StringPiece &route, size_t c
         // 如果当前节点有处理器或者没有子节点，则认为找到了匹配的路由
         if (!verb_handler_.verb_handler_map.empty() || children_.empty())
         {
-            return iterator{this, route, verb_handler_}; // 返回当前节点的迭代器
+            return iterator{this, route, &verb_handler_}; // 返回当前节点的迭代器
         }
     }
 
@@ -93,13 +119,13 @@ RouteTableNode::iterator RouteTableNode::find(const StringPiece &route, size_t c
         {
             if (it->second->verb_handler_.verb_handler_map.empty())
                 spdlog::error("[YUKINO] handler nullptr");
-            return iterator{it->second, route, it->second->verb_handler_}; // 返回通配符子节点的迭代器
+            return iterator{it->second, route, &it->second->verb_handler_}; // 返回通配符子节点的迭代器
         }
     }
 
     // 如果到达路由字符串的末尾，且当前节点没有处理器
     if (cursor == route.size() && verb_handler_.verb_handler_map.empty())
-        return iterator{nullptr, route, verb_handler_}; // 返回空迭代器
+        return iterator{nullptr, route, nullptr}; // 返回空迭代器
 
     // 处理根路径 "/"
     if (cursor == 0 && route.as_string() == "/")
@@ -140,9 +166,8 @@ RouteTableNode::iterator RouteTableNode::find(const StringPiece &route, size_t c
             match.remove_suffix(1); // 去掉通配符
             if (mid.starts_with(match)) // 如果路径部分以通配符匹配
             {
-                StringPiece match_path(route.data() + cursor); // 提取匹配路径
-                route_match_path = mid.as_string() + match_path.as_string(); // 构造完整匹配路径
-                return iterator{kv.second, route, kv.second->verb_handler_}; // 返回匹配的迭代器
+                route_match_path = StringPiece(mid.data(), route.size() - anchor); // 匹配路径为从当前段开始的剩余部分
+                return iterator{kv.second, route, &kv.second->verb_handler_}; // 返回匹配的迭代器
             }
         }
 
@@ -154,7 +179,7 @@ RouteTableNode::iterator RouteTableNode::find(const StringPiece &route, size_t c
             while (param[j] == ' ') j--; // 去掉尾部空格
 
             param.shrink(i, param.size() - 1 - j); // 去掉多余空格
-            route_params[param.as_string()] = mid.as_string(); // 将路径参数添加到路由参数映射中
+            route_params.add(param, mid); // 将路径参数添加到路由参数表中（均为视图，不拷贝）
             return kv.second->find(route, cursor, route_params, route_match_path); // 递归查找
         }
     }
@@ -203,6 +228,11 @@ void RouteTableNode::print_node_arch()
 
 VerbHandler &RouteTable::find_or_create(const char *route)
 {
+    // 路由树发生变化，扁平表失效，需要重新冻结
+    frozen_ = false;
+    flat_nodes_.clear();
+    flat_edges_.clear();
+
     // 使用指针防止迭代器失效
     // StringPiece 只是一个观察者，因此我们需要存储字符串
     StringPiece route_piece(route);
@@ -221,3 +251,153 @@ VerbHandler &RouteTable::find_or_create(const char *route)
 
 
 
+
+void RouteTable::freeze()
+{
+    flat_nodes_.clear();
+    flat_edges_.clear();
+
+    // 按层序遍历分配下标，使兄弟节点在数组中相邻
+    std::vector<const RouteTableNode *> order;
+    order.push_back(&root_);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const RouteTableNode *tree_node = order[i];
+        FlatNode node;
+        node.node = tree_node;
+        node.has_handler = !tree_node->verb_handler_.verb_handler_map.empty();
+        node.star_child = -1;
+
+        // 静态子边：std::map 已按 StringPiece 排好序，直接顺序写入即可二分
+        node.edge_begin = flat_edges_.size();
+        node.edge_count = tree_node->children_.size();
+        for (auto &kv : tree_node->children_)
+        {
+            uint32_t child = order.size();
+            order.push_back(kv.second);
+            flat_edges_.push_back(FlatEdge{kv.first, child, FlatEdge::STATIC});
+            if (kv.first == StringPiece("*"))
+                node.star_child = child;
+        }
+
+        // 通配符/参数子边：预先剥离 '*'、花括号和空格，匹配时无需再处理
+        node.dyn_begin = flat_edges_.size();
+        for (uint32_t k = 0; k < node.edge_count; k++)
+        {
+            const FlatEdge edge = flat_edges_[node.edge_begin + k];
+            StringPiece label(edge.label);
+            if (!label.empty() && label[label.size() - 1] == '*')
+            {
+                label.remove_suffix(1);
+                flat_edges_.push_back(FlatEdge{label, edge.child, FlatEdge::WILDCARD});
+            }
+            else if (label.size() > 2 && label[0] == '{' && label[label.size() - 1] == '}')
+            {
+                size_t left = 1;
+                size_t right = label.size() - 2;
+                while (left <= right && label[left] == ' ') left++;
+                while (right >= left && label[right] == ' ') right--;
+                StringPiece name(label.data() + left, left <= right ? right - left + 1 : 0);
+                flat_edges_.push_back(FlatEdge{name, edge.child, FlatEdge::PARAM});
+            }
+        }
+        node.dyn_count = flat_edges_.size() - node.dyn_begin;
+        flat_nodes_.push_back(node);
+    }
+    frozen_ = true;
+}
+
+int32_t RouteTable::find_static_child(const FlatNode &node, const StringPiece &label) const
+{
+    size_t lo = node.edge_begin;
+    size_t hi = node.edge_begin + node.edge_count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = flat_edges_[mid].label.compare(label);
+        if (cmp == 0)
+            return flat_edges_[mid].child;
+        if (cmp < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return -1;
+}
+
+RouteTableNode::iterator RouteTable::flat_find(uint32_t index,
+                                               const StringPiece &route,
+                                               size_t cursor,
+                                               RouteParams &route_params,
+                                               StringPiece &route_match_path) const
+{
+    const FlatNode &node = flat_nodes_[index];
+
+    // 已经到达路由字符串的末尾
+    if (cursor == route.size())
+    {
+        if (node.has_handler || node.edge_count == 0)
+            return RouteTableNode::iterator{node.node, route, &node.node->verb_handler_};
+
+        // 没有处理器但有 "*" 子节点，交给通配符处理
+        if (node.star_child >= 0)
+        {
+            const FlatNode &star = flat_nodes_[node.star_child];
+            if (!star.has_handler)
+                spdlog::error("[YUKINO] handler nullptr");
+            return RouteTableNode::iterator{star.node, route, &star.node->verb_handler_};
+        }
+        return end();
+    }
+
+    // 处理根路径 "/"
+    if (cursor == 0 && route.size() == 1 && route[0] == '/')
+    {
+        int32_t child = find_static_child(node, route);
+        if (child >= 0)
+        {
+            auto it = flat_find(child, route, 1, route_params, route_match_path);
+            if (it != end())
+                return it;
+        }
+    }
+
+    if (route[cursor] == '/')
+        cursor++; // 跳过路径中的 "/"
+
+    size_t anchor = cursor;
+    while (cursor < route.size() && route[cursor] != '/')
+        cursor++; // 找到下一个 "/"
+
+    StringPiece mid(route.data() + anchor, cursor - anchor); // 提取路径中间部分
+
+    // 优先精确匹配静态子节点
+    int32_t child = find_static_child(node, mid);
+    if (child >= 0)
+    {
+        auto it = flat_find(child, route, cursor, route_params, route_match_path);
+        if (it != end())
+            return it;
+    }
+
+    // 依次尝试通配符和路径参数
+    for (uint32_t i = 0; i < node.dyn_count; i++)
+    {
+        const FlatEdge &edge = flat_edges_[node.dyn_begin + i];
+        if (edge.kind == FlatEdge::WILDCARD)
+        {
+            if (mid.starts_with(edge.label))
+            {
+                route_match_path = StringPiece(mid.data(), route.size() - anchor);
+                const FlatNode &star = flat_nodes_[edge.child];
+                return RouteTableNode::iterator{star.node, route, &star.node->verb_handler_};
+            }
+        }
+        else
+        {
+            route_params.add(edge.label, mid); // 参数名在冻结时已解析好
+            return flat_find(edge.child, route, cursor, route_params, route_match_path);
+        }
+    }
+    return end();
+}
@@ -2,12 +2,16 @@
 #define YUKINO_ROUTETABLE_H_
 
 #include <vector>
+#include <map>
+#include <set>
+#include <cstdint>
 #include <memory>
 #include <cassert>
 #include <unordered_map>
 
 #include "StringPiece.h"
 #include "VerbHandler.h"
+#include "RouteParams.h"
 
 namespace Yukino
 {
@@ -24,7 +28,7 @@ public:
     {
         const RouteTableNode *ptr; // 指向当前节点
         StringPiece first;        // 路由路径（客户端访问的路径）
-        VerbHandler second;       // 动词处理器
+        const VerbHandler *second; // 动词处理器（指向节点内部，避免每次匹配都拷贝整张处理器表）
 
         iterator *operator->()
         { return this; }
@@ -39,15 +43,18 @@ public:
     // 查找或创建路由处理器
     VerbHandler &find_or_create(const StringPiece &route, size_t cursor);
 
+    // 按注册时的路径查找路由处理器，不存在时返回 nullptr，不修改路由树
+    VerbHandler *find_exact(const StringPiece &route, size_t cursor);
+
     // 获取迭代器的结束位置
     iterator end() const
-    { return iterator{nullptr, StringPiece(), VerbHandler()}; }
+    { return iterator{nullptr, StringPiece(), nullptr}; }
 
     // 查找路由并返回迭代器
     iterator find(const StringPiece &route,
                   size_t cursor,
-                  std::map<std::string, std::string> &route_params,
-                  std::string &route_match_path) const;
+                  RouteParams &route_params,
+                  StringPiece &route_match_path) const;
 
     // 遍历所有路由（叶子节点）并调用回调函数
     // prefix为叶子节点的路径前缀（包括叶子节点的路径部分），通过递归不断叠加，最后通过func函数传递
@@ -61,6 +68,8 @@ public:
 private:
     VerbHandler verb_handler_; // 动词处理器
     std::map<StringPiece, RouteTableNode *> children_; // 子节点映射
+
+    friend class RouteTable; // 冻结时需要读取树的内部结构
 };
 
 // 遍历所有路由并调用回调函数
@@ -86,14 +95,31 @@ void RouteTableNode::all_routes(const Func &func, std::string prefix) const
 class RouteTable : public Noncopyable
 { 
 public:
-    // 查找或创建路由处理器
+    // 查找或创建路由处理器（注册新路由会使已冻结的扁平表失效）
     VerbHandler &find_or_create(const char *route);
 
+    // 按注册时的路径查找路由处理器，不存在时返回 nullptr
+    // 不修改路由树，冻结后的扁平表仍然有效（扁平节点直接引用树节点中的处理器）
+    VerbHandler *find_exact(const StringPiece &route)
+    { return root_.find_exact(route, 0); }
+
     // 查找路由并返回迭代器
+    // 冻结后走扁平数组匹配，未冻结时回退到原始的路由树
     RouteTableNode::iterator find(const StringPiece &route, 
-                                  std::map<std::string, std::string> &route_params,
-                                  std::string &route_match_path) const
-    { return root_.find(route, 0, route_params, route_match_path); }
+                                  RouteParams &route_params,
+                                  StringPiece &route_match_path) const
+    {
+        if (frozen_)
+            return flat_find(0, route, 0, route_params, route_match_path);
+        return root_.find(route, 0, route_params, route_match_path);
+    }
+
+    // 将路由树编译为连续存放的扁平节点数组，服务器启动时调用
+    // 冻结后的匹配过程只做下标跳转和 StringPiece 比较，不再访问 std::map
+    void freeze();
+
+    // 是否已经冻结
+    bool frozen() const { return frozen_; }
 
     // 遍历所有路由并调用回调函数
     template<typename Func>
@@ -110,9 +136,45 @@ public:
     // 打印节点结构（用于测试）
     void print_node_arch() { root_.print_node_arch(); }
 
+private:
+    // 扁平节点：子边在 flat_edges_ 中连续存放
+    struct FlatNode
+    {
+        const RouteTableNode *node; // 对应的路由树节点（迭代器和处理器都指向它）
+        uint32_t edge_begin;        // 静态子边起始下标，按标签排序，可二分查找
+        uint32_t edge_count;        // 静态子边数量
+        uint32_t dyn_begin;         // 通配符/参数子边起始下标，保持原 map 中的顺序
+        uint32_t dyn_count;         // 通配符/参数子边数量
+        int32_t star_child;         // "*" 子节点下标，-1 表示不存在
+        bool has_handler;           // 当前节点是否注册了处理器
+    };
+
+    // 扁平子边
+    struct FlatEdge
+    {
+        enum Kind : uint8_t { STATIC, WILDCARD, PARAM };
+
+        StringPiece label; // 静态边为完整路径段，通配符边为去掉 '*' 的前缀，参数边为去掉 {} 和空格的参数名
+        uint32_t child;    // 子节点在 flat_nodes_ 中的下标
+        Kind kind;         // 子边类型
+    };
+
+    // 在扁平数组上匹配路由，语义与 RouteTableNode::find 保持一致
+    RouteTableNode::iterator flat_find(uint32_t index,
+                                       const StringPiece &route,
+                                       size_t cursor,
+                                       RouteParams &route_params,
+                                       StringPiece &route_match_path) const;
+
+    // 在节点的静态子边中二分查找路径段，找不到返回 -1
+    int32_t find_static_child(const FlatNode &node, const StringPiece &label) const;
+
 private:
     RouteTableNode root_; // 根节点
     std::set<StringPiece> string_pieces_;  // 存储当前已注册的所有路径
+    std::vector<FlatNode> flat_nodes_;     // 冻结后的节点数组，下标 0 为根节点
+    std::vector<FlatEdge> flat_edges_;     // 冻结后的子边数组
+    bool frozen_ = false;                  // 是否已经冻结
 };
 
 } // namespace Yukino
@@ -30,7 +30,7 @@ void Router::handle(const std::string &route, int compute_queue_id, const WrapHa
 }
 
 // 调用路由对应的处理函数
-int Router::call(Verb verb, const std::string &route, HttpServerTask *server_task) const
+int Router::call(Verb verb, const StringPiece &route, HttpServerTask *server_task) const
 {
     HttpReq *req = server_task->get_req();  // 获取请求对象
     HttpResp *resp = server_task->get_resp();  // 获取响应对象
@@ -40,35 +40,63 @@ int Router::call(Verb verb, const std::string &route, HttpServerTask *server_tas
     if (route2.size() > 1 and route2[static_cast<int>(route2.size()) - 1] == '/')
         route2.remove_suffix(1);
 
-    std::map<std::string, std::string> route_params;  // 用于存储路由参数
-    std::string route_match_path;  // 匹配的路由路径
+    server_task->route_headers_ = nullptr;
+
+    // 路由参数直接写入请求对象，参数值和匹配路径都是指向 route 的视图
+    RouteParams &route_params = req->route_params();
+    route_params.clear();
+    StringPiece route_match_path;  // 匹配的路由路径
     // 在路由表中查找匹配的路由
     auto it = routes_map_.find(route2, route_params, route_match_path);
 
     int error_code = StatusOK;  // 默认状态码为成功
     if (it != routes_map_.end())   // 找到匹配的路由
     {
-        // 检查是否存在对应的HTTP请求方法
-        std::map<Verb, WrapHandler> &verb_handler_map = it->second.verb_handler_map;
-        bool has_verb = verb_handler_map.find(verb) != verb_handler_map.end() ? true : false;
-        if(verb_handler_map.find(Verb::ANY) != verb_handler_map.end() or has_verb)
+        // 检查是否存在对应的HTTP请求方法，没有则回退到ANY
+        const std::map<Verb, WrapHandler> &verb_handler_map = it->second->verb_handler_map;
+        auto handler_it = verb_handler_map.find(verb);
+        if (handler_it == verb_handler_map.end())
+            handler_it = verb_handler_map.find(Verb::ANY);
+        if(handler_it != verb_handler_map.end())
         {
             // 设置请求的完整路径、路由参数和匹配路径
-            req->set_full_path(it->second.path.as_string());  //服务端注册的路径
-            req->set_route_params(std::move(route_params));
-            req->set_route_match_path(std::move(route_match_path));
-            WFGoTask * go_task;
-            if(has_verb)
+            req->set_full_path(it->second->path);  //服务端注册的路径
+            req->set_route_match_path(route_match_path);
+            // 路由的静态响应头在发送响应时整块写入
+            if (!it->second->headers.empty())
+                server_task->route_headers_ = &it->second->headers;
+            // 路由的压缩级别作为响应的默认值，处理函数可以再覆盖
+            resp->set_compress_level(it->second->compress_level);
+            BodyStream *stream = req->body_stream();
+            if (stream && stream->to_file())
             {
-                // 如果找到具体的HTTP请求方法，调用对应的处理函数
-                go_task = it->second.verb_handler_map[verb](req, resp, series_of(server_task));
-            } else
+                // 请求体写入文件时，等全部写完再调用处理函数
+                const WrapHandler *handler = &handler_it->second;
+                WFGoTask *call_task = WFTaskFactory::create_go_task("Yukino_body_stream",
+                    [handler, req, resp, server_task, stream]()
+                {
+                    if (stream->error())
+                    {
+                        resp->Error(StatusFileWriteError, stream->file_path());
+                        return;
+                    }
+                    WFGoTask *go_task = (*handler)(req, resp, series_of(server_task));
+                    if(go_task)
+                        **server_task << go_task;
+                });
+                **server_task << stream->wait_flushed(call_task);
+            }
+            else if (stream && stream->error())
+            {
+                resp->Error(StatusFileWriteError, stream->file_path());
+            }
+            else
             {
-                // 如果找到通用的ANY方法，调用对应的处理函数
-                go_task = it->second.verb_handler_map[Verb::ANY](req, resp, series_of(server_task));
+                // 调用对应的处理函数
+                WFGoTask *go_task = handler_it->second(req, resp, series_of(server_task));
+                if(go_task)
+                    **server_task << go_task;  // 将任务加入到任务队列中
             }
-            if(go_task)
-                **server_task << go_task;  // 将任务加入到任务队列中
         } else
         {
             error_code = StatusRouteVerbNotImplment;  // 未实现的HTTP请求方法
@@ -80,6 +108,85 @@ int Router::call(Verb verb, const std::string &route, HttpServerTask *server_tas
     return error_code;
 }
 
+// 查找已注册路由对应的VerbHandler
+VerbHandler *Router::find_registered(const std::string &route)
+{
+    RouteVerb rv;
+    rv.route = CodeUtil::canonical_route(route);
+    if (routes_.find(rv) == routes_.end())
+    {
+        spdlog::error("[YUKINO] Route {} is not registered", route);
+        return nullptr;
+    }
+
+    // 只查找不创建，服务器启动（冻结路由表）之后调用也不会使扁平表失效
+    return routes_map_.find_exact(rv.route);
+}
+
+// 为已注册的路由设置静态响应头
+int Router::set_route_header(const std::string &route, const std::string &name, const std::string &value)
+{
+    VerbHandler *vh = find_registered(route);
+    if (!vh)
+        return StatusRouteNotFound;
+
+    vh->headers.set(name, value);
+    return StatusOK;
+}
+
+// 为已注册的路由设置响应的压缩级别
+int Router::set_compress_level(const std::string &route, CompressLevel level)
+{
+    VerbHandler *vh = find_registered(route);
+    if (!vh)
+        return StatusRouteNotFound;
+
+    vh->compress_level = level;
+    return StatusOK;
+}
+
+// 为已注册的路由开启流式请求体（数据回调）
+int Router::stream_body(const std::string &route, const BodyChunkFunc &on_chunk, size_t max_body_size)
+{
+    VerbHandler *vh = find_registered(route);
+    if (!vh)
+        return StatusRouteNotFound;
+
+    vh->body_stream.on_chunk = on_chunk;
+    vh->body_stream.max_body_size = max_body_size;
+    has_body_stream_ = true;
+    return StatusOK;
+}
+
+// 为已注册的路由开启流式请求体（写入文件）
+int Router::stream_body_to_file(const std::string &route, const BodyFilePathFunc &path_func, size_t max_body_size)
+{
+    VerbHandler *vh = find_registered(route);
+    if (!vh)
+        return StatusRouteNotFound;
+
+    vh->body_stream.file_path = path_func;
+    vh->body_stream.max_body_size = max_body_size;
+    has_body_stream_ = true;
+    return StatusOK;
+}
+
+// 根据请求路径查找流式请求体配置
+const BodyStreamOptions *Router::find_body_stream(const StringPiece &route) const
+{
+    StringPiece route2(route);
+    if (route2.size() > 1 and route2[static_cast<int>(route2.size()) - 1] == '/')
+        route2.remove_suffix(1);
+
+    RouteParams route_params;
+    StringPiece route_match_path;
+    auto it = routes_map_.find(route2, route_params, route_match_path);
+    if (it == routes_map_.end() || !it->second->body_stream.enabled())
+        return nullptr;
+
+    return &it->second->body_stream;
+}
+
 // 打印路由信息
 void Router::print_routes() const
 {
@@ -123,7 +230,7 @@ std::vector<std::pair<std::string, std::string>> Router::all_routes() const
 std::pair<Router::RouteVerbIter, bool> Router::add_route(Verb verb, const std::string &route)
 {
     RouteVerb rv; // 创建一个RouteVerb对象
-    rv.route = route; // 设置路由路径
+    rv.route = CodeUtil::canonical_route(route); // 设置路由路径（规范形式，与规范化后的请求路径一致）
     // 在路由集合中查找是否存在相同的路由
     auto it = routes_.find(rv);
     if(it != routes_.end())
@@ -144,7 +251,7 @@ std::pair<Router::RouteVerbIter, bool> Router::add_route(Verb verb, const std::s
 std::pair<Router::RouteVerbIter, bool> Router::add_route(const std::vector<Verb> &verbs, const std::string &route)
 {
     RouteVerb rv; // 创建一个RouteVerb对象
-    rv.route = route; // 设置路由路径
+    rv.route = CodeUtil::canonical_route(route); // 设置路由路径（规范形式，与规范化后的请求路径一致）
     // 在路由集合中查找是否存在相同的路由
     auto it = routes_.find(rv);
     if(it != routes_.end())
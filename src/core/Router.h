@@ -22,14 +22,48 @@ public:
 
     // 调用路由对应的处理函数
     // verb: HTTP请求方法
-    // route: 路由路径
+    // route: 路由路径，路由参数和匹配路径会直接引用它，需要在请求结束前保持有效
     // server_task: HttpServerTask对象指针
     // 返回值: 路由匹配结果
-    int call(Verb verb, const std::string &route, HttpServerTask *server_task) const;
+    int call(Verb verb, const StringPiece &route, HttpServerTask *server_task) const;
+
+    // 为已注册的路由设置静态响应头，注册时预先序列化，每个响应直接整块写入
+    // route: 路由路径
+    // name: 响应头名字
+    // value: 响应头的值
+    // 返回值: 路由不存在时返回 StatusRouteNotFound
+    int set_route_header(const std::string &route, const std::string &name, const std::string &value);
+
+    // 为已注册的路由设置响应的压缩级别，处理函数可以通过 HttpResp::set_compress_level 再覆盖
+    // route: 路由路径
+    // level: 压缩级别，AUTO 表示按服务器的策略选择
+    // 返回值: 路由不存在时返回 StatusRouteNotFound
+    int set_compress_level(const std::string &route, CompressLevel level);
+
+    // 为已注册的路由开启流式请求体，请求体的每块数据到达时交给 on_chunk，不再缓存在内存中
+    // route: 路由路径
+    // on_chunk: 数据回调，在网络线程中执行
+    // max_body_size: 请求体大小上限，0 表示不限制
+    // 返回值: 路由不存在时返回 StatusRouteNotFound
+    int stream_body(const std::string &route, const BodyChunkFunc &on_chunk, size_t max_body_size);
+
+    // 为已注册的路由开启流式请求体，请求体通过文件任务直接写入 path_func 返回的文件
+    // 处理函数在文件全部写完后才会调用，写入失败时直接返回错误响应
+    // 返回值: 路由不存在时返回 StatusRouteNotFound
+    int stream_body_to_file(const std::string &route, const BodyFilePathFunc &path_func, size_t max_body_size);
+
+    // 根据规范化后的请求路径查找流式请求体配置，路由未开启时返回 nullptr
+    const BodyStreamOptions *find_body_stream(const StringPiece &route) const;
+
+    // 是否有路由开启了流式请求体
+    bool has_body_stream() const { return has_body_stream_; }
 
     // 打印路由信息，用于日志记录
     void print_routes() const;
 
+    // 冻结路由表，将路由树编译为扁平的匹配结构（服务器启动时调用）
+    void freeze() { routes_map_.freeze(); }
+
     // 获取所有路由信息，用于测试
     std::vector<std::pair<std::string, std::string>> all_routes() const;
 
@@ -48,13 +82,13 @@ public:
     // 路由集合的迭代器类型
     using RouteVerbIter = std::set<RouteVerb>::iterator;
 
-    // 添加单个HTTP请求方法和路由的映射
+    // 添加单个HTTP请求方法和路由的映射，路由会先转换为规范形式（见 CodeUtil::canonical_route）
     // verb: HTTP请求方法
     // route: 路由路径
     // 返回值: 插入结果（迭代器和是否插入成功）
     std::pair<RouteVerbIter, bool> add_route(Verb verb, const std::string &route);
 
-    // 添加多个HTTP请求方法和路由的映射
+    // 添加多个HTTP请求方法和路由的映射，路由会先转换为规范形式
     // verbs: HTTP请求方法集合
     // route: 路由路径
     // 返回值: 插入结果（迭代器和是否插入成功）
@@ -63,9 +97,15 @@ public:
     // 打印路由树的结构信息
     void print_node_arch() { routes_map_.print_node_arch(); }
 
+private:
+    // 查找已注册路由对应的VerbHandler，路由不存在时返回 nullptr，不修改路由表
+    // 处理器的配置（响应头、压缩级别、流式请求体）没有加锁，应在服务器启动前设置
+    VerbHandler *find_registered(const std::string &route);
+
 private:
     RouteTable routes_map_; // 路由表，用于存储和匹配路由
     std::set<RouteVerb, RouteVerb> routes_;  // 存储路由和HTTP请求方法的集合
+    bool has_body_stream_ = false;  // 是否有路由开启了流式请求体
     friend class BluePrint; // 友元类，允许BluePrint访问Router的私有成员
 };
 
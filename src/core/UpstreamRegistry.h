@@ -0,0 +1,120 @@
+#ifndef YUKINO_UPSTREAMREGISTRY_H_
+#define YUKINO_UPSTREAMREGISTRY_H_
+
+#include "workflow/URIParser.h"
+
+#include <cctype>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Noncopyable.h"
+#include "UriUtil.h"
+#include "spdlog/spdlog.h"
+
+namespace Yukino
+{
+
+/**
+ * @brief 按名字注册的上游的注册表（RedisUpstream、MySQLUpstream 共用，只在实现文件中使用）
+ *
+ * URL 只在注册时解析一次；指定了 max_connections 时通过 UriUtil::bind_upstream 为该地址单独创建一个
+ * workflow upstream。注册只发生在服务器启动前，锁只用于保护注册本身，之后的查找只读。
+ * T 需要有私有的默认构造函数和 name_、uri_、retry_max_ 成员，并声明 UpstreamRegistry<T> 为友元。
+ */
+template <typename T>
+class UpstreamRegistry : public Noncopyable
+{
+public:
+    /**
+     * @brief 注册上游
+     *
+     * @param kind 上游类型，用于日志和 workflow upstream 名（yukino.<kind>.<name>）
+     * @param default_port URL 中没有端口时使用的端口
+     * @return const T* 注册的上游，URL 无法解析、名字重复或不合法时返回 nullptr
+     */
+    static const T *add(const char *kind, const char *default_port,
+                        const std::string &name, const std::string &url,
+                        size_t max_connections, int retry_max)
+    {
+        if (!valid_name(name))
+        {
+            spdlog::error("[YUKINO] invalid {} upstream name: {}", kind, name);
+            return nullptr;
+        }
+
+        ParsedURI uri;
+        if (URIParser::parse(url, uri) != 0 || !uri.scheme || !uri.host)
+        {
+            spdlog::error("[YUKINO] invalid {} url for upstream {}", kind, name);  // URL 中可能有密码，不记录
+            return nullptr;
+        }
+
+        UpstreamRegistry &registry = instance();
+        std::lock_guard<std::mutex> lock(registry.mutex_);
+        if (registry.upstreams_.count(name))
+        {
+            spdlog::error("[YUKINO] {} upstream {} already exists", kind, name);
+            return nullptr;
+        }
+
+        std::unique_ptr<T> upstream(new T);
+        upstream->name_ = name;
+        upstream->retry_max_ = retry_max;
+        if (max_connections == 0)
+        {
+            upstream->uri_ = std::move(uri);
+        }
+        else
+        {
+            // 为这个地址单独创建一个 upstream，连接数上限只作用于它
+            std::string upstream_name = std::string("yukino.") + kind + "." + name;
+            std::string upstream_url = UriUtil::bind_upstream(uri, upstream_name, default_port, max_connections);
+            URIParser::parse(upstream_url, upstream->uri_);
+        }
+
+        const T *result = upstream.get();
+        registry.upstreams_.emplace(name, std::move(upstream));
+        return result;
+    }
+
+    // 按名字查找已注册的上游，不存在时返回 nullptr
+    static const T *get(const std::string &name)
+    {
+        UpstreamRegistry &registry = instance();
+        std::lock_guard<std::mutex> lock(registry.mutex_);
+        auto it = registry.upstreams_.find(name);
+        return it != registry.upstreams_.end() ? it->second.get() : nullptr;
+    }
+
+private:
+    UpstreamRegistry() = default;
+
+    static UpstreamRegistry &instance()
+    {
+        static UpstreamRegistry registry;
+        return registry;
+    }
+
+    // 上游名会成为 workflow upstream 的主机名，只允许字母、数字、'-' 和 '_'
+    static bool valid_name(const std::string &name)
+    {
+        if (name.empty())
+            return false;
+        for (char c : name)
+        {
+            if (!isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_')
+                return false;
+        }
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::unique_ptr<T>> upstreams_;
+};
+
+}  // namespace Yukino
+
+#endif  // YUKINO_UPSTREAMREGISTRY_H_
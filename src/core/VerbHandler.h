@@ -4,6 +4,7 @@
 #include <functional>
 #include <set>
 #include "HttpMsg.h"
+#include "HttpHeaderWriter.h"
 
 namespace Yukino
 {
@@ -71,6 +72,9 @@ struct VerbHandler
     std::map<Verb, WrapHandler> verb_handler_map; // 动词到处理器的映射
     StringPiece path;                            // 路由路径（服务端注册的路径）
     int compute_queue_id;                        // 计算队列 ID
+    RouteHeaders headers;                        // 路由的静态响应头（已预先序列化）
+    BodyStreamOptions body_stream;               // 流式请求体配置（未开启时为空）
+    CompressLevel compress_level = CompressLevel::AUTO; // 响应的压缩级别（AUTO 表示按服务器策略）
 };
 
 }  // namespace Yukino
@@ -1,5 +1,6 @@
+#include <cstring>
+
 #include "CodeUtil.h"
-#include "StringPiece.h"
 
 namespace Yukino
 {
@@ -66,6 +67,141 @@ std::string CodeUtil::url_decode(const std::string &value)
     return result; // 返回解码后的字符串
 }
 
+namespace
+{
+
+const char *const kHexChars = "0123456789ABCDEF";
+
+// 非保留字符，规范形式中不需要编码
+inline bool is_unreserved(unsigned char chr)
+{
+    return (chr >= '0' && chr <= '9') || (chr >= 'A' && chr <= 'Z') ||
+           (chr >= 'a' && chr <= 'z') || chr == '-' || chr == '.' ||
+           chr == '_' || chr == '~';
+}
+
+// 十六进制字符转数值，非法字符返回 -1
+inline int hex_value(char chr)
+{
+    if (chr >= '0' && chr <= '9') return chr - '0';
+    if (chr >= 'A' && chr <= 'F') return chr - 'A' + 10;
+    if (chr >= 'a' && chr <= 'f') return chr - 'a' + 10;
+    return -1;
+}
+
+}  // namespace
+
+// 规范化路由模板
+std::string CodeUtil::canonical_route(const std::string &route)
+{
+    std::string result;
+    result.reserve(route.size());
+
+    bool in_param = false; // 是否处于 {param} 之中
+    for (size_t i = 0; i < route.size(); i++)
+    {
+        unsigned char chr = route[i];
+        if (in_param || chr == '{' || chr == '*' || chr == '/')
+        {
+            // 路由语法和分隔符原样保留
+            if (chr == '{')
+                in_param = true;
+            else if (chr == '}')
+                in_param = false;
+            result += static_cast<char>(chr);
+            continue;
+        }
+
+        // 已编码的字节先解码，再按统一规则重新输出
+        if (chr == '%' && i + 2 < route.size() && hex_value(route[i + 1]) >= 0 && hex_value(route[i + 2]) >= 0)
+        {
+            chr = static_cast<unsigned char>(hex_value(route[i + 1]) << 4 | hex_value(route[i + 2]));
+            i += 2;
+        }
+
+        if (is_unreserved(chr))
+        {
+            result += static_cast<char>(chr);
+        }
+        else
+        {
+            result += '%';
+            result += kHexChars[chr >> 4];
+            result += kHexChars[chr & 15];
+        }
+    }
+    return result;
+}
+
+// 规范化请求路径，结果写入 out
+size_t CodeUtil::normalize_path(const char *path, size_t len, char *out)
+{
+    // 路径不以 '/' 开头时补上
+    size_t pos = 0;
+    if (len > 0 && path[0] == '/')
+        pos = 1;
+    size_t n = 0;
+    out[n++] = '/';
+
+    while (pos < len)
+    {
+        size_t seg_start = n;
+
+        // 复制一个路径段，同时完成编码规范化
+        while (pos < len && path[pos] != '/')
+        {
+            unsigned char chr = path[pos];
+            if (chr == '%' && pos + 2 < len && hex_value(path[pos + 1]) >= 0 && hex_value(path[pos + 2]) >= 0)
+            {
+                chr = static_cast<unsigned char>(hex_value(path[pos + 1]) << 4 | hex_value(path[pos + 2]));
+                pos += 3;
+            }
+            else
+                pos++;
+
+            if (is_unreserved(chr))
+            {
+                out[n++] = static_cast<char>(chr);
+            }
+            else
+            {
+                out[n++] = '%';
+                out[n++] = kHexChars[chr >> 4];
+                out[n++] = kHexChars[chr & 15];
+            }
+        }
+
+        size_t seg_len = n - seg_start;
+        bool has_slash = pos < len;
+        if (seg_len == 0 || (seg_len == 1 && out[seg_start] == '.'))
+        {
+            // 忽略空段和 "."
+            n = seg_start;
+        }
+        else if (seg_len == 2 && out[seg_start] == '.' && out[seg_start + 1] == '.')
+        {
+            // 处理 ".."，回退到上一级目录
+            n = seg_start;
+            if (seg_start > 1)
+            {
+                size_t i = seg_start - 2;
+                while (out[i] != '/')
+                    i--;
+                n = i + 1;
+            }
+        }
+        else if (has_slash)
+        {
+            out[n++] = '/';
+        }
+
+        pos++; // 跳过 '/'
+    }
+
+    out[n] = '\0';
+    return n;
+}
+
 // 判断字符串是否为 URL 编码的函数实现
 bool CodeUtil::is_url_encode(const std::string &str)
 {
@@ -6,11 +6,10 @@
 #include <cstddef>
 #include <string>
 
+#include "StringPiece.h"
+
 namespace Yukino
 {
-    // 声明 StringPiece 类（假设在其他地方定义）
-    class StringPiece;
-
     /**
      * @class CodeUtil
      * @brief 提供编码和解码相关的工具函数
@@ -51,6 +50,36 @@ namespace Yukino
          * @return 如果字符串是 URL 编码的，返回 true；否则返回 false
          */
         static bool is_url_encode(const std::string &str);
+
+        /**
+         * @brief 将注册的路由模板转换为规范形式
+         *
+         * 字面部分统一为规范的百分号编码：非保留字符（字母、数字、-._~）和 '/' 原样保留，
+         * 其余字节编码为大写的 %XX，已经编码过的 %XX 不会被二次编码。
+         * 路由语法 {param} 与 * 原样保留。
+         *
+         * @param route 注册的路由模板
+         * @return 返回规范形式的路由
+         */
+        static std::string canonical_route(const std::string &route);
+
+        /**
+         * @brief 规范化请求路径
+         *
+         * 单次遍历完成以下工作：合并多余的 '/'，去掉 "." 与 ".." 路径段，
+         * 并将路径转换为与 canonical_route 相同的编码形式，路由匹配时无需再次编码。
+         * 输入不会被修改，结果写入 out 并以 '\0' 结尾。
+         *
+         * @param path 请求路径（不含查询字符串）
+         * @param len 路径长度
+         * @param out 输出缓冲区，至少 normalize_path_bound(len) 字节
+         * @return 返回结果的长度
+         */
+        static size_t normalize_path(const char *path, size_t len, char *out);
+
+        // normalize_path 需要的输出缓冲区大小：每个字节最多编码为三个字节，另加开头的 '/' 和结尾的 '\0'
+        static size_t normalize_path_bound(size_t len)
+        { return 3 * len + 2; }
     };
 
 } // namespace Yukino
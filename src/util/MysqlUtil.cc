@@ -1,4 +1,11 @@
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
 #include "MysqlUtil.h"
+#include "Json.h"
+#include "spdlog/spdlog.h"
 
 using namespace Yukino;
 using namespace protocol;
@@ -103,4 +110,865 @@ std::string MySQLUtil::to_string(const MySQLCell &cell)
     }
     // 如果单元格数据类型未知，返回空字符串
     return "";
-}
\ No newline at end of file
+}
+
+// 转换为 SQL 字符串字面量，需要转义的字符串使用十六进制字面量，不依赖连接的字符集
+std::string MySQLUtil::quote(const std::string &str)
+{
+    bool plain = true;
+    for (char c : str)
+    {
+        unsigned char uc = static_cast<unsigned char>(c);
+        if (uc < 0x20 || uc > 0x7e || c == '\'' || c == '\\')
+        {
+            plain = false;
+            break;
+        }
+    }
+
+    std::string res;
+    if (plain)
+    {
+        res.reserve(str.size() + 2);
+        res.push_back('\'');
+        res.append(str);
+        res.push_back('\'');
+        return res;
+    }
+
+    static const char hex[] = "0123456789ABCDEF";
+    // 字符集引导符与普通字符串字面量一样可以被强制转换为列的排序规则
+    res.reserve(str.size() * 2 + 12);
+    res.append("_utf8mb4 X'");
+    for (char c : str)
+    {
+        unsigned char uc = static_cast<unsigned char>(c);
+        res.push_back(hex[uc >> 4]);
+        res.push_back(hex[uc & 0x0F]);
+    }
+    res.push_back('\'');
+    return res;
+}
+
+// 浮点数输出能精确还原的形式
+MySQLParam::MySQLParam(double val)
+{
+    char buf[32];
+    literal_.assign(buf, snprintf(buf, sizeof buf, "%.17g", val));
+}
+
+// 拆分占位符，跳过字符串、反引号标识符和注释
+MySQLStatement::MySQLStatement(const std::string &sql)
+{
+    std::string part;
+    size_t i = 0;
+    size_t n = sql.size();
+    while (i < n)
+    {
+        char c = sql[i];
+        if (c == '?')
+        {
+            parts_.push_back(std::move(part));
+            part.clear();
+            i++;
+            continue;
+        }
+
+        size_t end = i + 1;
+        if (c == '\'' || c == '"' || c == '`')
+        {
+            // 引号内的内容原样保留，反斜杠转义下一个字符（反引号中没有转义）
+            while (end < n && sql[end] != c)
+            {
+                if (sql[end] == '\\' && c != '`')
+                    end++;
+                end++;
+            }
+            end = end < n ? end + 1 : n;
+        }
+        else if (c == '#' || (c == '-' && i + 2 < n && sql[i + 1] == '-' && isspace(static_cast<unsigned char>(sql[i + 2]))))
+        {
+            // 单行注释到行尾
+            end = sql.find('\n', i);
+            end = end == std::string::npos ? n : end;
+        }
+        else if (c == '/' && i + 1 < n && sql[i + 1] == '*')
+        {
+            end = sql.find("*/", i + 2);
+            end = end == std::string::npos ? n : end + 2;
+        }
+        part.append(sql, i, end - i);
+        i = end;
+    }
+    parts_.push_back(std::move(part));
+}
+
+bool MySQLStatement::bind(const std::vector<MySQLParam> &params, std::string *sql) const
+{
+    if (params.size() != param_count())
+    {
+        spdlog::error("[YUKINO] MySQL statement expects {} parameters but {} were given",
+                      param_count(), params.size());
+        return false;
+    }
+
+    size_t size = 0;
+    for (const std::string &part : parts_)
+        size += part.size();
+    for (const MySQLParam &param : params)
+        size += param.literal().size();
+
+    sql->clear();
+    sql->reserve(size);
+    sql->append(parts_[0]);
+    for (size_t i = 0; i < params.size(); i++)
+    {
+        sql->append(params[i].literal());
+        sql->append(parts_[i + 1]);
+    }
+    return true;
+}
+
+MySQLJsonWriter::MySQLJsonWriter(FlushFunc flush, size_t block_size)
+    : flush_(std::move(flush)), block_size_(block_size)
+{
+}
+
+// 键的顺序与 mysql_concat_json_res 中添加的顺序相同
+void MySQLJsonWriter::write(MySQLResponse *resp)
+{
+    MySQLResultCursor cursor(resp);
+    bool has_result_set = false;
+
+    buf_.reserve(block_size_ + block_size_ / 4);
+    buf_.push_back('{');
+    do {
+        int status = cursor.get_cursor_status();
+        if (status != MYSQL_STATUS_GET_RESULT && status != MYSQL_STATUS_OK)
+            break;
+
+        buf_.append(has_result_set ? "," : "\"result_set\":[", has_result_set ? 1 : 14);
+        has_result_set = true;
+
+        if (status == MYSQL_STATUS_GET_RESULT)
+        {
+            write_result_set(cursor);
+        }
+        else
+        {
+            buf_.append("{\"status\":\"OK\"");
+            write_key("affected_rows", 13);
+            write_integer(cursor.get_affected_rows());
+            write_key("warnings", 8);
+            write_integer(cursor.get_warnings());
+            write_key("insert_id", 9);
+            write_integer(cursor.get_insert_id());
+            write_key("info", 4);
+            write_string(cursor.get_info());
+            buf_.push_back('}');
+        }
+    } while (cursor.next_result_set());
+
+    if (has_result_set)
+        buf_.push_back(']');
+
+    // 第一个键之前没有逗号
+    bool first_key = !has_result_set;
+    auto key = [this, &first_key](const char *name, size_t len)
+    {
+        if (first_key)
+        {
+            buf_.push_back('"');
+            buf_.append(name, len);
+            buf_.append("\":", 2);
+            first_key = false;
+        }
+        else
+        {
+            write_key(name, len);
+        }
+    };
+
+    if (resp->get_packet_type() == MYSQL_PACKET_ERROR)
+    {
+        key("errcode", 7);
+        write_integer(resp->get_error_code());
+        key("errmsg", 6);
+        write_string(resp->get_error_msg());
+    }
+    else if (resp->get_packet_type() == MYSQL_PACKET_OK)
+    {
+        key("status", 6);
+        buf_.append("\"OK\"", 4);
+        key("affected_rows", 13);
+        write_integer(resp->get_affected_rows());
+        key("warnings", 8);
+        write_integer(resp->get_warnings());
+        key("insert_id", 9);
+        write_integer(resp->get_last_insert_id());
+        key("info", 4);
+        write_string(resp->get_info());
+    }
+    buf_.push_back('}');
+
+    flush_(&buf_, true);
+    buf_.clear();
+}
+
+void MySQLJsonWriter::write_result_set(MySQLResultCursor &cursor)
+{
+    int field_count = cursor.get_field_count();
+    const MySQLField *const *fields = cursor.fetch_fields();
+
+    buf_.append("{\"field_count\":", 15);
+    write_integer(field_count);
+    write_key("rows_count", 10);
+    write_integer(cursor.get_rows_count());
+    if (field_count > 0)
+    {
+        std::string database = fields[0]->get_db();
+        if (!database.empty())
+        {
+            write_key("database", 8);
+            write_string(database);
+        }
+        write_key("table", 5);
+        write_string(fields[0]->get_table());
+    }
+
+    write_key("fields_name", 11);
+    buf_.push_back('[');
+    for (int i = 0; i < field_count; i++)
+    {
+        if (i > 0)
+            buf_.push_back(',');
+        write_string(fields[i]->get_name());
+    }
+    buf_.push_back(']');
+
+    write_key("fields_type", 11);
+    buf_.push_back('[');
+    for (int i = 0; i < field_count; i++)
+    {
+        if (i > 0)
+            buf_.push_back(',');
+        const char *type = datatype2str(fields[i]->get_data_type());
+        Json::append_string(type, strlen(type), &buf_);
+    }
+    buf_.push_back(']');
+
+    // 没有行时不输出 rows，与 Json 对象中从未添加过 rows 的结果相同
+    bool first_row = true;
+    while (cursor.fetch_row(row_))
+    {
+        buf_.append(first_row ? ",\"rows\":[" : ",", first_row ? 9 : 1);
+        first_row = false;
+
+        buf_.push_back('[');
+        for (size_t i = 0; i < row_.size(); i++)
+        {
+            if (i > 0)
+                buf_.push_back(',');
+            write_cell(row_[i]);
+        }
+        buf_.push_back(']');
+        check_flush();
+    }
+    if (!first_row)
+        buf_.push_back(']');
+    buf_.push_back('}');
+}
+
+void MySQLJsonWriter::write_cell(const MySQLCell &cell)
+{
+    if (cell.is_null())
+    {
+        buf_.append("\"NULL\"", 6);
+    }
+    else if (cell.is_int())
+    {
+        Json::append_number(cell.as_int(), &buf_);
+    }
+    else if (cell.is_ulonglong())
+    {
+        write_integer(cell.as_ulonglong());
+    }
+    else if (cell.is_double())
+    {
+        Json::append_number(cell.as_double(), &buf_);
+    }
+    else if (cell.is_float())
+    {
+        Json::append_number(cell.as_float(), &buf_);
+    }
+    else
+    {
+        // 字符串、日期和时间直接转义单元格中的原始文本，不拷贝到临时字符串
+        const void *data;
+        size_t len;
+        int data_type;
+        cell.get_cell_nocopy(&data, &len, &data_type);
+        Json::append_string(static_cast<const char *>(data), len, &buf_);
+    }
+}
+
+void MySQLJsonWriter::write_key(const char *key, size_t len)
+{
+    buf_.append(",\"", 2);
+    buf_.append(key, len);
+    buf_.append("\":", 2);
+}
+
+void MySQLJsonWriter::write_string(const std::string &str)
+{
+    Json::append_string(str.data(), str.size(), &buf_);
+}
+
+void MySQLJsonWriter::write_integer(unsigned long long number)
+{
+    char buf[24];
+    int len = snprintf(buf, sizeof buf, "%llu", number);
+    buf_.append(buf, len);
+}
+
+void MySQLJsonWriter::check_flush()
+{
+    if (buf_.size() < block_size_)
+        return;
+
+    flush_(&buf_, false);
+    buf_.clear();
+    if (buf_.capacity() < block_size_)
+        buf_.reserve(block_size_ + block_size_ / 4);
+}
+
+namespace
+{
+
+// 按列输出时使用的 JSON 编码器，记录每一层容器是否已经有元素，自动插入逗号
+class JsonEncoder
+{
+public:
+    explicit JsonEncoder(std::string *out) : out_(out)
+    {}
+
+    void begin_map(size_t)
+    {
+        before_value();
+        out_->push_back('{');
+        first_.push_back(true);
+    }
+
+    void end_map()
+    {
+        out_->push_back('}');
+        first_.pop_back();
+    }
+
+    void begin_array(size_t)
+    {
+        before_value();
+        out_->push_back('[');
+        first_.push_back(true);
+    }
+
+    void end_array()
+    {
+        out_->push_back(']');
+        first_.pop_back();
+    }
+
+    void key(const char *name, size_t len)
+    {
+        before_value();
+        Json::append_string(name, len, out_);
+        out_->push_back(':');
+        after_key_ = true;
+    }
+
+    // 写入下一个值之前的分隔符，追加预先编码好的值之前也需要调用
+    void before_value()
+    {
+        if (after_key_)
+        {
+            after_key_ = false;
+            return;
+        }
+        if (first_.empty())
+            return;
+        if (first_.back())
+            first_.back() = false;
+        else
+            out_->push_back(',');
+    }
+
+    void null_value()
+    {
+        before_value();
+        out_->append("null", 4);
+    }
+
+    void int_value(long long number)
+    {
+        before_value();
+        char buf[24];
+        out_->append(buf, snprintf(buf, sizeof buf, "%lld", number));
+    }
+
+    void uint_value(unsigned long long number)
+    {
+        before_value();
+        char buf[24];
+        out_->append(buf, snprintf(buf, sizeof buf, "%llu", number));
+    }
+
+    void float_value(float number)
+    {
+        double_value(number);
+    }
+
+    void double_value(double number)
+    {
+        before_value();
+        Json::append_number(number, out_);
+    }
+
+    void string_value(const char *str, size_t len)
+    {
+        before_value();
+        Json::append_string(str, len, out_);
+    }
+
+private:
+    std::string *out_;
+    std::vector<bool> first_;  // 每一层容器是否还没有元素
+    bool after_key_ = false;   // 刚写完成员名，下一个值之前不需要逗号
+};
+
+// 按列输出时使用的 MessagePack 编码器，容器的元素个数写在开头，不需要分隔符
+class MsgPackEncoder
+{
+public:
+    explicit MsgPackEncoder(std::string *out) : out_(out)
+    {}
+
+    void begin_map(size_t count)
+    {
+        write_header(count, 0x80, 16, 0xde, 0xdf);
+    }
+
+    void end_map()
+    {}
+
+    void begin_array(size_t count)
+    {
+        write_header(count, 0x90, 16, 0xdc, 0xdd);
+    }
+
+    void end_array()
+    {}
+
+    void key(const char *name, size_t len)
+    {
+        string_value(name, len);
+    }
+
+    void before_value()
+    {}
+
+    void null_value()
+    {
+        out_->push_back(static_cast<char>(0xc0));
+    }
+
+    void int_value(long long number)
+    {
+        if (number >= 0)
+        {
+            uint_value(static_cast<unsigned long long>(number));
+        }
+        else if (number >= -32)
+        {
+            out_->push_back(static_cast<char>(number));  // negative fixint
+        }
+        else if (number >= INT8_MIN)
+        {
+            out_->push_back(static_cast<char>(0xd0));
+            out_->push_back(static_cast<char>(number));
+        }
+        else if (number >= INT16_MIN)
+        {
+            out_->push_back(static_cast<char>(0xd1));
+            write_be(static_cast<uint16_t>(number), 2);
+        }
+        else if (number >= INT32_MIN)
+        {
+            out_->push_back(static_cast<char>(0xd2));
+            write_be(static_cast<uint32_t>(number), 4);
+        }
+        else
+        {
+            out_->push_back(static_cast<char>(0xd3));
+            write_be(static_cast<uint64_t>(number), 8);
+        }
+    }
+
+    void uint_value(unsigned long long number)
+    {
+        if (number < 0x80)
+        {
+            out_->push_back(static_cast<char>(number));  // positive fixint
+        }
+        else if (number <= UINT8_MAX)
+        {
+            out_->push_back(static_cast<char>(0xcc));
+            out_->push_back(static_cast<char>(number));
+        }
+        else if (number <= UINT16_MAX)
+        {
+            out_->push_back(static_cast<char>(0xcd));
+            write_be(number, 2);
+        }
+        else if (number <= UINT32_MAX)
+        {
+            out_->push_back(static_cast<char>(0xce));
+            write_be(number, 4);
+        }
+        else
+        {
+            out_->push_back(static_cast<char>(0xcf));
+            write_be(number, 8);
+        }
+    }
+
+    void float_value(float number)
+    {
+        uint32_t bits;
+        memcpy(&bits, &number, sizeof bits);
+        out_->push_back(static_cast<char>(0xca));
+        write_be(bits, 4);
+    }
+
+    void double_value(double number)
+    {
+        uint64_t bits;
+        memcpy(&bits, &number, sizeof bits);
+        out_->push_back(static_cast<char>(0xcb));
+        write_be(bits, 8);
+    }
+
+    void string_value(const char *str, size_t len)
+    {
+        if (len < 32)
+        {
+            out_->push_back(static_cast<char>(0xa0 | len));  // fixstr
+        }
+        else if (len <= UINT8_MAX)
+        {
+            out_->push_back(static_cast<char>(0xd9));
+            out_->push_back(static_cast<char>(len));
+        }
+        else if (len <= UINT16_MAX)
+        {
+            out_->push_back(static_cast<char>(0xda));
+            write_be(len, 2);
+        }
+        else
+        {
+            out_->push_back(static_cast<char>(0xdb));
+            write_be(len, 4);
+        }
+        out_->append(str, len);
+    }
+
+private:
+    // 大端序写入 value 的低 bytes 个字节
+    void write_be(uint64_t value, int bytes)
+    {
+        char buf[8];
+        for (int i = bytes - 1; i >= 0; i--)
+        {
+            buf[i] = static_cast<char>(value & 0xff);
+            value >>= 8;
+        }
+        out_->append(buf, bytes);
+    }
+
+    // fix 类型的元素个数小于 fix_max，否则使用 16 位或 32 位的长度
+    void write_header(size_t count, unsigned char fix, size_t fix_max,
+                      unsigned char type16, unsigned char type32)
+    {
+        if (count < fix_max)
+        {
+            out_->push_back(static_cast<char>(fix | count));
+        }
+        else if (count <= UINT16_MAX)
+        {
+            out_->push_back(static_cast<char>(type16));
+            write_be(count, 2);
+        }
+        else
+        {
+            out_->push_back(static_cast<char>(type32));
+            write_be(count, 4);
+        }
+    }
+
+private:
+    std::string *out_;
+};
+
+template <typename ENCODER>
+void encode_key(ENCODER &encoder, const char *name)
+{
+    encoder.key(name, strlen(name));
+}
+
+template <typename ENCODER>
+void encode_string(ENCODER &encoder, const std::string &str)
+{
+    encoder.string_value(str.data(), str.size());
+}
+
+template <typename ENCODER>
+void encode_cell(ENCODER &encoder, const MySQLCell &cell)
+{
+    if (cell.is_null())
+    {
+        encoder.null_value();
+    }
+    else if (cell.is_int())
+    {
+        encoder.int_value(cell.as_int());
+    }
+    else if (cell.is_ulonglong())
+    {
+        encoder.uint_value(cell.as_ulonglong());
+    }
+    else if (cell.is_double())
+    {
+        encoder.double_value(cell.as_double());
+    }
+    else if (cell.is_float())
+    {
+        encoder.float_value(cell.as_float());
+    }
+    else
+    {
+        const void *data;
+        size_t len;
+        int data_type;
+        cell.get_cell_nocopy(&data, &len, &data_type);
+        encoder.string_value(static_cast<const char *>(data), len);
+    }
+}
+
+// 结果集是否有可以输出的内容，与 MySQLJsonWriter 中的判断相同
+bool is_result_set(const MySQLResultCursor &cursor)
+{
+    int status = cursor.get_cursor_status();
+    return status == MYSQL_STATUS_GET_RESULT || status == MYSQL_STATUS_OK;
+}
+
+}  // namespace
+
+MySQLColumnWriter::MySQLColumnWriter(bool msgpack, FlushFunc flush, size_t block_size)
+    : msgpack_(msgpack), flush_(std::move(flush)), block_size_(block_size)
+{
+}
+
+void MySQLColumnWriter::write(MySQLResponse *resp)
+{
+    if (msgpack_)
+        write_response<MsgPackEncoder>(resp);
+    else
+        write_response<JsonEncoder>(resp);
+}
+
+void MySQLColumnWriter::write_error(const std::string &errmsg)
+{
+    if (msgpack_)
+    {
+        MsgPackEncoder encoder(&buf_);
+        encoder.begin_map(1);
+        encode_key(encoder, "error");
+        encode_string(encoder, errmsg);
+        encoder.end_map();
+    }
+    else
+    {
+        JsonEncoder encoder(&buf_);
+        encoder.begin_map(1);
+        encode_key(encoder, "error");
+        encode_string(encoder, errmsg);
+        encoder.end_map();
+    }
+    flush_(&buf_, true);
+    buf_.clear();
+}
+
+template <typename ENCODER>
+void MySQLColumnWriter::write_response(MySQLResponse *resp)
+{
+    // MessagePack 的容器需要预先写入元素个数，先用另一个游标数一下结果集
+    size_t result_sets = 0;
+    MySQLResultCursor counter(resp);
+    do {
+        if (!is_result_set(counter))
+            break;
+        result_sets++;
+    } while (counter.next_result_set());
+
+    int packet_type = resp->get_packet_type();
+    size_t members = (result_sets > 0 ? 1 : 0) +
+                     (packet_type == MYSQL_PACKET_ERROR ? 2 : packet_type == MYSQL_PACKET_OK ? 5 : 0);
+
+    ENCODER encoder(&buf_);
+    buf_.reserve(block_size_ + block_size_ / 4);
+    encoder.begin_map(members);
+    if (result_sets > 0)
+    {
+        encode_key(encoder, "result_set");
+        encoder.begin_array(result_sets);
+
+        MySQLResultCursor cursor(resp);
+        for (size_t i = 0; i < result_sets; i++, cursor.next_result_set())
+        {
+            if (cursor.get_cursor_status() == MYSQL_STATUS_GET_RESULT)
+            {
+                write_result_set(encoder, cursor);
+                continue;
+            }
+
+            encoder.begin_map(5);
+            encode_key(encoder, "status");
+            encode_string(encoder, std::string("OK"));
+            encode_key(encoder, "affected_rows");
+            encoder.uint_value(cursor.get_affected_rows());
+            encode_key(encoder, "warnings");
+            encoder.uint_value(cursor.get_warnings());
+            encode_key(encoder, "insert_id");
+            encoder.uint_value(cursor.get_insert_id());
+            encode_key(encoder, "info");
+            encode_string(encoder, cursor.get_info());
+            encoder.end_map();
+        }
+        encoder.end_array();
+    }
+
+    if (packet_type == MYSQL_PACKET_ERROR)
+    {
+        encode_key(encoder, "errcode");
+        encoder.int_value(resp->get_error_code());
+        encode_key(encoder, "errmsg");
+        encode_string(encoder, resp->get_error_msg());
+    }
+    else if (packet_type == MYSQL_PACKET_OK)
+    {
+        encode_key(encoder, "status");
+        encode_string(encoder, std::string("OK"));
+        encode_key(encoder, "affected_rows");
+        encoder.uint_value(resp->get_affected_rows());
+        encode_key(encoder, "warnings");
+        encoder.uint_value(resp->get_warnings());
+        encode_key(encoder, "insert_id");
+        encoder.uint_value(resp->get_last_insert_id());
+        encode_key(encoder, "info");
+        encode_string(encoder, resp->get_info());
+    }
+    encoder.end_map();
+
+    flush_(&buf_, true);
+    buf_.clear();
+}
+
+template <typename ENCODER>
+void MySQLColumnWriter::write_result_set(ENCODER &encoder, MySQLResultCursor &cursor)
+{
+    int field_count = cursor.get_field_count();
+    const MySQLField *const *fields = cursor.fetch_fields();
+    std::string database = field_count > 0 ? fields[0]->get_db() : std::string();
+    size_t rows_count = cursor.get_rows_count();
+
+    encoder.begin_map(3 + (database.empty() ? 0 : 1) + (field_count > 0 ? 1 : 0));
+    encode_key(encoder, "field_count");
+    encoder.int_value(field_count);
+    encode_key(encoder, "rows_count");
+    encoder.uint_value(rows_count);
+    if (!database.empty())
+    {
+        encode_key(encoder, "database");
+        encode_string(encoder, database);
+    }
+    if (field_count > 0)
+    {
+        encode_key(encoder, "table");
+        encode_string(encoder, fields[0]->get_table());
+    }
+
+    // 每列的值编码到各自的缓冲区中，读完所有行后依次输出
+    std::vector<std::string> values(field_count > 0 ? field_count : 0);
+    std::vector<ENCODER> columns;
+    columns.reserve(values.size());
+    for (std::string &value : values)
+    {
+        columns.emplace_back(&value);
+        columns.back().begin_array(rows_count);
+    }
+
+    while (cursor.fetch_row(row_))
+    {
+        for (size_t i = 0; i < row_.size() && i < columns.size(); i++)
+            encode_cell(columns[i], row_[i]);
+    }
+
+    encode_key(encoder, "columns");
+    encoder.begin_array(values.size());
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        columns[i].end_array();
+
+        encoder.begin_map(3);
+        encode_key(encoder, "name");
+        encode_string(encoder, fields[i]->get_name());
+        encode_key(encoder, "type");
+        const char *type = datatype2str(fields[i]->get_data_type());
+        encoder.string_value(type, strlen(type));
+        encode_key(encoder, "values");
+        encoder.before_value();
+        write_block(&values[i]);
+        encoder.end_map();
+        check_flush();
+    }
+    encoder.end_array();
+    encoder.end_map();
+}
+
+void MySQLColumnWriter::write_block(std::string *value)
+{
+    if (buf_.size() + value->size() < block_size_)
+    {
+        buf_.append(*value);
+        value->clear();
+        return;
+    }
+
+    if (!buf_.empty())
+    {
+        flush_(&buf_, false);
+        buf_.clear();
+    }
+    flush_(value, false);
+    value->clear();
+}
+
+void MySQLColumnWriter::check_flush()
+{
+    if (buf_.size() < block_size_)
+        return;
+
+    flush_(&buf_, false);
+    buf_.clear();
+    if (buf_.capacity() < block_size_)
+        buf_.reserve(block_size_ + block_size_ / 4);
+}
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <vector>
+#include <functional>
+#include <type_traits>
 #include "workflow/MySQLResult.h"
 
 namespace Yukino
@@ -46,6 +48,185 @@ namespace Yukino
          * @return 返回单元格数据的字符串表示
          */
         static std::string to_string(const protocol::MySQLCell &cell);
+
+        /**
+         * @brief 将 UTF-8 字符串转换为 SQL 字符串字面量，用于拼接到 SQL 中
+         *
+         * 只含可打印 ASCII 字符且没有单引号和反斜杠的字符串直接加上单引号，
+         * 其他字符串输出为 _utf8mb4 X'...'。十六进制字面量不依赖反斜杠转义，
+         * 与连接的字符集（GBK、Big5、SJIS 等多字节字符集）和 NO_BACKSLASH_ESCAPES 都无关
+         *
+         * @param str 原始字符串
+         * @return 可以直接作为 SQL 字符串字面量的结果
+         */
+        static std::string quote(const std::string &str);
+    };
+
+    /**
+     * @class MySQLParam
+     * @brief MySQLStatement 的一个参数，构造时就转换为 SQL 字面量
+     *
+     * 字符串由 MySQLUtil::quote 转换，整数和浮点数保持数值，nullptr（包括空的 const char *）为 NULL，bool 为 TRUE/FALSE
+     */
+    class MySQLParam
+    {
+    public:
+        MySQLParam(std::nullptr_t) : literal_("NULL")
+        {}
+
+        MySQLParam(const std::string &str) : literal_(MySQLUtil::quote(str))
+        {}
+
+        MySQLParam(const char *str) : literal_(str ? MySQLUtil::quote(str) : "NULL")
+        {}
+
+        MySQLParam(bool val) : literal_(val ? "TRUE" : "FALSE")
+        {}
+
+        template <typename T, typename std::enable_if<std::is_integral<T>::value, bool>::type = true>
+        MySQLParam(T val) : literal_(std::to_string(val))
+        {}
+
+        MySQLParam(double val);
+
+        const std::string &literal() const
+        { return literal_; }
+
+    private:
+        std::string literal_;
+    };
+
+    /**
+     * @class MySQLStatement
+     * @brief 预先拆分好的带 ? 占位符的 SQL 语句
+     *
+     * 构造时找出所有占位符（引号、反引号和注释中的 ? 不算），之后每次执行只需要把转义后的参数拼接进去。
+     * 语句对象是只读的，可以定义为静态变量在多个线程中共用，如：
+     *
+     *     static const MySQLStatement by_id("SELECT * FROM user WHERE id = ? AND state = ?");
+     *     resp->MySQL(*upstream, by_id, { id, "active" });
+     */
+    class MySQLStatement
+    {
+    public:
+        explicit MySQLStatement(const std::string &sql);
+
+        // 占位符的个数
+        size_t param_count() const
+        { return parts_.size() - 1; }
+
+        /**
+         * @brief 按顺序替换占位符
+         *
+         * @param params 参数，个数需要与占位符个数一致
+         * @param sql 替换后的 SQL
+         * @return bool 参数个数与占位符个数不一致时记录错误日志并返回 false，sql 不变
+         */
+        bool bind(const std::vector<MySQLParam> &params, std::string *sql) const;
+
+    private:
+        std::vector<std::string> parts_;  // 占位符之间的 SQL 片段，比占位符多一个
+    };
+
+    /**
+     * @class MySQLJsonWriter
+     * @brief 将 MySQL 查询结果直接序列化为 JSON 文本
+     *
+     * 输出与 mysql_concat_json_res(...).dump() 相同，但不构建 Json 对象：游标中的每个单元格直接转义后写入缓冲区，
+     * 每写完一行检查缓冲区大小，达到 block_size 时交给 flush 发送，因此额外占用的内存与行宽相关，而不是与结果集大小相关。
+     */
+    class MySQLJsonWriter
+    {
+    public:
+        // 输出回调，block 为已经序列化的一块数据，last 表示最后一块
+        // 回调可以取走 block 的内容（如移动到内存池中），返回后缓冲区会被清空并复用
+        using FlushFunc = std::function<void(std::string *block, bool last)>;
+
+        // 默认每块的大小
+        static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+        explicit MySQLJsonWriter(FlushFunc flush, size_t block_size = BLOCK_SIZE);
+
+        /**
+         * @brief 序列化响应中的所有结果集，最后一块以 last 为 true 交给 flush
+         *
+         * @param resp 成功完成的 MySQL 任务的响应（任务失败时由调用者输出错误信息）
+         */
+        void write(protocol::MySQLResponse *resp);
+
+    private:
+        void write_result_set(protocol::MySQLResultCursor &cursor);
+
+        void write_cell(const protocol::MySQLCell &cell);
+
+        void write_key(const char *key, size_t len);
+
+        void write_string(const std::string &str);
+
+        void write_integer(unsigned long long number);
+
+        // 缓冲区达到块大小时交给 flush
+        void check_flush();
+
+    private:
+        FlushFunc flush_;
+        size_t block_size_;
+        std::string buf_;
+        std::vector<protocol::MySQLCell> row_;  // 复用的行缓冲
+    };
+
+    /**
+     * @class MySQLColumnWriter
+     * @brief 将 MySQL 查询结果按列序列化为 JSON 或 MessagePack
+     *
+     * 每个结果集的数据按列输出，每列带有自己的名称和类型，NULL 输出为 null（MessagePack 中为 nil），
+     * 数值保持数值类型，字符串、日期和时间输出为字符串。结构如下（MessagePack 与 JSON 相同）：
+     *
+     * {"result_set":[{"field_count":2,"rows_count":3,"database":"db","table":"t",
+     *                 "columns":[{"name":"id","type":"LONG","values":[1,2,3]},
+     *                            {"name":"name","type":"VAR_STRING","values":["a",null,"c"]}]},
+     *                {"status":"OK","affected_rows":1,"warnings":0,"insert_id":0,"info":""}],
+     *  "status":"OK","affected_rows":0,"warnings":0,"insert_id":0,"info":""}
+     *
+     * 按列输出需要读完一个结果集的所有行，每列的数据先编码到各自的缓冲区中，写完一列后整块交给 flush，不再拷贝
+     */
+    class MySQLColumnWriter
+    {
+    public:
+        using FlushFunc = MySQLJsonWriter::FlushFunc;
+
+        /**
+         * @param msgpack 为 true 时输出 MessagePack，否则输出 JSON
+         * @param flush 输出回调，与 MySQLJsonWriter 相同
+         * @param block_size 缓冲区达到该大小时交给 flush
+         */
+        MySQLColumnWriter(bool msgpack, FlushFunc flush,
+                          size_t block_size = MySQLJsonWriter::BLOCK_SIZE);
+
+        // 序列化成功完成的 MySQL 任务的响应
+        void write(protocol::MySQLResponse *resp);
+
+        // 任务失败时输出 {"error":errmsg}
+        void write_error(const std::string &errmsg);
+
+    private:
+        template <typename ENCODER>
+        void write_response(protocol::MySQLResponse *resp);
+
+        template <typename ENCODER>
+        void write_result_set(ENCODER &encoder, protocol::MySQLResultCursor &cursor);
+
+        // 追加一个已经编码好的值，较大时先交给 flush 当前缓冲区，再把 value 作为单独的一块交给 flush
+        void write_block(std::string *value);
+
+        void check_flush();
+
+    private:
+        bool msgpack_;
+        FlushFunc flush_;
+        size_t block_size_;
+        std::string buf_;
+        std::vector<protocol::MySQLCell> row_;
     };
 
 } // namespace Yukino
@@ -1,3 +1,5 @@
+#include "workflow/UpstreamManager.h"
+
 #include "UriUtil.h"
 #include "StrUtil.h"
 
@@ -53,4 +55,33 @@ std::map<std::string, std::string> UriUtil::split_query(const StringPiece &query
 
     // 返回解析后的键值对映射表
     return res;
-}
\ No newline at end of file
+}
+std::string UriUtil::bind_upstream(const ParsedURI &uri, const std::string &upstream_name,
+                                   const char *default_port, size_t max_connections)
+{
+    std::string address = uri.host;
+    address.push_back(':');
+    address.append(uri.port && *uri.port ? uri.port : default_port);
+
+    AddressParams params = ADDRESS_PARAMS_DEFAULT;
+    params.endpoint_params.max_connections = max_connections;
+    UpstreamManager::upstream_create_weighted_random(upstream_name, false);
+    UpstreamManager::upstream_add_server(upstream_name, address, &params);
+
+    std::string url = uri.scheme;
+    url.append("://");
+    if (uri.userinfo)
+    {
+        url.append(uri.userinfo);
+        url.push_back('@');
+    }
+    url.append(upstream_name);
+    if (uri.path)
+        url.append(uri.path);
+    if (uri.query)
+    {
+        url.push_back('?');
+        url.append(uri.query);
+    }
+    return url;
+}
@@ -30,6 +30,20 @@ namespace Yukino
          */
         static std::map<std::string, std::string>
         split_query(const StringPiece &query);
+
+        /**
+         * @brief 为 URL 中的地址单独创建一个 workflow upstream
+         *
+         * upstream 中只有这一个地址，max_connections 只限制到这个地址的连接数，不影响全局的连接配置。
+         *
+         * @param uri 已解析的 URL
+         * @param upstream_name upstream 名，需要是合法的主机名
+         * @param default_port URL 中没有端口时使用的端口
+         * @param max_connections 到该地址的最大连接数
+         * @return 把地址换成 upstream 名之后的 URL，用户信息、路径和查询参数保持不变
+         */
+        static std::string bind_upstream(const ParsedURI &uri, const std::string &upstream_name,
+                                         const char *default_port, size_t max_connections);
     };
 
 }  // namespace Yukino
@@ -1,8 +1,26 @@
+-- 可选的压缩算法，默认都关闭（与 CMake 的默认值一致），例如：xmake f --brotli=y --zstd=y
+option("brotli")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Build with brotli content encoding")
+    add_defines("YUKINO_WITH_BROTLI")
+    add_links("brotlienc", "brotlidec")
+option_end()
+
+option("zstd")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Build with zstd content encoding")
+    add_defines("YUKINO_WITH_ZSTD")
+    add_links("zstd")
+option_end()
+
 includes("**/xmake.lua")
 
 target("Yukino")
     add_deps("base", "core", "util")
     add_packages("workflow")
+    add_options("brotli", "zstd")
     set_kind("$(kind)")
 
     on_load(function (package)